@@ -0,0 +1,413 @@
+/**
+ * @file ufs_cp.c
+ * @brief A tool copying host files and directory trees into an image, and extracting them back out.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ *
+ * Usage:
+ *   ufs_cp [-j workers] IMAGE import HOST_PATH...
+ *   ufs_cp [-j workers] IMAGE export HOST_DIR [NAME...]
+ *
+ * A directory given to import is copied with all its regular files, each one at its path relative to the parent of
+ * the directory (dir/sub/file), and the image directories are created as needed. Export copies the given files, or
+ * the whole tree of the image, and creates the host directories their paths need.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <libgen.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+#include "unix_fs_sim/ufs.h"
+#include "unix_fs_sim/exits.h"
+
+/**
+ * @def BATCH_SIZE The number of image files opened at once, in a single call.
+ */
+#define BATCH_SIZE 1024
+
+/**
+ * @def MAX_FILE_SIZE The largest file an image can hold (12 blocks of 4 KiB).
+ */
+#define MAX_FILE_SIZE (NB_DATA_BLOCKS_INODE * LARGE)
+
+/**
+ * @struct job_t
+ * @brief A file to copy.
+ * @var host_path The path of the file on the host.
+ * @var name The path of the file in the image.
+ * @var f The opened image file.
+ * @var failed If the copy failed.
+ */
+typedef struct {
+    char *host_path;
+    char name[MAX_PATHNAME];
+    file_t *f;
+    bool failed;
+} job_t;
+
+/**
+ * @struct batch_t
+ * @brief The files of a batch, shared by the workers.
+ * @var jobs The files.
+ * @var nb_jobs The number of files.
+ * @var next The next file to copy.
+ * @var import If the files are copied into the image.
+ */
+typedef struct {
+    job_t *jobs;
+    size_t nb_jobs;
+    size_t next;
+    bool import;
+} batch_t;
+
+logger_t *logger;
+
+static job_t *jobs = NULL;
+static size_t nb_jobs = 0;
+static size_t jobs_capacity = 0;
+static size_t prefix_length = 0;
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-j workers] IMAGE import HOST_PATH...\n", program);
+    fprintf(stderr, "       %s [-j workers] IMAGE export HOST_DIR [NAME...]\n", program);
+}
+
+static int add_job(const char *host_path, const char *name) {
+    if (strlen(name) >= MAX_PATHNAME) {
+        fprintf(stderr, "Skipped %s: the path is too long for the image.\n", host_path);
+        return 0;
+    }
+    if (nb_jobs == jobs_capacity) {
+        jobs_capacity = jobs_capacity == 0 ? 1024 : jobs_capacity * 2;
+        job_t *grown = (job_t*) realloc(jobs, jobs_capacity * sizeof(job_t));
+        if (grown == NULL) {
+            return -1;
+        }
+        jobs = grown;
+    }
+    job_t *job = jobs + nb_jobs++;
+    memset(job, 0, sizeof(job_t));
+    job->host_path = strdup(host_path);
+    strcpy(job->name, name);
+    return job->host_path == NULL ? -1 : 0;
+}
+
+static int add_tree_entry(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+    (void) st;
+    (void) ftw;
+    if (type != FTW_F) {
+        return 0;
+    }
+    return add_job(path, path + prefix_length);
+}
+
+/**
+ * @brief Lists the files to import: a file is named after its basename, a directory is walked.
+ */
+static int collect_imports(char **paths, int nb_paths) {
+    for (int k = 0; k < nb_paths; k++) {
+        struct stat st;
+        if (stat(paths[k], &st) == -1) {
+            perror(paths[k]);
+            return -1;
+        }
+
+        char *copy = strdup(paths[k]);
+        if (copy == NULL) {
+            return -1;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            // The names keep the last component of the directory
+            char *parent = dirname(copy);
+            prefix_length = strcmp(parent, ".") == 0 && paths[k][0] != '.' ? 0 : strlen(parent) + 1;
+            if (nftw(paths[k], add_tree_entry, 64, FTW_PHYS) == -1) {
+                perror(paths[k]);
+                free(copy);
+                return -1;
+            }
+        } else if (add_job(paths[k], basename(copy)) == -1) {
+            free(copy);
+            return -1;
+        }
+        free(copy);
+    }
+    return 0;
+}
+
+/**
+ * @brief Creates the image directories of the paths of the files to import.
+ */
+static int make_image_dirs(void) {
+    char path[MAX_PATHNAME];
+    for (size_t k = 0; k < nb_jobs; k++) {
+        strcpy(path, jobs[k].name);
+        for (char *slash = strchr(path, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+            *slash = '\0';
+            file_stat_t st;
+            if (my_stat(path, &st) == -1 && my_mkdir(path) == -1) {
+                fprintf(stderr, "Failed to create the directory %s in the image.\n", path);
+                return -1;
+            }
+            *slash = '/';
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Lists the regular files of an image directory and of its subdirectories.
+ */
+static int collect_directory(const char *host_dir, const char *dir) {
+    dir_stream_t *d;
+    if ((d = my_opendir((char*) dir)) == NULL) {
+        return -1;
+    }
+    dir_entry_t *entry;
+    int ret = 0;
+    while (ret == 0 && (entry = my_readdir(d)) != NULL) {
+        char name[MAX_PATHNAME];
+        char path[PATH_MAX];
+        snprintf(name, sizeof(name), "%s%s%s", dir, dir[0] != '\0' ? "/" : "", entry->name);
+        snprintf(path, sizeof(path), "%s/%s", host_dir, name);
+
+        file_stat_t st;
+        if (my_stat(name, &st) == -1) {
+            ret = -1;
+        } else if (st.file_type == FILE_TYPE_DIRECTORY) {
+            ret = collect_directory(host_dir, name);
+        } else {
+            ret = add_job(path, name);
+        }
+    }
+    my_closedir(d);
+    return ret;
+}
+
+/**
+ * @brief Lists the files to export: the given paths that exist in the image, or all its files when there is none.
+ */
+static int collect_exports(const char *host_dir, char **names, int nb_names, size_t *nb_missing) {
+    char path[PATH_MAX];
+    for (int k = 0; k < nb_names; k++) {
+        file_stat_t st;
+        if (my_stat(names[k], &st) == -1 || st.file_type != FILE_TYPE_REGULAR) {
+            fprintf(stderr, "There is no file named %s in the image.\n", names[k]);
+            (*nb_missing)++;
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", host_dir, names[k]);
+        if (add_job(path, names[k]) == -1) {
+            return -1;
+        }
+    }
+    return nb_names > 0 ? 0 : collect_directory(host_dir, "");
+}
+
+static int mkdirs(char *path) {
+    for (char *slash = strchr(path + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        int ret = mkdir(path, 0755);
+        *slash = '/';
+        if (ret == -1 && errno != EEXIST) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static bool import_file(job_t *job, char *buffer) {
+    int fd;
+    if ((fd = open(job->host_path, O_RDONLY)) == -1) {
+        perror(job->host_path);
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // The whole file is read with as few calls as possible, then written to the image in a single call
+    ssize_t length = 0;
+    ssize_t n = 0;
+    while (length < MAX_FILE_SIZE && (n = read(fd, buffer + length, MAX_FILE_SIZE - length)) > 0) {
+        length += n;
+    }
+    char extra;
+    bool too_large = length == MAX_FILE_SIZE && read(fd, &extra, 1) == 1;
+    close(fd);
+    if (n == -1) {
+        perror(job->host_path);
+        return false;
+    }
+    if (too_large) {
+        fprintf(stderr, "%s is larger than the largest file of the image, it has been truncated.\n", job->host_path);
+    }
+    // A file already in the image is replaced, not overwritten in place with its old end left over
+    return my_truncate(job->f, 0) == 0 && my_write(job->f, buffer, (int) length) == length;
+}
+
+static bool export_file(job_t *job, char *buffer) {
+    int length;
+    if ((length = my_read(job->f, buffer, MAX_FILE_SIZE)) == -1) {
+        return false;
+    }
+    if (mkdirs(job->host_path) == -1) {
+        perror(job->host_path);
+        return false;
+    }
+
+    int fd;
+    if ((fd = open(job->host_path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
+        perror(job->host_path);
+        return false;
+    }
+    ssize_t written = 0;
+    ssize_t n = 0;
+    while (written < length && (n = write(fd, buffer + written, length - written)) > 0) {
+        written += n;
+    }
+    close(fd);
+    return written == length;
+}
+
+static void* worker(void *arg) {
+    batch_t *batch = (batch_t*) arg;
+    char *buffer;
+    if ((buffer = (char*) malloc(MAX_FILE_SIZE)) == NULL) {
+        return NULL;
+    }
+
+    // Each worker takes the next file of the batch until there is none left
+    size_t k;
+    while ((k = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) < batch->nb_jobs) {
+        job_t *job = batch->jobs + k;
+        job->failed = !(batch->import ? import_file(job, buffer) : export_file(job, buffer));
+    }
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * @brief Copies the files batch by batch: the files are opened together and closed by the main thread (the directory
+ * is not shared between threads), their content is copied by the workers.
+ */
+static size_t run(bool import, int nb_workers) {
+    pthread_t *threads = (pthread_t*) malloc(nb_workers * sizeof(pthread_t));
+    size_t nb_failed = 0;
+
+    for (size_t first = 0; first < nb_jobs; first += BATCH_SIZE) {
+        batch_t batch = {
+                .jobs = jobs + first,
+                .nb_jobs = nb_jobs - first < BATCH_SIZE ? nb_jobs - first : BATCH_SIZE,
+                .next = 0,
+                .import = import
+        };
+        char *names[BATCH_SIZE];
+        file_t *files[BATCH_SIZE];
+        for (size_t k = 0; k < batch.nb_jobs; k++) {
+            names[k] = batch.jobs[k].name;
+        }
+        bool opened = my_open_many(names, (int) batch.nb_jobs, files) != -1;
+        for (size_t k = 0; k < batch.nb_jobs; k++) {
+            batch.jobs[k].f = opened ? files[k] : NULL;
+            batch.jobs[k].failed = !opened;
+        }
+
+        int nb_threads = batch.nb_jobs < (size_t) nb_workers ? (int) batch.nb_jobs : nb_workers;
+        for (int t = 0; t < nb_threads; t++) {
+            pthread_create(threads + t, NULL, worker, &batch);
+        }
+        for (int t = 0; t < nb_threads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+
+        for (size_t k = 0; k < batch.nb_jobs; k++) {
+            if (batch.jobs[k].f != NULL && my_close(batch.jobs[k].f) == -1) {
+                batch.jobs[k].failed = true;
+            }
+            if (batch.jobs[k].failed) {
+                fprintf(stderr, "Failed to copy %s.\n", batch.jobs[k].host_path);
+                nb_failed++;
+            }
+        }
+    }
+
+    free(threads);
+    return nb_failed;
+}
+
+int main(int argc, char **argv) {
+    logger_config_t loggerConfig = {
+            1024,
+            true,
+            WARN,
+            false,
+            false,
+            TRACE,
+            ""
+    };
+    init_logger(loggerConfig);
+
+    int nb_workers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1) {
+        if (opt == 'j') {
+            nb_workers = atoi(optarg);
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (nb_workers < 1) {
+        nb_workers = 1;
+    }
+    if (argc - optind < 3) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char *image = argv[optind];
+    char *mode = argv[optind + 1];
+    bool import = strcmp(mode, "import") == 0;
+    if (!import && strcmp(mode, "export") != 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (import && collect_imports(argv + optind + 2, argc - optind - 2) == -1) {
+        return EXIT_FAILURE;
+    }
+
+    if (mount(image) == -1) {
+        return ERR_MOUNT;
+    }
+    if (import && make_image_dirs() == -1) {
+        umount();
+        return EXIT_FAILURE;
+    }
+    size_t nb_missing = 0;
+    if (!import && collect_exports(argv[optind + 2], argv + optind + 3, argc - optind - 3, &nb_missing) == -1) {
+        umount();
+        return EXIT_FAILURE;
+    }
+    size_t nb_failed = run(import, nb_workers) + nb_missing;
+    if (umount() == -1) {
+        return ERR_UMOUNT;
+    }
+
+    printf("%zu file(s) copied, %zu failed.\n", nb_jobs + nb_missing - nb_failed, nb_failed);
+    for (size_t k = 0; k < nb_jobs; k++) {
+        free(jobs[k].host_path);
+    }
+    free(jobs);
+    return nb_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
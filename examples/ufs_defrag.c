@@ -0,0 +1,155 @@
+/**
+ * @file ufs_defrag.c
+ * @brief A tool measuring and reducing the fragmentation of the files of an image.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ *
+ * Usage:
+ *   ufs_defrag [-n] [-v] [-r BLOCKS_PER_SECOND] IMAGE
+ *
+ * The fragmentation of the files (their number of runs of contiguous blocks) is reported, then the fragmented files
+ * are moved to single runs of free blocks. With -n, the image is only measured. With -v, each fragmented file is
+ * listed. With -r, the number of blocks moved per second is limited.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+#include "unix_fs_sim/ufs.h"
+#include "unix_fs_sim/exits.h"
+
+logger_t *logger;
+
+/**
+ * @brief The fragmentation of a tree of files.
+ * @var nb_files The number of regular files with data blocks.
+ * @var nb_fragmented The number of files with more than one extent.
+ * @var nb_blocks The number of data blocks of the files.
+ * @var nb_extents The number of extents of the files.
+ */
+typedef struct {
+    uint32_t nb_files;
+    uint32_t nb_fragmented;
+    uint32_t nb_blocks;
+    uint32_t nb_extents;
+} fragmentation_t;
+
+/**
+ * @brief Adds the fragmentation of the files of a directory and of its subdirectories.
+ * @param path The path of the directory.
+ * @param verbose If the fragmented files are printed.
+ * @param frag The fragmentation, updated.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int measure_directory(const char *path, bool verbose, fragmentation_t *frag) {
+    dir_stream_t *d;
+    if ((d = my_opendir((char*) path)) == NULL) {
+        return -1;
+    }
+
+    int ret = 0;
+    dir_entry_t *entry;
+    while ((entry = my_readdir(d)) != NULL && ret == 0) {
+        char child[MAX_PATHNAME];
+        snprintf(child, sizeof(child), "%s/%s", strcmp(path, "/") == 0 ? "" : path, entry->name);
+        file_stat_t st;
+        if (my_stat(child, &st) == -1) {
+            ret = -1;
+        } else if (st.file_type == FILE_TYPE_DIRECTORY) {
+            ret = measure_directory(child, verbose, frag);
+        } else if (st.nb_extents > 0) {
+            frag->nb_files++;
+            frag->nb_blocks += st.nb_blocks;
+            frag->nb_extents += st.nb_extents;
+            if (st.nb_extents > 1) {
+                frag->nb_fragmented++;
+                if (verbose) {
+                    printf("  %s: %u blocks in %u extents\n", child, st.nb_blocks, st.nb_extents);
+                }
+            }
+        }
+    }
+    my_closedir(d);
+    return ret;
+}
+
+/**
+ * @brief Prints the fragmentation of the files of the image.
+ * @param title What the measure is about.
+ * @param verbose If the fragmented files are printed.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int print_fragmentation(const char *title, bool verbose) {
+    fragmentation_t frag = {0};
+    if (verbose) {
+        printf("%s:\n", title);
+    }
+    if (measure_directory("/", verbose, &frag) == -1) {
+        return -1;
+    }
+    printf("%s: %u file(s), %u fragmented, %u block(s) in %u extent(s) (%.2f extents per file).\n", title,
+           frag.nb_files, frag.nb_fragmented, frag.nb_blocks, frag.nb_extents,
+           frag.nb_files > 0 ? (double) frag.nb_extents / frag.nb_files : 0.0);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    logger_config_t loggerConfig = {
+            1024,
+            true,
+            WARN,
+            false,
+            false,
+            TRACE,
+            ""
+    };
+    init_logger(loggerConfig);
+
+    bool dry_run = false;
+    bool verbose = false;
+    uint32_t rate = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "nvr:")) != -1) {
+        switch (opt) {
+            case 'n':
+                dry_run = true;
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            case 'r':
+                rate = (uint32_t) strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n] [-v] [-r BLOCKS_PER_SECOND] IMAGE\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-n] [-v] [-r BLOCKS_PER_SECOND] IMAGE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (mount(argv[optind]) == -1) {
+        return ERR_MOUNT;
+    }
+    int ret = print_fragmentation("Before", verbose);
+    int64_t moved = 0;
+    if (ret == 0 && !dry_run) {
+        if ((moved = fs_defrag(rate)) == -1) {
+            ret = -1;
+        } else {
+            printf("%lld block(s) moved.\n", (long long) moved);
+            ret = print_fragmentation("After", verbose);
+        }
+    }
+    if (umount() == -1) {
+        return ERR_UMOUNT;
+    }
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file ufs_fsck.c
+ * @brief A tool checking the consistency of an image: its bitmaps, the blocks referenced by its inodes, its tree of
+ * directories and its free counters.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ *
+ * Usage:
+ *   ufs_fsck [-y] [-j THREADS] IMAGE
+ *
+ * Without -y, the conflicts are only reported. With -j, the image is scanned by THREADS threads instead of one per
+ * online processor. As for fsck(8), the exit status is 0 for a consistent image, 1 when every conflict was repaired,
+ * 4 when conflicts are left, 8 when the check failed and 16 for a usage error.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+#include "unix_fs_sim/ufs.h"
+#include "unix_fs_sim/exits.h"
+
+#define FSCK_REPAIRED 1
+#define FSCK_UNREPAIRED 4
+#define FSCK_FAILED 8
+#define FSCK_USAGE 16
+
+logger_t *logger;
+
+/**
+ * @brief Prints a report.
+ * @param r The report.
+ */
+static void print_report(fsck_report_t *r) {
+    printf("%u inode(s), %u directory(ies), %u entry(ies) checked\n", r->nb_inodes, r->nb_directories, r->nb_entries);
+    printf("  %8u bad inode(s)\n", r->bad_inodes);
+    printf("  %8u bad block reference(s)\n", r->bad_blocks);
+    printf("  %8u dangling entry(ies)\n", r->dangling_entries);
+    printf("  %8u duplicate entry(ies)\n", r->duplicate_entries);
+    printf("  %8u orphan inode(s)\n", r->orphan_inodes);
+    printf("  %8u data bitmap error(s)\n", r->data_errors);
+    printf("  %8u checksum error(s)\n", r->checksum_errors);
+    printf("  %8u free counter error(s)\n", r->counter_errors);
+}
+
+int main(int argc, char **argv) {
+    logger_config_t loggerConfig = {
+            1024,
+            true,
+            WARN,
+            false,
+            false,
+            TRACE,
+            ""
+    };
+    init_logger(loggerConfig);
+
+    bool repair = false;
+    uint32_t nb_threads = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "yj:")) != -1) {
+        if (opt == 'y') {
+            repair = true;
+        } else if (opt == 'j' && atoi(optarg) > 0) {
+            nb_threads = (uint32_t) atoi(optarg);
+        } else {
+            fprintf(stderr, "Usage: %s [-y] [-j THREADS] IMAGE\n", argv[0]);
+            return FSCK_USAGE;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-y] [-j THREADS] IMAGE\n", argv[0]);
+        return FSCK_USAGE;
+    }
+
+    if (mount(argv[optind]) == -1) {
+        return ERR_MOUNT;
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    fsck_report_t report;
+    int nb_conflicts = fs_check(repair, nb_threads, &report);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (nb_conflicts >= 0) {
+        print_report(&report);
+        printf("%d conflict(s) found, %u repaired, in %.3f s\n", nb_conflicts, report.nb_repaired,
+               (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9);
+    }
+    if (umount() == -1) {
+        return ERR_UMOUNT;
+    }
+
+    if (nb_conflicts == -1) {
+        return FSCK_FAILED;
+    }
+    if (nb_conflicts == 0) {
+        return EXIT_SUCCESS;
+    }
+    return repair && report.nb_repaired >= (uint32_t) nb_conflicts ? FSCK_REPAIRED : FSCK_UNREPAIRED;
+}
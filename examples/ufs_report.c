@@ -0,0 +1,155 @@
+/**
+ * @file ufs_report.c
+ * @brief A tool reporting the layout of an image: its free space, the fragmentation of its files and the utilization
+ * of its block groups.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ *
+ * Usage:
+ *   ufs_report [-v] IMAGE
+ *
+ * With -v, the number of extents of each file is listed too.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+#include "unix_fs_sim/ufs.h"
+#include "unix_fs_sim/exits.h"
+
+logger_t *logger;
+
+/**
+ * @brief Returns a ratio as a percentage, 0 for an empty total.
+ */
+static double percent(uint32_t part, uint32_t total) {
+    return total > 0 ? (double) part * 100 / total : 0.0;
+}
+
+/**
+ * @brief Prints the number of extents of the files of a directory and of its subdirectories.
+ * @param path The path of the directory.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int print_files(const char *path) {
+    dir_stream_t *d;
+    if ((d = my_opendir((char*) path)) == NULL) {
+        return -1;
+    }
+
+    int ret = 0;
+    dir_entry_t *entry;
+    while ((entry = my_readdir(d)) != NULL && ret == 0) {
+        char child[MAX_PATHNAME];
+        snprintf(child, sizeof(child), "%s/%s", strcmp(path, "/") == 0 ? "" : path, entry->name);
+        file_stat_t st;
+        if (my_stat(child, &st) == -1) {
+            ret = -1;
+        } else if (st.file_type == FILE_TYPE_DIRECTORY) {
+            ret = print_files(child);
+        } else {
+            printf("  %-40s %10u bytes %3u blocks %3u extents\n", child, st.size, st.nb_blocks, st.nb_extents);
+        }
+    }
+    my_closedir(d);
+    return ret;
+}
+
+/**
+ * @brief Prints a report.
+ * @param r The report.
+ */
+static void print_report(fs_report_t *r) {
+    uint32_t nb_data = 0;
+    uint32_t nb_data_used = 0;
+    uint32_t nb_inodes = 0;
+    uint32_t nb_inodes_used = 0;
+    for (uint32_t g = 0; g < r->nb_regions; g++) {
+        nb_data += r->regions[g].nb_data;
+        nb_data_used += r->regions[g].nb_data_used;
+        nb_inodes += r->regions[g].nb_inodes;
+        nb_inodes_used += r->regions[g].nb_inodes_used;
+    }
+
+    printf("Free space\n");
+    printf("  %u / %u data blocks free (%.2f%%), in %u extent(s), the largest of %u block(s)\n",
+           nb_data - nb_data_used, nb_data, percent(nb_data - nb_data_used, nb_data), r->nb_free_extents,
+           r->largest_free_run);
+    for (uint32_t b = 0; b < REPORT_EXTENT_BUCKETS; b++) {
+        if (r->free_extents[b] > 0) {
+            printf("  %10u - %-10u blocks: %8u extent(s), %10u block(s) (%.2f%% of the free space)\n", 1u << b,
+                   (b == 31 ? UINT32_MAX : (1u << (b + 1)) - 1), r->free_extents[b], r->free_extent_blocks[b],
+                   percent(r->free_extent_blocks[b], nb_data - nb_data_used));
+        }
+    }
+
+    printf("Files\n");
+    printf("  %u file(s) and %u directory(ies), %u / %u inodes used (%.2f%%)\n", r->nb_files, r->nb_directories,
+           nb_inodes_used, nb_inodes, percent(nb_inodes_used, nb_inodes));
+    printf("  %u block(s) in %u extent(s), %.2f extents per file, fragmentation score %.3f\n", r->nb_file_blocks,
+           r->nb_file_extents, r->nb_files > 0 ? (double) r->nb_file_extents / r->nb_files : 0.0, r->fragmentation);
+    for (uint32_t k = 0; k <= NB_DATA_BLOCKS_INODE; k++) {
+        if (r->files_by_extents[k] > 0) {
+            printf("  %2u extent(s): %u file(s)\n", k, r->files_by_extents[k]);
+        }
+    }
+
+    printf("Regions\n");
+    printf("  %6s %22s %22s %12s\n", "group", "data used", "inodes used", "largest run");
+    for (uint32_t g = 0; g < r->nb_regions; g++) {
+        region_report_t *region = r->regions + g;
+        printf("  %6u %10u (%6.2f%%) %10u (%6.2f%%) %12u\n", g, region->nb_data_used,
+               percent(region->nb_data_used, region->nb_data), region->nb_inodes_used,
+               percent(region->nb_inodes_used, region->nb_inodes), region->largest_free_run);
+    }
+}
+
+int main(int argc, char **argv) {
+    logger_config_t loggerConfig = {
+            1024,
+            true,
+            WARN,
+            false,
+            false,
+            TRACE,
+            ""
+    };
+    init_logger(loggerConfig);
+
+    bool verbose = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1) {
+        if (opt != 'v') {
+            fprintf(stderr, "Usage: %s [-v] IMAGE\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        verbose = true;
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-v] IMAGE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (mount(argv[optind]) == -1) {
+        return ERR_MOUNT;
+    }
+    fs_report_t report;
+    int ret = fs_analyze(&report);
+    if (ret == 0) {
+        print_report(&report);
+        fs_free_report(&report);
+    }
+    if (ret == 0 && verbose) {
+        printf("Extents of the files\n");
+        ret = print_files("/");
+    }
+    if (umount() == -1) {
+        return ERR_UMOUNT;
+    }
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file ufs_trim.c
+ * @brief A tool giving the storage of the free blocks of an image back to the host.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ *
+ * Usage:
+ *   ufs_trim IMAGE
+ *
+ * Every free data block of the image is punched out of it, so that a long-lived image goes back to the physical size
+ * of the data it holds. The image keeps its size.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "logging/logging.h"
+#include "unix_fs_sim/ufs.h"
+#include "unix_fs_sim/exits.h"
+
+logger_t *logger;
+
+/**
+ * @brief Returns the number of bytes of the host storage used by a file, -1 if an error occurs.
+ */
+static long long allocated_size(const char *path) {
+    struct stat st;
+    if (stat(path, &st) == -1) {
+        perror(path);
+        return -1;
+    }
+    return (long long) st.st_blocks * 512;
+}
+
+int main(int argc, char **argv) {
+    logger_config_t loggerConfig = {
+            1024,
+            true,
+            WARN,
+            false,
+            false,
+            TRACE,
+            ""
+    };
+    init_logger(loggerConfig);
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s IMAGE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    long long before = allocated_size(argv[1]);
+    if (mount(argv[1]) == -1) {
+        return ERR_MOUNT;
+    }
+    int64_t punched = fs_trim();
+    if (umount() == -1) {
+        return ERR_UMOUNT;
+    }
+    if (punched == -1) {
+        return EXIT_FAILURE;
+    }
+
+    long long after = allocated_size(argv[1]);
+    printf("%lld free block(s) discarded, %lld KiB used on the host (%lld KiB before).\n", (long long) punched,
+           after / 1024, before / 1024);
+    return EXIT_SUCCESS;
+}
@@ -32,6 +32,10 @@ void write_file();
 void change_offset();
 void close_file();
 void print_filesize();
+void list_files();
+void make_directory();
+void remove_file();
+void resize_file();
 void unmount_partition();
 void print_usage();
 
@@ -84,6 +88,18 @@ int main(int argc, char **argv) {
             case 's':
                 print_filesize();
                 break;
+            case 'l':
+                list_files();
+                break;
+            case 'd':
+                make_directory();
+                break;
+            case 'r':
+                remove_file();
+                break;
+            case 't':
+                resize_file();
+                break;
             case 'u':
                 print_usage();
                 break;
@@ -107,6 +123,10 @@ void print_menu() {
     printf("8. Close file\n");
     printf("9. Unmount partition\n");
     printf("s. File size\n");
+    printf("l. List files\n");
+    printf("d. Create directory\n");
+    printf("r. Remove file\n");
+    printf("t. Truncate file\n");
     printf("u. Print usage\n");
     printf("q. Quit\n\n");
 }
@@ -150,8 +170,8 @@ void mount_partition() {
 }
 
 void open_file() {
-    char name[MAX_FILENAME];
-    printf("Filename: ");
+    char name[MAX_PATHNAME];
+    printf("Path: ");
     scanf(" %[^\n]s", name);
     if ((f = my_open(name)) == NULL) {
         exit(ERR_OPEN);
@@ -214,6 +234,56 @@ void print_filesize() {
     printf("%s, %ld bytes\n", f->name, size(f));
 }
 
+void list_files() {
+    char dir[MAX_PATHNAME];
+    printf("Directory (/ for the root): ");
+    scanf(" %[^\n]s", dir);
+    dir_stream_t *d;
+    if ((d = my_opendir(dir)) == NULL) {
+        exit(ERR_READ);
+    }
+    dir_entry_t *entry;
+    while ((entry = my_readdir(d)) != NULL) {
+        char path[2 * MAX_PATHNAME];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->name);
+        file_stat_t st;
+        if (my_stat(path, &st) == 0) {
+            printf("%8u  %s%s\n", st.size, entry->name, st.file_type == FILE_TYPE_DIRECTORY ? "/" : "");
+        }
+    }
+    my_closedir(d);
+}
+
+void make_directory() {
+    char path[MAX_PATHNAME];
+    printf("Path: ");
+    scanf(" %[^\n]s", path);
+    if (my_mkdir(path) == -1) {
+        exit(ERR_WRITE);
+    }
+    printf("Directory created.");
+}
+
+void remove_file() {
+    char path[MAX_PATHNAME];
+    printf("Path: ");
+    scanf(" %[^\n]s", path);
+    if (my_unlink(path) == -1) {
+        exit(ERR_WRITE);
+    }
+    printf("File removed.");
+}
+
+void resize_file() {
+    int new_size;
+    printf("Size: ");
+    scanf(" %d", &new_size);
+    if (my_truncate(f, new_size) == -1) {
+        exit(ERR_WRITE);
+    }
+    printf("File truncated.");
+}
+
 void unmount_partition() {
     if (umount() == -1) {
         exit(ERR_UMOUNT);
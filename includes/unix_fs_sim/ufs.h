@@ -11,6 +11,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 /**
  * @def MAGIC_NUMBER The magic number is the serial number of the filesystem. It must me present at the beginning of every partition.
@@ -22,8 +23,92 @@
  */
 #define NB_DATA_BLOCKS_INODE 12
 
+/**
+ * @def MAX_SUBDIR_ENTRIES The maximum number of entries of a directory other than the root one (192 with 1Ko blocks),
+ * whose entries fill at most its direct data blocks.
+ */
+#define MAX_SUBDIR_ENTRIES(block_size) (NB_DATA_BLOCKS_INODE * (block_size) / sizeof(dir_entry_t))
+
+/**
+ * @def MAX_FILENAME The maximum length of a name in a directory (a component of a path), including the final null byte.
+ */
 #define MAX_FILENAME 60
 
+/**
+ * @def MAX_PATHNAME The maximum length of a path (names separated by '/'), including the final null byte.
+ */
+#define MAX_PATHNAME 1024
+
+/**
+ * @def FILE_TYPE_REGULAR The file_type of the regular files.
+ */
+#define FILE_TYPE_REGULAR 0
+
+/**
+ * @def FILE_TYPE_DIRECTORY The file_type of the directories, whose content is the array of their entries, sorted by name.
+ */
+#define FILE_TYPE_DIRECTORY 1
+
+/**
+ * @def INLINE_DATA_SIZE The number of bytes of a file that can be stored in its inode.
+ */
+#define INLINE_DATA_SIZE 104
+
+/**
+ * @def INODE_INLINE_DATA The content of the file is stored in the inode instead of data blocks.
+ */
+#define INODE_INLINE_DATA 0x1
+
+/**
+ * @def INODE_TAIL_PACKED The last partial block of the file is stored in a shared fragment block.
+ */
+#define INODE_TAIL_PACKED 0x2
+
+/**
+ * @def INODE_COMPRESSED The clusters of the file are compressed when they are written.
+ */
+#define INODE_COMPRESSED 0x4
+
+/**
+ * @def COMPRESS_CLUSTER_BLOCKS The number of blocks of a file compressed together.
+ */
+#define COMPRESS_CLUSTER_BLOCKS 4
+
+/**
+ * @def BG_DATA_BITMAP_UNINIT The data bitmap of the group has not been entirely zeroed by mkfs.
+ */
+#define BG_DATA_BITMAP_UNINIT 0x1
+
+/**
+ * @def BG_INODE_BITMAP_UNINIT The inode bitmap of the group has not been entirely zeroed by mkfs.
+ */
+#define BG_INODE_BITMAP_UNINIT 0x2
+
+/**
+ * @def BG_INODE_TABLE_UNINIT The inode table of the group has not been entirely zeroed by mkfs.
+ */
+#define BG_INODE_TABLE_UNINIT 0x4
+
+/**
+ * @def FS_FEATURE_DEDUP The full data blocks are deduplicated by content on write.
+ */
+#define FS_FEATURE_DEDUP 0x1
+
+/**
+ * @def FS_FEATURE_COMPRESS The new files are compressed (see my_set_compression).
+ */
+#define FS_FEATURE_COMPRESS 0x2
+
+/**
+ * @def FS_FEATURE_CHECKSUM The data blocks and the inodes carry a CRC32C checksum, verified when they are read.
+ */
+#define FS_FEATURE_CHECKSUM 0x4
+
+/**
+ * @def SNAPSHOT_DIRECTORY The directory of the root directory holding the snapshots taken by fs_snapshot.
+ */
+#define SNAPSHOT_DIRECTORY ".snapshots"
+
 typedef enum {
     KB, MB, GB
 } size_unit_t;
@@ -34,18 +119,52 @@ typedef enum {
     LARGE = 4096
 } block_size_t;
 
+/**
+ * @enum durability_t ufs.h
+ * @brief When the changes made to a mounted partition reach the disk, from the fastest to the safest.
+ * @var DURABILITY_NONE The host decides, only my_fsync and fs_sync wait for the disk.
+ * @var DURABILITY_PERIODIC A background task writes the metadata and syncs the partition every sync_interval_ms.
+ * @var DURABILITY_GROUP Each operation returns once it is on the disk, the concurrent operations share their syncs.
+ * @var DURABILITY_SYNC Each operation syncs the partition on its own before returning.
+ */
+typedef enum {
+    DURABILITY_NONE,
+    DURABILITY_PERIODIC,
+    DURABILITY_GROUP,
+    DURABILITY_SYNC
+} durability_t;
+
 /**
  * @struct file_t ufs.h
  * @brief Represents an opened file.
  * @var inode The inode of the file.
  * @var offset The position of the read/write head.
+ * @var reserved_start The first data block reserved for the next writes of this file.
+ * @var nb_reserved The number of data blocks still reserved (given back when the file is closed).
+ * @var written Whether the file was written or truncated since it was opened (its tail is then packed on close).
  */
 typedef struct {
     char name[MAX_FILENAME];
     uint32_t inode;
     uint32_t offset;
+    uint32_t reserved_start;
+    uint32_t nb_reserved;
+    int written;
 } file_t;
 
+/**
+ * @struct read_view_t ufs.h
+ * @brief A range of a file lent by the library (see my_read_view), valid until it is released.
+ * @var data The content of the range.
+ * @var length The length of the range.
+ * @var entry The cached block lent to the view, NULL if the view owns a private copy of the range.
+ */
+typedef struct {
+    const uint8_t *data;
+    uint32_t length;
+    void *entry;
+} read_view_t;
+
 /**
  * @struct data_t ufs.h
  * @brief This struct represents a data stored in the fs.
@@ -62,14 +181,29 @@ typedef struct{
  * @var memory_size_data
  * @var last_modification
  * @var last_access
- * @var
+ * @var file_type The FILE_TYPE_* of the inode.
+ * @var flags The INODE_* flags of the inode.
+ * @var checksum The CRC32C of the inode (computed with this field set to 0) with FS_FEATURE_CHECKSUM.
+ * @var data_blocks The data blocks of the file, 0 if the block has not been allocated yet.
+ * @var tail_offset The position of the tail in its fragment block when the file has the INODE_TAIL_PACKED flag.
+ * @var cluster_size The compressed size of each cluster of the file, 0 if the cluster is stored uncompressed.
+ * @var inline_data The content of the file when it has the INODE_INLINE_DATA flag.
  */
 typedef struct {
     uint32_t memory_size_data;
     uint32_t last_modification;
     uint32_t last_access;
     uint32_t file_type;
-    uint32_t data_blocks[NB_DATA_BLOCKS_INODE];
+    uint32_t flags;
+    uint32_t checksum;
+    union {
+        struct {
+            uint32_t data_blocks[NB_DATA_BLOCKS_INODE];
+            uint32_t tail_offset;
+            uint32_t cluster_size[NB_DATA_BLOCKS_INODE / COMPRESS_CLUSTER_BLOCKS];
+        };
+        uint8_t inline_data[INLINE_DATA_SIZE];
+    };
 } inode_t;
 
 /**
@@ -83,6 +217,19 @@ typedef struct {
  * @var nb_inodes The number of inodes
  * @var nb_inodes_free The number of free inodes
  * @var nb_inode_blocks The number of inode blocks
+ * @var nb_groups The number of block groups.
+ * @var blocks_per_group The number of blocks of a (full) block group.
+ * @var data_per_group The number of data blocks of a full block group.
+ * @var inodes_per_group The number of inodes of a full block group.
+ * @var gdt_start The index of the first block of the group descriptor table.
+ * @var flags The features of the filesystem.
+ * @var nb_dir_entries The number of entries of the root directory.
+ * @var frag_block The fragment block currently filled with file tails, 0 if there is none.
+ * @var frag_used The number of bytes already used in the current fragment block.
+ * @var dedup_start The index of the first block of the deduplication index (FS_FEATURE_DEDUP).
+ * @var dedup_blocks The number of blocks of the deduplication index.
+ * @var checksum_start The index of the first block of the checksums of the data blocks (FS_FEATURE_CHECKSUM).
+ * @var checksum_blocks The number of blocks of the checksum region.
  */
  typedef struct{
      uint32_t magic_number;
@@ -93,13 +240,222 @@ typedef struct {
      uint32_t nb_inodes;
      uint32_t nb_inodes_free;
      uint32_t nb_inode_blocks;
+     uint32_t nb_groups;
+     uint32_t blocks_per_group;
+     uint32_t data_per_group;
+     uint32_t inodes_per_group;
+     uint32_t gdt_start;
+     uint32_t flags;
+     uint32_t nb_dir_entries;
+     uint32_t frag_block;
+     uint32_t frag_used;
+     uint32_t dedup_start;
+     uint32_t dedup_blocks;
+     uint32_t checksum_start;
+     uint32_t checksum_blocks;
  } super_bloc_t;
 
+/**
+ * @struct group_desc_t ufs.h
+ * @brief This struct represents the descriptor of a block group, stored in the group descriptor table.
+ * @var data_bitmap_start The index of the first block of the data bitmap of the group.
+ * @var inode_bitmap_start The index of the first block of the inode bitmap of the group.
+ * @var inode_table_start The index of the first block of the inode table of the group.
+ * @var data_start The index of the first data block of the group.
+ * @var nb_data The number of data blocks of the group.
+ * @var nb_data_free The number of free data blocks of the group.
+ * @var nb_inodes The number of inodes of the group.
+ * @var nb_inodes_free The number of free inodes of the group.
+ * @var flags The BG_*_UNINIT flags of the regions of the group that have not been zeroed yet.
+ * @var data_bitmap_init The number of data bitmap blocks already zeroed.
+ * @var inode_bitmap_init The number of inode bitmap blocks already zeroed.
+ * @var inode_table_init The number of inode table blocks already zeroed.
+ */
+typedef struct {
+    uint32_t data_bitmap_start;
+    uint32_t inode_bitmap_start;
+    uint32_t inode_table_start;
+    uint32_t data_start;
+    uint32_t nb_data;
+    uint32_t nb_data_free;
+    uint32_t nb_inodes;
+    uint32_t nb_inodes_free;
+    uint32_t flags;
+    uint32_t data_bitmap_init;
+    uint32_t inode_bitmap_init;
+    uint32_t inode_table_init;
+    uint32_t reserved[4];
+} group_desc_t;
+
+/**
+ * @struct mkfs_options_t ufs.h
+ * @brief The options used to create a file system.
+ * @var block_size The size of the blocks (1024, 2048 or 4096 bytes).
+ * @var nb_inodes The percentage of the blocks used by the inode tables.
+ * @var blocks_per_group The number of blocks of a block group, 0 to use a single group (ext2 uses 8 * block_size).
+ * @var features The FS_FEATURE_* flags of the filesystem.
+ * @var root_dir A host directory whose regular files and directories are copied into the filesystem while it is created (like
+ * mke2fs -d), NULL to create an empty filesystem.
+ */
+typedef struct {
+    block_size_t block_size;
+    uint8_t nb_inodes;
+    uint32_t blocks_per_group;
+    uint32_t features;
+    const char *root_dir;
+} mkfs_options_t;
+
+/**
+ * @struct mount_options_t ufs.h
+ * @brief The options used to mount a file system.
+ * @var durability When the changes reach the disk.
+ * @var sync_interval_ms The time between two syncs with DURABILITY_PERIODIC, 0 for the default one.
+ * @var direct_io Non-zero to open the image with O_DIRECT, so that it is not cached by the host too.
+ */
+typedef struct {
+    durability_t durability;
+    uint32_t sync_interval_ms;
+    int direct_io;
+} mount_options_t;
+
  typedef struct {
      char name[MAX_FILENAME];
      uint32_t inode;
  } dir_entry_t;
 
+/**
+ * @struct dir_stream_t ufs.h
+ * @brief An iterator over the entries of a directory, returned by my_opendir.
+ */
+typedef struct dir_stream dir_stream_t;
+
+/**
+ * @struct file_stat_t ufs.h
+ * @brief The metadata of a file, returned by my_stat.
+ * @var inode The inode of the file.
+ * @var size The size of the file in bytes.
+ * @var nb_blocks The number of data blocks referenced by the file, 0 when its content is kept in its inode.
+ * @var nb_extents The number of runs of contiguous data blocks of the file (1 when it is not fragmented).
+ * @var last_modification The time of the last modification of the file.
+ * @var last_access The time of the last access to the file.
+ * @var file_type The FILE_TYPE_* of the file.
+ * @var flags The INODE_* flags of the file.
+ */
+typedef struct {
+    uint32_t inode;
+    uint32_t size;
+    uint32_t nb_blocks;
+    uint32_t nb_extents;
+    uint32_t last_modification;
+    uint32_t last_access;
+    uint32_t file_type;
+    uint32_t flags;
+} file_stat_t;
+
+/**
+ * @struct dedup_entry_t ufs.h
+ * @brief An entry of the deduplication index.
+ * @var hash The hash of the content of the block.
+ * @var block The index of the data block, 0 if the entry is empty.
+ */
+typedef struct {
+    uint64_t hash;
+    uint32_t block;
+    uint32_t reserved;
+} dedup_entry_t;
+
+/**
+ * @def REPORT_EXTENT_BUCKETS The number of buckets of the histogram of the free extents, one per power of two.
+ */
+#define REPORT_EXTENT_BUCKETS 32
+
+/**
+ * @struct region_report_t ufs.h
+ * @brief The utilization of a block group, in a report of fs_analyze.
+ * @var nb_data The number of data blocks of the group.
+ * @var nb_data_used The number of data blocks used.
+ * @var nb_inodes The number of inodes of the group.
+ * @var nb_inodes_used The number of inodes used.
+ * @var largest_free_run The length of the longest run of free data blocks of the group.
+ */
+typedef struct {
+    uint32_t nb_data;
+    uint32_t nb_data_used;
+    uint32_t nb_inodes;
+    uint32_t nb_inodes_used;
+    uint32_t largest_free_run;
+} region_report_t;
+
+/**
+ * @struct fs_report_t ufs.h
+ * @brief The layout of a filesystem, returned by fs_analyze.
+ * @var nb_free_extents The number of runs of free data blocks (a run never crosses a block group).
+ * @var free_extents The number of runs of free data blocks whose length is in [2^b, 2^(b+1)), for each bucket b.
+ * @var free_extent_blocks The number of free data blocks in the runs of each bucket.
+ * @var largest_free_run The length of the longest run of free data blocks.
+ * @var nb_files The number of regular files.
+ * @var nb_directories The number of directories (the root directory has no inode and is not counted).
+ * @var nb_file_blocks The number of data blocks referenced by the regular files (a shared block counts once per file).
+ * @var nb_file_extents The number of extents of the regular files.
+ * @var files_by_extents The number of regular files with k extents, for each k (0 for the files without data block).
+ * @var fragmentation The average, over the regular files with at least two blocks, of (extents - 1) / (blocks - 1):
+ * 0 when each of them is contiguous, 1 when none of their blocks follows the previous one.
+ * @var nb_regions The number of block groups.
+ * @var regions The utilization of each block group.
+ */
+typedef struct {
+    uint32_t nb_free_extents;
+    uint32_t free_extents[REPORT_EXTENT_BUCKETS];
+    uint32_t free_extent_blocks[REPORT_EXTENT_BUCKETS];
+    uint32_t largest_free_run;
+    uint32_t nb_files;
+    uint32_t nb_directories;
+    uint32_t nb_file_blocks;
+    uint32_t nb_file_extents;
+    uint32_t files_by_extents[NB_DATA_BLOCKS_INODE + 1];
+    double fragmentation;
+    uint32_t nb_regions;
+    region_report_t *regions;
+} fs_report_t;
+
+/**
+ * @struct fsck_report_t ufs.h
+ * @brief The conflicts found by fs_check.
+ * @var nb_inodes The number of used inodes checked.
+ * @var nb_directories The number of directories walked, the root directory included.
+ * @var nb_entries The number of directory entries checked.
+ * @var bad_inodes The number of used inodes that cannot be trusted (checksum mismatch, unknown type or invalid inline
+ * size). They are freed by a repair.
+ * @var bad_blocks The number of references of an inode to a block outside of the data blocks, or to a block of the
+ * root directory. They are cleared by a repair, leaving holes.
+ * @var dangling_entries The number of entries naming an inode that is free, out of range or bad. They are removed by a
+ * repair.
+ * @var duplicate_entries The number of entries naming an inode already named by another entry. They are removed by a
+ * repair.
+ * @var orphan_inodes The number of used inodes that no entry reachable from the root directory names. They are freed
+ * by a repair, with the blocks they reference.
+ * @var data_errors The number of data blocks whose entry in the data bitmap disagrees with the references to them:
+ * leaked blocks, referenced blocks marked free and wrong reference counts.
+ * @var checksum_errors The number of data blocks referenced by the inodes whose content does not match its checksum,
+ * with FS_FEATURE_CHECKSUM. They are not repaired, the files keep their content.
+ * @var counter_errors The number of free counters of the groups and of the superblock that were wrong.
+ * @var nb_repaired The number of conflicts repaired.
+ */
+typedef struct {
+    uint32_t nb_inodes;
+    uint32_t nb_directories;
+    uint32_t nb_entries;
+    uint32_t bad_inodes;
+    uint32_t bad_blocks;
+    uint32_t dangling_entries;
+    uint32_t duplicate_entries;
+    uint32_t orphan_inodes;
+    uint32_t data_errors;
+    uint32_t checksum_errors;
+    uint32_t counter_errors;
+    uint32_t nb_repaired;
+} fsck_report_t;
+
 /**
  * @brief Formats the named partition as a new ufs partition with 4Ko blocks.
  * @param partition_name The name of the partition to format.
@@ -108,12 +464,33 @@ typedef struct {
 int my_format(char *partition_name);
 
 /**
- * @brief Opens a file based on its name.
- * @param file_name The name of the file to open.
- * @return A struct representing the file.
+ * @brief Opens a file based on its path, creating it in its directory if it does not exist yet.
+ * @param file_name The path of the file to open (names separated by '/', from the root directory).
+ * @return A struct representing the file (named after the last name of the path), NULL if an error occurs.
+ *
+ * A subdirectory holds at most MAX_SUBDIR_ENTRIES entries and the root directory the entries of the blocks reserved
+ * for it by the format: creating a file in a full directory fails and leaves the partition unchanged.
+ *
+ * my_open, my_open_many, my_close and my_unlink hold the lock of the opened files while they resolve their paths and
+ * change the table of the opened files, so they can be called from several threads. The other calls taking a path
+ * (my_mkdir, my_rename, my_clone, my_stat, my_opendir and the snapshots) resolve it without the lock: the caller must
+ * not run them at the same time as another call taking a path.
  */
 file_t* my_open(char *file_name);
 
+/**
+ * @brief Opens several files at once, creating the ones that do not exist yet.
+ * @param file_names The names of the files.
+ * @param nb_files The number of files.
+ * @param files Where to store the opened files, in the order of the names (a name given twice is opened twice).
+ * @return The number of files opened, -1 if an error occurs (no file is opened then, but some may have been created).
+ *
+ * The names are sorted and deduplicated, the missing files are created together and the directory, bitmaps and
+ * group descriptors are written once for the whole batch. The files of a directory are created all together or not
+ * at all, so a batch that does not fit in the directory (see my_open) creates none of them there.
+ */
+int my_open_many(char **file_names, int nb_files, file_t **files);
+
 /**
  * @brief Closes a file
  * @param t The file to close.
@@ -121,26 +498,86 @@ file_t* my_open(char *file_name);
  */
 int my_close(file_t *f);
 
+/**
+ * @brief Waits for the content and the metadata of a file to be on the disk.
+ * @param f The file.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The syncs requested at the same time, by my_fsync, fs_sync or the operations of a DURABILITY_GROUP partition, are
+ * done by a single fdatasync of the image.
+ */
+int my_fsync(file_t *f);
+
 /**
  * @brief Writes the content in the buffer into the named file.
  * @param f The file where to store the data.
  * @param buffer The buffer to store in the file.
  * @param nb_bytes The number of bytes to write.
  * @return The number of bytes actually written in the file.
+ *
+ * Only the blocks written are allocated: writing past the end of the file leaves a hole, and a block that only holds
+ * zeros is not stored.
  */
 int my_write(file_t *f, void *buffer, int nb_bytes);
 
+/**
+ * @brief Writes the content of several buffers into the file, one after the other, as a single write: the inode is
+ * read, the range translated and the inode updated once for all the buffers.
+ * @param f The file where to store the data.
+ * @param iov The buffers to store in the file.
+ * @param iovcnt The number of buffers.
+ * @return The number of bytes actually written in the file, -1 if an error occurs.
+ */
+int my_writev(file_t *f, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Enables or disables the compression of the next writes of a file, the clusters already written are kept as is.
+ * @param f The file.
+ * @param enabled 1 to compress the file, 0 otherwise.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int my_set_compression(file_t *f, int enabled);
+
 /**
  * @brief Reads the content of the file and writes it into the buffer.
  * @param f The file where to read the data.
  * @param buffer The buffer where to store the content.
  * @param nb_bytes The number of bytes to read from the file.
  * @return The number of bytes actually read.
+ *
+ * The holes of the file read as zeros, without accessing the disk.
  */
 int my_read(file_t *f, void *buffer, int nb_bytes);
 
 /**
- * @brief Moves the read/write pointer in the file.
+ * @brief Reads the content of the file into several buffers, filling them one after the other, as a single read.
+ * @param f The file where to read the data.
+ * @param iov The buffers where to store the content.
+ * @param iovcnt The number of buffers.
+ * @return The number of bytes actually read, -1 if an error occurs.
+ */
+int my_readv(file_t *f, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Lends the content of the file at the position of the read/write head, without copying it: the view points
+ * into the block cache of the library, shared by all the readers of the block. The view stops at the end of the block,
+ * and the position moves past it.
+ * @param f The file where to read the data.
+ * @param nb_bytes The maximum number of bytes of the view.
+ * @param view Where to store the view, to give back with my_release_view (before umount).
+ * @return The length of the view (0 at the end of the file), -1 if an error occurs.
+ */
+int my_read_view(file_t *f, int nb_bytes, read_view_t *view);
+
+/**
+ * @brief Gives back a view returned by my_read_view.
+ * @param view The view.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int my_release_view(read_view_t *view);
+
+/**
+ * @brief Moves the read/write pointer in the file, possibly past its end.
  * @param f The file.
  * @param offset The number of bytes.
  * @param base The base.
@@ -159,18 +596,57 @@ int mkpart(char *path, size_t size, size_unit_t unit);
  * @brief Create a file system.
  * @param path The path of the partition where to create the file system.
  * @param block_size The size of the blocks (1024, 2048 or 4096 bytes).
- * @param nb_inodes The ratio of inodes to the data blocks.
- * @return
+ * @param nb_inodes The percentage of the blocks used by the inode table.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The file system uses a single block group.
+ * @see mkfs_with_options
  */
 int mkfs(char *path, block_size_t block_size, uint8_t nb_inodes);
 
+/**
+ * @brief Create a file system with the given options.
+ * @param path The path of the partition where to create the file system.
+ * @param options The options of the file system.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * Each block group has its own bitmaps, inode table and free counters, so the data of a file is allocated near
+ * its inode and threads allocating in different groups do not contend. The metadata regions are zeroed with
+ * fallocate when the host supports it. Otherwise they are marked as uninitialized in the group descriptor and
+ * zeroed on first use or by a background task once mounted.
+ *
+ * With a root_dir, the files and directories of the host tree are created at the same paths. Their data blocks are
+ * laid out contiguously in name order, each directory before its content, and the data, inode tables, bitmaps and
+ * directories are written in a single pass. The small tails of the regular files are packed in fragment blocks, as
+ * they are when a file written is closed.
+ */
+int mkfs_with_options(char *path, mkfs_options_t options);
+
 /**
  * @brief Mount a filesystem so it can be used to read and create files.
  * @param path The path of the partition where the filesystem is located.
  * @return 0 if everything went well, -1 otherwise.
+ *
+ * The changes reach the disk when the host decides (DURABILITY_NONE).
+ * @see mount_with_options
  */
 int mount(char *path);
 
+/**
+ * @brief Mount a filesystem with the given options.
+ * @param path The path of the partition where the filesystem is located.
+ * @param options The options of the mount.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * With DURABILITY_GROUP and DURABILITY_SYNC, the calls changing the filesystem (creations, writes, truncations,
+ * closes, renames, deletions...) only return once their changes are on the disk. The image is synced with fdatasync.
+ *
+ * With direct_io, every transfer with the image covers whole blocks from a buffer aligned on the blocks. The
+ * transfers that are not aligned go through a fixed pool of aligned buffers, the blocks written partially being read
+ * first. The mount fails if the host does not accept direct transfers of the blocks of the partition.
+ */
+int mount_with_options(char *path, mount_options_t options);
+
 /**
  * @brief Unmount a partition.
  * @return 0 if everything went well, -1 otherwise.
@@ -184,8 +660,177 @@ int umount();
  */
 size_t size(file_t *f);
 
+/**
+ * @brief Creates a directory.
+ * @param path The path of the directory, whose parent directory must exist.
+ * @return 0 if everything went well, -1 otherwise (also when the path already exists or its parent directory is full).
+ *
+ * The new directory holds at most MAX_SUBDIR_ENTRIES entries, as it has no indirect blocks.
+ */
+int my_mkdir(char *path);
+
+/**
+ * @brief Moves a file or a directory, possibly to another directory.
+ * @param old_path The current path.
+ * @param new_path The new path, which must not exist yet (a directory cannot be moved inside itself).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int my_rename(char *old_path, char *new_path);
+
+/**
+ * @brief Deletes a file.
+ * @param path The path of the file, which must not be a directory nor be opened.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The name and the inode are removed right away, the data blocks are freed by a background task by batches: the
+ * free data counters catch up within a second, or as soon as a write runs out of free blocks.
+ */
+int my_unlink(char *path);
+
+/**
+ * @brief Changes the size of an opened file.
+ * @param f The file.
+ * @param size The new size: a smaller file loses its end, a larger file reads zeros up to its new end.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * Like with my_unlink, the blocks past the new end are freed in the background.
+ */
+int my_truncate(file_t *f, int size);
+
+/**
+ * @brief Clones a file, or a directory with all its content, without copying the data.
+ * @param src_path The path of the file or the directory to clone ("/" for the root directory).
+ * @param dst_path The path of the clone, which must not exist yet.
+ * @return 0 if everything went well, -1 otherwise (also when a file to clone is opened).
+ *
+ * Only the inodes and the directories are copied, the data blocks are shared and gain a reference. A write to a
+ * shared block, from either side, goes to a private copy (copy-on-write). A block that already has as many
+ * references as it can hold is copied right away. The clone of the root directory leaves SNAPSHOT_DIRECTORY out.
+ */
+int my_clone(char *src_path, char *dst_path);
+
+/**
+ * @brief Returns the metadata of a file or a directory without opening it.
+ * @param file_name The path of the file.
+ * @param st Where to store the metadata.
+ * @return 0 if everything went well, -1 if there is no file with this name or an error occurs.
+ */
+int my_stat(char *file_name, file_stat_t *st);
+
+/**
+ * @brief Starts listing the entries of a directory, in the order of their names.
+ * @param path The path of the directory ("/" or "" for the root directory).
+ * @return The iterator, NULL if an error occurs.
+ *
+ * The entries are streamed a block at a time: a listing does not load the directory in memory. An iterator that
+ * is used while files are created may skip or repeat entries.
+ */
+dir_stream_t* my_opendir(char *path);
+
+/**
+ * @brief Returns the next entry of a directory.
+ * @param d The iterator.
+ * @return The entry (valid until the next call), NULL at the end of the directory or if an error occurs.
+ */
+dir_entry_t* my_readdir(dir_stream_t *d);
+
+/**
+ * @brief Ends the listing of a directory.
+ * @param d The iterator.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int my_closedir(dir_stream_t *d);
+
 /**
  * @brief Prints the usage of the filesystem (ratio of inode and data blocks used).
  * @return 0 if everything went well, -1 otherwise.
  */
-int fs_usage();
\ No newline at end of file
+int fs_usage();
+
+/**
+ * @brief Gives the storage of every free data block back to the host, by punching holes in the image.
+ * @return The number of data blocks punched, -1 if an error occurs or if the host does not support it.
+ *
+ * The blocks freed while the partition is mounted are already discarded in the background, by batches. Trimming
+ * catches up with the blocks freed before, or dropped when too many were freed at once.
+ */
+int64_t fs_trim();
+
+/**
+ * @brief Moves the data blocks of each fragmented file to a single run of free blocks, while the partition is mounted.
+ * @param max_blocks_per_s The number of blocks moved per second at most, 0 for no limit.
+ * @return The number of data blocks moved, -1 if an error occurs.
+ *
+ * The opened files are skipped, the other threads can keep reading and writing them. A file is moved in one step,
+ * after which the defragmentation pauses, so that it never holds the disk for long. The files sharing deduplicated
+ * blocks are left as is.
+ */
+int64_t fs_defrag(uint32_t max_blocks_per_s);
+
+/**
+ * @brief Analyzes the layout of the mounted filesystem: its free space, the fragmentation of its files and the
+ * utilization of each block group.
+ * @param report Where to store the report, to be released with fs_free_report.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The report takes a single pass over the bitmaps and the inode tables. The inode tables are read by large
+ * sequential reads, skipping the parts without used inodes. The bitmaps are read under the lock of their group, so
+ * the report of a partition in use is a snapshot taken group by group.
+ */
+int fs_analyze(fs_report_t *report);
+
+/**
+ * @brief Releases a report of fs_analyze.
+ * @param report The report.
+ */
+void fs_free_report(fs_report_t *report);
+
+/**
+ * @brief Checks the consistency of the mounted filesystem: the data and inode bitmaps, the blocks referenced by the
+ * inodes (and their checksums with FS_FEATURE_CHECKSUM), the tree of directories and the free counters of the groups
+ * and of the superblock.
+ * @param repair Non-zero to repair the conflicts found, 0 to only report them.
+ * @param nb_threads The number of threads scanning the partition, 0 for one per online processor.
+ * @param report Where to store the conflicts found.
+ * @return The number of conflicts found, -1 if an error occurs or if a file is opened.
+ *
+ * The reference counts of the data blocks and the reachable inodes are rebuilt in memory, by threads taking chunks
+ * of the inode tables, then the directories of each level of the tree, then the groups to compare with their bitmaps.
+ * The inode tables are read by large sequential reads skipping the parts without used inodes, so that the check is
+ * bound by the bandwidth of the disk. It must not run alongside other calls.
+ */
+int fs_check(int repair, uint32_t nb_threads, fsck_report_t *report);
+
+/**
+ * @brief Takes a snapshot of the whole filesystem, as a clone of the root directory in SNAPSHOT_DIRECTORY.
+ * @param name The name of the snapshot.
+ * @return 0 if everything went well, -1 otherwise (also when a file is opened).
+ *
+ * Like my_clone, a snapshot only costs its inodes and its directories. Its files can be read like any other, and a
+ * write to them does not change the filesystem they were taken from.
+ */
+int fs_snapshot(char *name);
+
+/**
+ * @brief Brings the filesystem back to a snapshot: everything but SNAPSHOT_DIRECTORY is replaced by a clone of it.
+ * @param name The name of the snapshot, which is kept.
+ * @return 0 if everything went well, -1 otherwise (also when a file is opened).
+ */
+int fs_rollback(char *name);
+
+/**
+ * @brief Deletes a snapshot, the data blocks it was the last to reference are freed in the background.
+ * @param name The name of the snapshot.
+ * @return 0 if everything went well, -1 otherwise (also when a file is opened).
+ */
+int fs_delete_snapshot(char *name);
+
+/**
+ * @brief Waits for all the changes made to the mounted filesystem to be on the disk, including the blocks freed in
+ * the background.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The superblock is written with the bitmaps and the group descriptors, as by every operation. Its free counters may
+ * lag behind the groups, so mount sums them from the group descriptors.
+ */
+int fs_sync();
\ No newline at end of file
@@ -75,8 +75,9 @@ void my_log(log_level_t level, char *msg) {
     struct tm tm = *localtime(&t);
 
     if (!logger->config.colored_stdout) {
+        // The lines longer than line_max_length are truncated, their end of line is written separately
         char *log_data = malloc(logger->config.line_max_length * sizeof(char));
-        sprintf(log_data, "%d-%d-%d %d:%d:%d [%s] %s\n",
+        snprintf(log_data, logger->config.line_max_length, "%d-%d-%d %d:%d:%d [%s] %s",
                 tm.tm_mday,
                 tm.tm_mon,
                 tm.tm_year + 1900,
@@ -86,8 +87,10 @@ void my_log(log_level_t level, char *msg) {
                 get_level_name(level),
                 msg);
 
-        if (logger->config.log_to_stdout && (level >= logger->config.stdout_min_level))
+        if (logger->config.log_to_stdout && (level >= logger->config.stdout_min_level)) {
             fputs(log_data, stdout);
+            fputc('\n', stdout);
+        }
 
         if (logger->config.log_to_file && (level >= logger->config.file_min_level)) {
             FILE *fptr;
@@ -99,6 +102,7 @@ void my_log(log_level_t level, char *msg) {
             }
 
             fputs(log_data, fptr);
+            fputc('\n', fptr);
             fclose(fptr);
         }
         free(log_data);
@@ -127,7 +131,7 @@ void my_log(log_level_t level, char *msg) {
             }
 
             char *logData = malloc(logger->config.line_max_length * sizeof(char));
-            sprintf(logData, "%d-%d-%d %d:%d:%d [%s] %s\n",
+            snprintf(logData, logger->config.line_max_length, "%d-%d-%d %d:%d:%d [%s] %s",
                     tm.tm_mday,
                     tm.tm_mon,
                     tm.tm_year + 1900,
@@ -138,6 +142,7 @@ void my_log(log_level_t level, char *msg) {
                     msg);
 
             fputs(logData, fptr);
+            fputc('\n', fptr);
             free(logData);
             fclose(fptr);
         }
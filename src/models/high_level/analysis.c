@@ -0,0 +1,199 @@
+/**
+ * @file analysis.c
+ * @brief This file contains the implementation of the analysis of the layout of a mounted partition.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/direct_io.h"
+#include "../mid_level/bitmap.h"
+#include "analysis.h"
+#include "defrag.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Adds a run of free data blocks to a report.
+ * @param report The report.
+ * @param region The report of the group of the run.
+ * @param length The length of the run.
+ */
+static void add_free_run(fs_report_t *report, region_report_t *region, uint32_t length) {
+    uint32_t b = 31 - __builtin_clz(length);
+    report->nb_free_extents++;
+    report->free_extents[b]++;
+    report->free_extent_blocks[b] += length;
+    if (length > report->largest_free_run) {
+        report->largest_free_run = length;
+    }
+    if (length > region->largest_free_run) {
+        region->largest_free_run = length;
+    }
+}
+
+/**
+ * @brief Measures the data bitmap of a group, under the lock of the group.
+ * @param p The partition.
+ * @param g The index of the group.
+ * @param report The report.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int analyze_data_bitmap(partition_t *p, uint32_t g, fs_report_t *report) {
+    group_t *group = p->groups + g;
+    region_report_t *region = report->regions + g;
+    region->nb_data = group->desc->nb_data;
+
+    pthread_mutex_lock(&group->lock);
+    uint32_t run = 0;
+    for (uint32_t j = 0; j < group->desc->nb_data; j++) {
+        int entry = get_bitmap(p, &group->data_bitmap, j);
+        if (entry == -1) {
+            pthread_mutex_unlock(&group->lock);
+            return -1;
+        }
+        if (entry == 0) {
+            run++;
+            continue;
+        }
+        region->nb_data_used++;
+        if (run > 0) {
+            add_free_run(report, region, run);
+            run = 0;
+        }
+    }
+    pthread_mutex_unlock(&group->lock);
+
+    // A run stops at the end of the group, the next data region starts after the metadata of the next group
+    if (run > 0) {
+        add_free_run(report, region, run);
+    }
+    return 0;
+}
+
+/**
+ * @brief Adds a file or a directory to a report.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @param report The report.
+ * @param score The sum of the fragmentation scores, updated.
+ * @param nb_scored The number of files scored, updated.
+ */
+static void analyze_inode(partition_t *p, inode_t *inode, fs_report_t *report, double *score, uint32_t *nb_scored) {
+    if (inode->file_type == FILE_TYPE_DIRECTORY) {
+        report->nb_directories++;
+        return;
+    }
+
+    uint32_t nb_blocks = 0;
+    if (!(inode->flags & INODE_INLINE_DATA)) {
+        for (uint32_t k = 0; k < NB_DATA_BLOCKS_INODE; k++) {
+            nb_blocks += inode->data_blocks[k] != 0;
+        }
+    }
+    uint32_t nb_extents = count_extents(p, inode);
+    report->nb_files++;
+    report->nb_file_blocks += nb_blocks;
+    report->nb_file_extents += nb_extents;
+    report->files_by_extents[nb_extents]++;
+
+    // The packed tail is not part of the extents, so it is not part of the score either
+    uint32_t nb_placed = (inode->flags & INODE_TAIL_PACKED) && nb_blocks > 0 ? nb_blocks - 1 : nb_blocks;
+    if (nb_placed >= 2) {
+        *score += (double) (nb_extents - 1) / (double) (nb_placed - 1);
+        (*nb_scored)++;
+    }
+}
+
+/**
+ * @brief Measures the inode table of a group, read by batches of blocks.
+ * @param p The partition.
+ * @param g The index of the group.
+ * @param buffer A buffer of ANALYSIS_INODE_BATCH blocks.
+ * @param used A buffer of one entry per inode of the batch.
+ * @param report The report.
+ * @param score The sum of the fragmentation scores, updated.
+ * @param nb_scored The number of files scored, updated.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int analyze_inode_table(partition_t *p, uint32_t g, uint8_t *buffer, uint8_t *used, fs_report_t *report,
+                               double *score, uint32_t *nb_scored) {
+    group_t *group = p->groups + g;
+    region_report_t *region = report->regions + g;
+    region->nb_inodes = group->desc->nb_inodes;
+
+    uint32_t batch = ANALYSIS_INODE_BATCH * (p->super_bloc.block_size / sizeof(inode_t));
+    for (uint32_t first = 0; first < group->desc->nb_inodes; first += batch) {
+        uint32_t n = group->desc->nb_inodes - first < batch ? group->desc->nb_inodes - first : batch;
+
+        uint32_t nb_used = 0;
+        pthread_mutex_lock(&group->lock);
+        for (uint32_t j = 0; j < n; j++) {
+            used[j] = get_bitmap(p, &group->inode_bitmap, first + j) > 0;
+            nb_used += used[j];
+        }
+        pthread_mutex_unlock(&group->lock);
+        region->nb_inodes_used += nb_used;
+
+        // The empty parts of the table are not read
+        if (nb_used == 0) {
+            continue;
+        }
+        off_t offset = (off_t) group->desc->inode_table_start * p->super_bloc.block_size + (off_t) first * sizeof(inode_t);
+        if (read_image(p, buffer, (size_t) n * sizeof(inode_t), offset) == -1) {
+            logger->error("An error occurred when trying to read the inode table.");
+            return -1;
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            if (used[j]) {
+                analyze_inode(p, (inode_t*) (buffer + j * sizeof(inode_t)), report, score, nb_scored);
+            }
+        }
+    }
+    return 0;
+}
+
+int analyze_partition(partition_t *p, fs_report_t *report) {
+    memset(report, 0, sizeof(fs_report_t));
+    uint32_t batch = ANALYSIS_INODE_BATCH * (p->super_bloc.block_size / sizeof(inode_t));
+    uint8_t *buffer = (uint8_t*) malloc((size_t) ANALYSIS_INODE_BATCH * p->super_bloc.block_size);
+    uint8_t *used = (uint8_t*) malloc(batch);
+    report->regions = (region_report_t*) calloc(p->super_bloc.nb_groups, sizeof(region_report_t));
+    if (buffer == NULL || used == NULL || report->regions == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(buffer);
+        free(used);
+        free(report->regions);
+        report->regions = NULL;
+        return -1;
+    }
+    report->nb_regions = p->super_bloc.nb_groups;
+
+    double score = 0;
+    uint32_t nb_scored = 0;
+    int ret = 0;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups && ret == 0; g++) {
+        if (analyze_data_bitmap(p, g, report) == -1
+            || analyze_inode_table(p, g, buffer, used, report, &score, &nb_scored) == -1) {
+            ret = -1;
+        }
+    }
+    report->fragmentation = nb_scored > 0 ? score / nb_scored : 0;
+
+    free(buffer);
+    free(used);
+    if (ret == -1) {
+        free(report->regions);
+        report->regions = NULL;
+        report->nb_regions = 0;
+        return -1;
+    }
+    logger->trace("Partition analyzed.");
+    return 0;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file analysis.h
+ * @brief This file contains the analysis of the layout of a mounted partition.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def ANALYSIS_INODE_BATCH The number of inode table blocks read at once.
+ */
+#define ANALYSIS_INODE_BATCH 64
+
+/**
+ * @brief Measures the free space, the fragmentation of the files and the utilization of each group of a partition.
+ * @param p The mounted partition.
+ * @param report Where to store the report (its regions are allocated).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int analyze_partition(partition_t *p, fs_report_t *report);
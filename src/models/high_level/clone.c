@@ -0,0 +1,369 @@
+/**
+ * @file clone.c
+ * @brief This file contains the implementation of the copy-on-write clones of files and trees of directories.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "logging/logging.h"
+
+#include "../mid_level/data.h"
+#include "../mid_level/dentry.h"
+#include "../mid_level/group.h"
+#include "../mid_level/inode.h"
+#include "clone.h"
+#include "file.h"
+#include "namespace.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Reads all the entries of a directory.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param nb_entries Where to store the number of entries.
+ * @return The entries, NULL if an error occurs.
+ */
+static dir_entry_t* read_entries(partition_t *p, uint32_t dir, uint32_t *nb_entries) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t per_block = bs / sizeof(dir_entry_t);
+
+    dir_entry_t *entries;
+    if ((entries = (dir_entry_t*) malloc(bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return NULL;
+    }
+    if (read_dir_block(p, dir, 0, entries, nb_entries) == -1) {
+        free(entries);
+        return NULL;
+    }
+
+    uint32_t nb_blocks = DIV_ROUND_UP(*nb_entries, per_block);
+    if (nb_blocks > 1) {
+        dir_entry_t *all;
+        if ((all = (dir_entry_t*) realloc(entries, (size_t) nb_blocks * bs)) == NULL) {
+            logger->error("An error occurred when trying to allocate memory.");
+            free(entries);
+            return NULL;
+        }
+        entries = all;
+    }
+    for (uint32_t k = 1; k < nb_blocks; k++) {
+        uint32_t nb;
+        if (read_dir_block(p, dir, k, entries + k * per_block, &nb) == -1) {
+            free(entries);
+            return NULL;
+        }
+    }
+    return entries;
+}
+
+/**
+ * @brief Tells whether a file is opened. The lock of the opened files must be held.
+ * @param p The partition.
+ * @param i The inode of the file.
+ * @return Whether it is opened.
+ */
+static bool is_opened(partition_t *p, uint32_t i) {
+    for (uint32_t k = 0; k < p->nb_opened_files; k++) {
+        if (p->opened_files[k]->inode == i) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Gives a data block to a clone: a new reference, or a copy when the block has as many references as it can.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @param block A buffer of one block.
+ * @return The data block of the clone, 0 if an error occurs.
+ */
+static uint32_t share_data(partition_t *p, uint32_t i, uint8_t *block) {
+    if (ref_data(p, i) == 0) {
+        return i;
+    }
+
+    uint32_t copy;
+    if (read_data(p, block, i) == -1 || (copy = allocate_data(p, data_group(p, i))) == 0) {
+        logger->error("An error occurred when trying to copy a shared data block.");
+        return 0;
+    }
+    if (update_data(p, block, copy) == -1) {
+        unref_data(p, copy);
+        return 0;
+    }
+    return copy;
+}
+
+/**
+ * @brief Clones a file, its inode is copied and its data blocks are shared.
+ * @param p The partition.
+ * @param i The inode of the file.
+ * @param inode The inode of the file.
+ * @return The inode of the clone, nb_inodes + 1 if an error occurs.
+ */
+static uint32_t clone_file(partition_t *p, uint32_t i, inode_t *inode) {
+    uint32_t error = p->super_bloc.nb_inodes + 1;
+    if (is_opened(p, i)) {
+        logger->error("You are trying to clone an opened file.");
+        return error;
+    }
+
+    uint8_t *block;
+    if ((block = (uint8_t*) malloc(p->super_bloc.block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return error;
+    }
+
+    // A packed tail shares the fragment block of the source, like the other blocks
+    inode_t clone = *inode;
+    bool blocks = !(inode->flags & INODE_INLINE_DATA);
+    uint32_t k = 0;
+    while (blocks && k < NB_DATA_BLOCKS_INODE
+           && (inode->data_blocks[k] == 0 || (clone.data_blocks[k] = share_data(p, inode->data_blocks[k], block)) != 0)) {
+        k++;
+    }
+    free(block);
+
+    // The clone is placed in the group of its source, next to the blocks it shares
+    uint32_t c = error;
+    if ((!blocks || k == NB_DATA_BLOCKS_INODE) && (c = allocate_inode(p, inode_group(p, i))) != error
+        && update_inode(p, clone, c) == -1) {
+        delete_inode(p, c);
+        c = error;
+    }
+    if (c == error) {
+        for (uint32_t j = 0; blocks && j < k; j++) {
+            if (clone.data_blocks[j] != 0) {
+                unref_data(p, clone.data_blocks[j]);
+            }
+        }
+        logger->error("An error occurred when trying to clone a file.");
+    }
+    return c;
+}
+
+/**
+ * @brief Clones the entries of a directory, and adds them to the clone of the directory.
+ * @param p The partition.
+ * @param dir The inode of the directory.
+ * @param clone The inode of the clone of the directory.
+ * @param skip An entry to leave out, ROOT_DIRECTORY for none.
+ * @return 0 if everything went well, -1 otherwise (the entries cloned so far are deleted).
+ */
+static int clone_entries(partition_t *p, uint32_t dir, uint32_t clone, uint32_t skip) {
+    uint32_t nb_entries;
+    dir_entry_t *entries;
+    if ((entries = read_entries(p, dir, &nb_entries)) == NULL) {
+        return -1;
+    }
+
+    // The files and the directories are added separately, each part stays sorted by name
+    dir_entry_t *files = (dir_entry_t*) calloc(nb_entries + 1, sizeof(dir_entry_t));
+    dir_entry_t *dirs = (dir_entry_t*) calloc(nb_entries + 1, sizeof(dir_entry_t));
+    uint32_t nb_files = 0;
+    uint32_t nb_dirs = 0;
+    int ret = files != NULL && dirs != NULL ? 0 : -1;
+    for (uint32_t e = 0; e < nb_entries && ret == 0; e++) {
+        if (entries[e].inode == skip) {
+            continue;
+        }
+        inode_t inode;
+        if (read_inode(p, &inode, entries[e].inode) == -1) {
+            ret = -1;
+            break;
+        }
+        dir_entry_t *entry = inode.file_type == FILE_TYPE_DIRECTORY ? dirs + nb_dirs : files + nb_files;
+        *entry = entries[e];
+        if ((entry->inode = clone_tree(p, entries[e].inode, ROOT_DIRECTORY)) == p->super_bloc.nb_inodes + 1) {
+            ret = -1;
+            break;
+        }
+        if (inode.file_type == FILE_TYPE_DIRECTORY) {
+            nb_dirs++;
+        } else {
+            nb_files++;
+        }
+    }
+    free(entries);
+
+    if (ret == 0 && ((nb_files > 0 && add_entries(p, clone, files, nb_files, FILE_TYPE_REGULAR) == -1)
+                     || (nb_dirs > 0 && add_entries(p, clone, dirs, nb_dirs, FILE_TYPE_DIRECTORY) == -1))) {
+        ret = -1;
+    }
+    if (ret == -1) {
+        for (uint32_t e = 0; e < nb_files; e++) {
+            invalidate_dentry(p, clone, files[e].name);
+            delete_tree(p, files[e].inode);
+        }
+        for (uint32_t e = 0; e < nb_dirs; e++) {
+            invalidate_dentry(p, clone, dirs[e].name);
+            delete_tree(p, dirs[e].inode);
+        }
+    }
+    free(files);
+    free(dirs);
+    return ret;
+}
+
+uint32_t clone_tree(partition_t *p, uint32_t i, uint32_t skip) {
+    uint32_t error = p->super_bloc.nb_inodes + 1;
+    inode_t inode;
+    if (i == ROOT_DIRECTORY) {
+        time_t now = time(NULL);
+        inode = (inode_t) {
+                .memory_size_data = 0,
+                .last_modification = now,
+                .last_access = now,
+                .file_type = FILE_TYPE_DIRECTORY,
+                .flags = INODE_INLINE_DATA
+        };
+    } else if (read_inode(p, &inode, i) == -1) {
+        return error;
+    }
+    if (inode.file_type != FILE_TYPE_DIRECTORY) {
+        return clone_file(p, i, &inode);
+    }
+
+    // The clone of a directory starts empty, and gets the clones of the entries once they are all made
+    uint32_t clone;
+    uint32_t goal = i == ROOT_DIRECTORY ? 0 : inode_group(p, i);
+    inode_t empty = inode;
+    empty.memory_size_data = 0;
+    empty.flags = INODE_INLINE_DATA;
+    memset(empty.inline_data, 0, INLINE_DATA_SIZE);
+    if ((clone = allocate_inode(p, goal)) == error) {
+        return error;
+    }
+    if (update_inode(p, empty, clone) == -1) {
+        delete_inode(p, clone);
+        return error;
+    }
+    if (clone_entries(p, i, clone, skip) == -1) {
+        // The entries cloned so far are deleted already, the blocks the clone may have got are given back
+        if (read_inode(p, &empty, clone) == 0) {
+            reclaim_file_data(p, &empty, 0);
+        }
+        delete_inode(p, clone);
+        logger->error("An error occurred when trying to clone a directory.");
+        return error;
+    }
+    return clone;
+}
+
+int delete_tree(partition_t *p, uint32_t i) {
+    inode_t inode;
+    if (read_inode(p, &inode, i) == -1) {
+        return -1;
+    }
+
+    int ret = 0;
+    if (inode.file_type == FILE_TYPE_DIRECTORY) {
+        uint32_t nb_entries;
+        dir_entry_t *entries;
+        if ((entries = read_entries(p, i, &nb_entries)) == NULL) {
+            return -1;
+        }
+        // The names are forgotten, the inode of the directory may be given to another one
+        for (uint32_t e = 0; e < nb_entries; e++) {
+            invalidate_dentry(p, i, entries[e].name);
+            if (delete_tree(p, entries[e].inode) == -1) {
+                ret = -1;
+            }
+        }
+        free(entries);
+    }
+
+    if (delete_inode(p, i) == -1 || reclaim_file_data(p, &inode, 0) == -1) {
+        logger->error("An error occurred when trying to delete a file.");
+        return -1;
+    }
+    return ret;
+}
+
+int move_entries(partition_t *p, uint32_t from, uint32_t to) {
+    uint32_t nb_entries;
+    dir_entry_t *entries;
+    if ((entries = read_entries(p, from, &nb_entries)) == NULL) {
+        return -1;
+    }
+
+    dir_entry_t *files = (dir_entry_t*) calloc(nb_entries + 1, sizeof(dir_entry_t));
+    dir_entry_t *dirs = (dir_entry_t*) calloc(nb_entries + 1, sizeof(dir_entry_t));
+    uint32_t nb_files = 0;
+    uint32_t nb_dirs = 0;
+    int ret = files != NULL && dirs != NULL ? 0 : -1;
+    for (uint32_t e = 0; e < nb_entries && ret == 0; e++) {
+        inode_t inode;
+        if (read_inode(p, &inode, entries[e].inode) == -1) {
+            ret = -1;
+        } else if (inode.file_type == FILE_TYPE_DIRECTORY) {
+            dirs[nb_dirs++] = entries[e];
+        } else {
+            files[nb_files++] = entries[e];
+        }
+        invalidate_dentry(p, from, entries[e].name);
+    }
+    free(entries);
+
+    if (ret == 0 && ((nb_files > 0 && add_entries(p, to, files, nb_files, FILE_TYPE_REGULAR) == -1)
+                     || (nb_dirs > 0 && add_entries(p, to, dirs, nb_dirs, FILE_TYPE_DIRECTORY) == -1))) {
+        ret = -1;
+    }
+    free(files);
+    free(dirs);
+    if (ret == -1) {
+        logger->error("An error occurred when trying to move the entries of a directory.");
+        return -1;
+    }
+
+    // Only the directory itself is deleted, its entries live in the other directory now
+    inode_t inode;
+    if (read_inode(p, &inode, from) == -1 || delete_inode(p, from) == -1 || reclaim_file_data(p, &inode, 0) == -1) {
+        logger->error("An error occurred when trying to delete a directory.");
+        return -1;
+    }
+    return 0;
+}
+
+int empty_directory(partition_t *p, uint32_t dir, uint32_t keep) {
+    uint32_t nb_entries;
+    dir_entry_t *entries;
+    if ((entries = read_entries(p, dir, &nb_entries)) == NULL) {
+        return -1;
+    }
+
+    // The entries are unlinked before their trees are deleted, an interruption leaves orphans that fs_check frees
+    dir_entry_t kept = {0};
+    uint32_t nb_kept = 0;
+    for (uint32_t e = 0; e < nb_entries; e++) {
+        if (entries[e].inode == keep) {
+            kept = entries[e];
+            nb_kept = 1;
+        }
+    }
+    if (set_entries(p, dir, &kept, nb_kept) == -1) {
+        logger->error("An error occurred when trying to empty a directory.");
+        free(entries);
+        return -1;
+    }
+
+    int ret = 0;
+    for (uint32_t e = 0; e < nb_entries; e++) {
+        if (entries[e].inode != keep) {
+            invalidate_dentry(p, dir, entries[e].name);
+            if (delete_tree(p, entries[e].inode) == -1) {
+                ret = -1;
+            }
+        }
+    }
+    free(entries);
+    return ret;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file clone.h
+ * @brief This file contains the copy-on-write clones of files and trees of directories, and the deletion of trees.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Clones a file or a tree of directories, without linking the clone in a directory. The data blocks are shared
+ * with the source and copied by the writes to either side. The lock of the opened files must be held.
+ * @param p The mounted partition.
+ * @param i The inode to clone, ROOT_DIRECTORY for the root directory (which gives a directory).
+ * @param skip An entry of the root directory to leave out of its clone, ROOT_DIRECTORY for none.
+ * @return The inode of the clone, nb_inodes + 1 if an error occurs or if a file of the source is opened.
+ */
+uint32_t clone_tree(partition_t *p, uint32_t i, uint32_t skip);
+
+/**
+ * @brief Deletes a file or a tree of directories that is not linked in a directory anymore. The references to the data
+ * blocks are handed to the reclaimer. No file of the tree may be opened.
+ * @param p The mounted partition.
+ * @param i The inode to delete.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int delete_tree(partition_t *p, uint32_t i);
+
+/**
+ * @brief Moves the entries of a directory to another one, and deletes the first directory.
+ * @param p The mounted partition.
+ * @param from The inode of the directory to empty, which is not linked in a directory.
+ * @param to The inode of the directory receiving the entries, ROOT_DIRECTORY for the root directory.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int move_entries(partition_t *p, uint32_t from, uint32_t to);
+
+/**
+ * @brief Deletes all the entries of a directory and their trees, but one. No file of the trees may be opened.
+ * @param p The mounted partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param keep The inode of the entry to keep, ROOT_DIRECTORY for none.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int empty_directory(partition_t *p, uint32_t dir, uint32_t keep);
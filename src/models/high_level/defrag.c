@@ -0,0 +1,178 @@
+/**
+ * @file defrag.c
+ * @brief This file contains the implementation of the online defragmentation.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../mid_level/data.h"
+#include "../mid_level/group.h"
+#include "../mid_level/inode.h"
+#include "../mid_level/inode_bitmap.h"
+#include "../mid_level/reclaim.h"
+
+#include "defrag.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Tells if a block of a file is its packed tail, which shares a fragment block with other files.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @param k The index of the block in the file.
+ * @return 1 if the block is the packed tail, 0 otherwise.
+ */
+static int is_packed_tail(partition_t *p, inode_t *inode, uint32_t k) {
+    return (inode->flags & INODE_TAIL_PACKED) && k == (inode->memory_size_data - 1) / p->super_bloc.block_size;
+}
+
+uint32_t count_extents(partition_t *p, inode_t *inode) {
+    if (inode->flags & INODE_INLINE_DATA) {
+        return 0;
+    }
+
+    // Holes do not break an extent, only a jump on the disk does
+    uint32_t nb_extents = 0;
+    uint32_t last = 0;
+    for (uint32_t k = 0; k < NB_DATA_BLOCKS_INODE; k++) {
+        uint32_t i = inode->data_blocks[k];
+        if (i == 0 || is_packed_tail(p, inode, k)) {
+            continue;
+        }
+        if (last == 0 || i != last + 1) {
+            nb_extents++;
+        }
+        last = i;
+    }
+    return nb_extents;
+}
+
+int defrag_file(partition_t *p, uint32_t i, uint8_t *buffer) {
+    inode_t inode;
+    if (read_inode(p, &inode, i) == -1) {
+        return -1;
+    }
+    if (inode.file_type != FILE_TYPE_REGULAR || count_extents(p, &inode) <= 1) {
+        return 0;
+    }
+
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t blocks[NB_DATA_BLOCKS_INODE];
+    uint32_t nb_blocks = 0;
+    for (uint32_t k = 0; k < NB_DATA_BLOCKS_INODE; k++) {
+        if (inode.data_blocks[k] == 0 || is_packed_tail(p, &inode, k)) {
+            continue;
+        }
+        int refs;
+        if ((refs = count_data_refs(p, inode.data_blocks[k])) == -1) {
+            return -1;
+        }
+        if (refs > 1) {
+            return 0;
+        }
+        if (read_data(p, buffer + nb_blocks * bs, inode.data_blocks[k]) == -1) {
+            return -1;
+        }
+        blocks[nb_blocks++] = k;
+    }
+
+    uint32_t first;
+    if ((first = reserve_data_extent(p, inode_group(p, i), nb_blocks)) == 0) {
+        logger->trace("No free run is long enough for the file.");
+        return 0;
+    }
+    for (uint32_t j = 0; j < nb_blocks; j++) {
+        if (update_data(p, buffer + j * bs, first + j) == -1) {
+            release_data(p, first, nb_blocks);
+            return -1;
+        }
+    }
+
+    // The inode points to the copies before the old blocks are given back
+    uint32_t old_blocks[NB_DATA_BLOCKS_INODE];
+    for (uint32_t j = 0; j < nb_blocks; j++) {
+        old_blocks[j] = inode.data_blocks[blocks[j]];
+        inode.data_blocks[blocks[j]] = first + j;
+    }
+    if (update_inode(p, inode, i) == -1) {
+        release_data(p, first, nb_blocks);
+        return -1;
+    }
+    int ret = 0;
+    for (uint32_t j = 0; j < nb_blocks; j++) {
+        if (reclaim_data(p, old_blocks[j]) == -1) {
+            ret = -1;
+        }
+    }
+
+    logger->trace("File defragmented.");
+    return ret == -1 ? -1 : (int) nb_blocks;
+}
+
+/**
+ * @brief Returns the time elapsed since a start time.
+ * @param start The start time.
+ * @return The elapsed time in microseconds.
+ */
+static uint64_t elapsed_us(struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) (now.tv_sec - start->tv_sec) * 1000000 + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+int64_t defrag_files(partition_t *p, uint32_t max_blocks_per_s) {
+    uint8_t *buffer;
+    if ((buffer = (uint8_t*) malloc((size_t) NB_DATA_BLOCKS_INODE * p->super_bloc.block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int64_t moved = 0;
+    for (uint32_t i = 0; i < p->super_bloc.nb_inodes; i++) {
+        if (get_inodebitmap(p, i) <= 0) {
+            continue;
+        }
+
+        // The lock keeps the file from being opened or deleted while it moves
+        pthread_mutex_lock(&p->open_lock);
+        bool opened = false;
+        for (uint32_t k = 0; k < p->nb_opened_files && !opened; k++) {
+            opened = p->opened_files[k]->inode == i;
+        }
+        int ret = opened ? 0 : defrag_file(p, i, buffer);
+        pthread_mutex_unlock(&p->open_lock);
+        if (ret == -1) {
+            logger->error("An error occurred when trying to defragment a file.");
+            free(buffer);
+            return -1;
+        }
+        if (ret == 0) {
+            continue;
+        }
+        moved += ret;
+
+        // The foreground I/O gets the disk back between two files
+        if (max_blocks_per_s == 0) {
+            usleep(DEFRAG_PAUSE_US);
+            continue;
+        }
+        uint64_t due = (uint64_t) moved * 1000000 / max_blocks_per_s;
+        uint64_t elapsed = elapsed_us(&start);
+        if (due > elapsed) {
+            usleep(due - elapsed);
+        }
+    }
+
+    free(buffer);
+    logger->trace("Files defragmented.");
+    return moved;
+}
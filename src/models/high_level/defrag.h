@@ -0,0 +1,48 @@
+/**
+ * @file defrag.h
+ * @brief This file contains the online defragmentation of the files of a mounted partition.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def DEFRAG_PAUSE_US The pause (in microseconds) between two files when the defragmentation is not rate limited.
+ */
+#define DEFRAG_PAUSE_US 100
+
+/**
+ * @brief Counts the extents of a file: the runs of data blocks that are contiguous on the disk, in the order of the file.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @return The number of extents, 0 if the file has no data block. The packed tail is not counted.
+ */
+uint32_t count_extents(partition_t *p, inode_t *inode);
+
+/**
+ * @brief Moves the data blocks of a file to a single run of free blocks, if it has more than one extent. The old
+ * blocks are handed to the reclaimer. The lock of the opened files must be held and the file must not be opened.
+ * @param p The partition.
+ * @param i The inode of the file.
+ * @param buffer A buffer of NB_DATA_BLOCKS_INODE blocks.
+ * @return The number of blocks moved (0 when the file is left as is), -1 if an error occurs.
+ *
+ * A file whose blocks are shared (deduplicated) is left as is, moving it would copy the shared blocks.
+ */
+int defrag_file(partition_t *p, uint32_t i, uint8_t *buffer);
+
+/**
+ * @brief Defragments the regular files that are not opened, in the order of their inodes.
+ * @param p The partition.
+ * @param max_blocks_per_s The number of blocks moved per second at most, 0 for no limit.
+ * @return The number of blocks moved, -1 if an error occurs.
+ */
+int64_t defrag_files(partition_t *p, uint32_t max_blocks_per_s);
@@ -10,86 +10,218 @@
 #include "directory.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <unistd.h>
 #include <string.h>
 
 #include "logging/logging.h"
 #include "../low_level/block.h"
+#include "../low_level/direct_io.h"
+#include "../mid_level/data.h"
 
 extern logger_t* logger;
 
-/*int get_offset(partition_t *p){
-    double nb_data = (double) p->super_bloc.nb_data;
-    double block_size = (double) p->super_bloc.block_size;
-    double nb_inodes = (double) p->super_bloc.nb_inodes;
-    return (off_t)
-    return (off_t) (ceil(nb_data/block_size)+ ceil(nb_inodes/block_size)+(p->super_bloc.nb_blocks/10)+1)*block_size;
-}*/
-
-off_t get_offset(partition_t *p) {
-    double block_size = p->super_bloc.block_size;
-    double nb_data = p->super_bloc.nb_data;
-    double nb_inodes = p->super_bloc.nb_inodes;
-    return (off_t) (1 + ceil(nb_data / block_size) + ceil(nb_inodes / block_size) + ceil((nb_inodes * sizeof(inode_t)) / block_size)) * block_size;
-}
-
 int create_directory(partition_t *p){
-    logger->trace("Directory created");
-    return 0;
-}
-
-int read_directory(partition_t *p){
-    int directory_offset = get_offset(p);
-
-    if(lseek(p->fd, directory_offset, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t dir_blocks = DIV_ROUND_UP(p->super_bloc.nb_inodes * sizeof(dir_entry_t), bs);
+    if (dir_blocks >= p->super_bloc.nb_data) {
+        logger->error("The partition is too small to hold the directory.");
         return -1;
     }
 
-    dir_entry_t* directory = p->directory;
-    for (int i = 0; i < p->super_bloc.nb_inodes-p->super_bloc.nb_inodes_free; i++) {
-        if (read(p->fd, (directory+i)->name, 60) == -1){
-            logger->error("An error occurred when trying to read the directory name");
+    // The directory uses the first data blocks, which may span several groups.
+    // Only the bitmap blocks marking them as used are written, in a single write per group.
+    uint32_t remaining = dir_blocks;
+    for (uint32_t g = 0; remaining > 0; g++) {
+        group_desc_t *gd = p->gdt + g;
+        uint32_t n = remaining < gd->nb_data ? remaining : gd->nb_data;
+        uint32_t bitmap_blocks = DIV_ROUND_UP(n, bs);
+
+        uint8_t *bitmap;
+        if (posix_memalign((void**) &bitmap, bs, (size_t) bitmap_blocks * bs) != 0) {
+            logger->error("An error occurred when trying to allocate memory.");
             return -1;
         }
-        if (read(p->fd, &(directory+i)->inode, sizeof(uint32_t)) == -1){
-            logger->error("An error occurred when trying to read the directory inode");
+        memset(bitmap, 0, (size_t) bitmap_blocks * bs);
+        memset(bitmap, 1, n);
+
+        if (write_image(p, bitmap, (size_t) bitmap_blocks * bs, (off_t) gd->data_bitmap_start * bs) == -1) {
+            logger->error("An error occurred when trying to reserve the directory data.");
+            free(bitmap);
             return -1;
         }
+        free(bitmap);
+
+        if (gd->data_bitmap_init < bitmap_blocks) {
+            gd->data_bitmap_init = bitmap_blocks;
+        }
+        gd->nb_data_free -= n;
+        p->super_bloc.nb_data_free -= n;
+        remaining -= n;
     }
 
-    p->directory = directory;
+    logger->trace("Directory created");
+    return 0;
+}
+
+int read_directory(partition_t *p){
+    directory_t *d = &p->directory;
+    d->nb_blocks = DIV_ROUND_UP(p->super_bloc.nb_inodes * sizeof(dir_entry_t), p->super_bloc.block_size);
+    d->blocks = (dir_entry_t**) calloc(d->nb_blocks, sizeof(dir_entry_t*));
+    d->dirty = (uint8_t*) calloc(d->nb_blocks, sizeof(uint8_t));
+    if (d->blocks == NULL || d->dirty == NULL) {
+        logger->error("An error occurred when trying to allocate the directory.");
+        return -1;
+    }
 
     logger->trace("Directory read");
     return 0;
 }
 
-int update_directory(partition_t *p){
-    int directory_offset = get_offset(p);
-    if(lseek(p->fd, directory_offset, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
+/**
+ * @brief Returns a block of the directory, reading it from the disk the first time it is touched.
+ * @param p The partition to use.
+ * @param k The index of the directory block.
+ * @return The block, NULL if an error occurs.
+ */
+static dir_entry_t* load_directory_block(partition_t *p, uint32_t k) {
+    directory_t *d = &p->directory;
+    if (d->blocks[k] != NULL) {
+        return d->blocks[k];
+    }
+
+    dir_entry_t *block;
+    if (posix_memalign((void**) &block, p->super_bloc.block_size, p->super_bloc.block_size) != 0) {
+        logger->error("An error occurred when trying to allocate a directory block.");
+        return NULL;
+    }
+    if (read_image(p, block, p->super_bloc.block_size, get_data_offset(p, k)) == -1) {
+        logger->error("An error occurred when trying to read a directory block.");
+        free(block);
+        return NULL;
+    }
+
+    d->blocks[k] = block;
+    return block;
+}
+
+dir_entry_t* get_entry(partition_t *p, uint32_t i) {
+    uint32_t per_block = p->super_bloc.block_size / sizeof(dir_entry_t);
+    if (i / per_block >= p->directory.nb_blocks) {
+        logger->error("You are trying to read an entry beyond the directory.");
+        return NULL;
+    }
+
+    dir_entry_t *block;
+    if ((block = load_directory_block(p, i / per_block)) == NULL) {
+        return NULL;
+    }
+    return block + i % per_block;
+}
+
+int read_directory_block(partition_t *p, uint32_t k, dir_entry_t *entries) {
+    directory_t *d = &p->directory;
+    if (k >= d->nb_blocks) {
+        logger->error("You are trying to read a block beyond the directory.");
+        return -1;
+    }
+
+    // A loaded block may be more recent than the disk
+    if (d->blocks[k] != NULL) {
+        memcpy(entries, d->blocks[k], p->super_bloc.block_size);
+        return 0;
+    }
+    if (read_image(p, entries, p->super_bloc.block_size, get_data_offset(p, k)) == -1) {
+        logger->error("An error occurred when trying to read a directory block.");
         return -1;
     }
+    return 0;
+}
+
+/**
+ * @brief Replaces an entry of the directory and marks its block as modified.
+ * @param p The partition to use.
+ * @param i The index of the entry.
+ * @param entry The new entry.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int set_entry(partition_t *p, uint32_t i, const dir_entry_t *entry) {
+    dir_entry_t *e;
+    if ((e = get_entry(p, i)) == NULL) {
+        return -1;
+    }
+    *e = *entry;
+    p->directory.dirty[i / (p->super_bloc.block_size / sizeof(dir_entry_t))] = 1;
+    return 0;
+}
+
+/**
+ * @brief Looks for a name in the directory, which is sorted by name.
+ * @param p The partition to use.
+ * @param name The name to look for.
+ * @param found Set to 1 if the name is in the directory, 0 otherwise.
+ * @return The index of the entry, or where it should be inserted. -1 if an error occurs.
+ */
+static int64_t search_entry(partition_t *p, const char *name, int *found) {
+    int64_t low = 0;
+    int64_t high = (int64_t) p->super_bloc.nb_dir_entries - 1;
+    *found = 0;
 
-    dir_entry_t* directory = p->directory;
-    for (int i = 0; i < p->super_bloc.nb_inodes; i++) {
-        if(write(p->fd, (directory+i)->name, 60) == -1){
-            logger->error("An error occurred when trying to update the name in your directory");
+    while (low <= high) {
+        int64_t mid = (low + high) / 2;
+        dir_entry_t *e;
+        if ((e = get_entry(p, (uint32_t) mid)) == NULL) {
             return -1;
         }
-        if (write(p->fd, &(directory+i)->inode, 4) == -1){
-            logger->error("An error occured when trying to update the inode in your directory");
+
+        int cmp = strncmp(name, e->name, MAX_FILENAME);
+        if (cmp == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+int find_entry(partition_t *p, const char *name) {
+    int found;
+    int64_t i = search_entry(p, name, &found);
+    return (i == -1 || !found) ? -1 : (int) i;
+}
+
+int update_directory(partition_t *p){
+    directory_t *d = &p->directory;
+    for (uint32_t k = 0; k < d->nb_blocks; k++) {
+        if (!d->dirty[k]) {
+            continue;
+        }
+        if (write_image(p, d->blocks[k], p->super_bloc.block_size, get_data_offset(p, k)) == -1) {
+            logger->error("An error occurred when trying to update a block of your directory");
             return -1;
         }
+        d->dirty[k] = 0;
     }
 
-    p->directory = directory;
     logger->trace("Directory updated");
     return 0;
 }
 
 int delete_directory(partition_t *p){
+    directory_t *d = &p->directory;
+    if (d->blocks != NULL) {
+        for (uint32_t k = 0; k < d->nb_blocks; k++) {
+            free(d->blocks[k]);
+        }
+    }
+    free(d->blocks);
+    free(d->dirty);
+    d->blocks = NULL;
+    d->dirty = NULL;
+
     logger->trace("Directory deleted");
     return 0;
 }
@@ -100,34 +232,86 @@ int insertion_entry(partition_t *p, dir_entry_t dir){
         return -1;
     }
 
-    int cmp_letter = 0;
-    int index_dir = 0;
+    uint32_t nb_entries = p->super_bloc.nb_dir_entries;
+    if (nb_entries >= p->directory.nb_blocks * (p->super_bloc.block_size / sizeof(dir_entry_t))) {
+        logger->error("The directory is full.");
+        return -1;
+    }
+
+    int found;
+    int64_t index_dir;
+    if ((index_dir = search_entry(p, dir.name, &found)) == -1) {
+        return -1;
+    }
+    if (found) {
+        logger->error("You're trying to create directory entry with a name already use.");
+        return -1;
+    }
 
-    while (index_dir < p->super_bloc.nb_inodes - p->super_bloc.nb_inodes_free && (int) dir.name[cmp_letter] <= (int) (p->directory+index_dir)->name[cmp_letter] && cmp_letter < 60){
-        if ((int) dir.name[cmp_letter] == (int) (p->directory->name+index_dir)[cmp_letter]){
-            cmp_letter++;
-        }else{
-            index_dir++;
+    // Shifts the following entries to keep the directory sorted
+    for (uint32_t j = nb_entries; j > index_dir; j--) {
+        dir_entry_t *previous;
+        if ((previous = get_entry(p, j - 1)) == NULL || set_entry(p, j, previous) == -1) {
+            return -1;
         }
     }
+    if (set_entry(p, (uint32_t) index_dir, &dir) == -1) {
+        return -1;
+    }
+    p->super_bloc.nb_dir_entries++;
 
-    if( cmp_letter >= 60){
-        logger->error("You're trying to create directory entry with a name already use.");
+    logger->trace("New directory entry added");
+    return 0;
+}
+
+int insertion_entries(partition_t *p, const dir_entry_t *entries, uint32_t nb_entries) {
+    uint32_t nb_existing = p->super_bloc.nb_dir_entries;
+    if ((uint64_t) nb_existing + nb_entries > p->directory.nb_blocks * (p->super_bloc.block_size / sizeof(dir_entry_t))) {
+        logger->error("The directory is full.");
         return -1;
     }
 
-    dir_entry_t tmp;
+    // Merges from the end, so that each existing entry is moved at most once
+    int64_t i = (int64_t) nb_existing - 1;
+    int64_t j = (int64_t) nb_entries - 1;
+    for (int64_t dst = (int64_t) nb_existing + nb_entries - 1; j >= 0; dst--) {
+        dir_entry_t *existing = NULL;
+        if (i >= 0 && (existing = get_entry(p, (uint32_t) i)) == NULL) {
+            return -1;
+        }
 
-    for (int j = index_dir; j < p->super_bloc.nb_inodes - p->super_bloc.nb_inodes_free +1; j++) {
-        strcpy(tmp.name, (p->directory+j)->name);
-        tmp.inode = (p->directory+j)->inode;
-        strcpy((p->directory+j)->name, dir.name);
-        (p->directory+j)->inode = dir.inode;
-        strcpy(dir.name, tmp.name);
-        dir.inode = tmp.inode;
+        if (existing != NULL && strncmp(existing->name, entries[j].name, MAX_FILENAME) > 0) {
+            if (set_entry(p, (uint32_t) dst, existing) == -1) {
+                return -1;
+            }
+            i--;
+        } else {
+            if (entries[j].inode > p->super_bloc.nb_inodes || set_entry(p, (uint32_t) dst, entries + j) == -1) {
+                return -1;
+            }
+            j--;
+        }
     }
+    p->super_bloc.nb_dir_entries += nb_entries;
 
-    logger->trace("New directory entry added");
+    logger->trace("New directory entries added");
+    return 0;
+}
+
+int replace_entries(partition_t *p, const dir_entry_t *entries, uint32_t nb_entries) {
+    if (nb_entries > p->directory.nb_blocks * (p->super_bloc.block_size / sizeof(dir_entry_t))) {
+        logger->error("The directory is full.");
+        return -1;
+    }
+
+    for (uint32_t k = 0; k < nb_entries; k++) {
+        if (entries[k].inode > p->super_bloc.nb_inodes || set_entry(p, k, entries + k) == -1) {
+            return -1;
+        }
+    }
+    p->super_bloc.nb_dir_entries = nb_entries;
+
+    logger->trace("Directory entries replaced");
     return 0;
 }
 
@@ -137,24 +321,25 @@ int delete_entry(partition_t *p, dir_entry_t dir){
         return -1;
     }
 
-    int i = 0;
-
-    while(dir.inode != p->directory[i].inode && i <= p->super_bloc.nb_inodes-p->super_bloc.nb_inodes_free){
-        i++;
+    int found;
+    int64_t i;
+    if ((i = search_entry(p, dir.name, &found)) == -1) {
+        return -1;
     }
-
-    if(i >= p->super_bloc.nb_inodes-p->super_bloc.nb_inodes_free){
+    dir_entry_t *e;
+    if (!found || (e = get_entry(p, (uint32_t) i)) == NULL || e->inode != dir.inode) {
         logger->error("You're trying to delete a not alloued inode");
         return -1;
     }
 
-    dir_entry_t tmp;
-
-    for (int j = 0; j < p->super_bloc.nb_inodes-p->super_bloc.nb_inodes_free-1; j++) {
-        p->directory[j].inode = p->directory[j+1].inode;
-        strcpy(p->directory[j].name, p->directory[j+1].name);
+    for (uint32_t j = (uint32_t) i; j + 1 < p->super_bloc.nb_dir_entries; j++) {
+        dir_entry_t *next;
+        if ((next = get_entry(p, j + 1)) == NULL || set_entry(p, j, next) == -1) {
+            return -1;
+        }
     }
+    p->super_bloc.nb_dir_entries--;
 
     logger->trace("Entry deleted");
     return 0;
-}
\ No newline at end of file
+}
@@ -11,28 +11,53 @@
 #pragma once
 
 /**
- * @brief Creates a directory.
+ * @brief Creates a directory by reserving its data blocks in the data bitmap.
  * @param p The partition to use.
  * @return 0 if everything went well, -1 otherwise.
  */
 int create_directory(partition_t *p);
 
 /**
- * @brief Reads a directory.
+ * @brief Prepares the directory in memory, its blocks are read from the disk when first touched.
  * @param p The partition to use.
  * @return 0 if everything went well, -1 otherwise.
  */
 int read_directory(partition_t *p);
 
 /**
- * @brief Update a directory.
+ * @brief Returns an entry of the directory, reading its block if needed.
+ * @param p The partition to use.
+ * @param i The index of the entry.
+ * @return The entry, NULL if an error occurs.
+ */
+dir_entry_t* get_entry(partition_t *p, uint32_t i);
+
+/**
+ * @brief Copies a block of the directory, without loading it in memory if it has not been touched yet.
+ * @param p The partition to use.
+ * @param k The index of the directory block.
+ * @param entries Where to copy the entries of the block (a whole block).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int read_directory_block(partition_t *p, uint32_t k, dir_entry_t *entries);
+
+/**
+ * @brief Looks for a file in the directory with a binary search.
+ * @param p The partition to use.
+ * @param name The name of the file.
+ * @return The index of the entry, -1 if there is no file with this name.
+ */
+int find_entry(partition_t *p, const char *name);
+
+/**
+ * @brief Writes the modified blocks of the directory on the disk.
  * @param p The partition to use.
  * @return 0 if everything went well, -1 otherwise
  */
 int update_directory(partition_t *p);
 
 /**
- * @brief Delete the directory.
+ * @brief Frees the blocks of the directory loaded in memory.
  * @param p The partition to use.
  * @return 0 if everything went well, -1 otherwise.
  */
@@ -46,6 +71,24 @@ int delete_directory(partition_t *p);
  */
 int insertion_entry(partition_t *p, dir_entry_t dir);
 
+/**
+ * @brief Inserts several entries in the directory, merging them with the existing ones in a single pass.
+ * @param p The partition to use.
+ * @param entries The entries to insert, sorted by name, whose names are not in the directory yet.
+ * @param nb_entries The number of entries.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int insertion_entries(partition_t *p, const dir_entry_t *entries, uint32_t nb_entries);
+
+/**
+ * @brief Replaces all the entries of the directory.
+ * @param p The partition to use.
+ * @param entries The new entries, sorted by name.
+ * @param nb_entries The number of entries.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int replace_entries(partition_t *p, const dir_entry_t *entries, uint32_t nb_entries);
+
 /**
  * @brief Delete a specific directory entry in the directory
  * @param p The partition to use.
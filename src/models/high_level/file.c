@@ -10,76 +10,541 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "logging/logging.h"
 
 #include "../high_level/directory.h"
+#include "../high_level/namespace.h"
+#include "../low_level/hash.h"
+#include "../low_level/lz.h"
 #include "../mid_level/data.h"
+#include "../mid_level/dedup.h"
+#include "../mid_level/fragment.h"
+#include "../mid_level/group.h"
 #include "../mid_level/inode.h"
 #include "../mid_level/data_bitmap.h"
 #include "../mid_level/inode_bitmap.h"
+#include "../mid_level/reclaim.h"
 
 #include "file.h"
 
 extern logger_t *logger;
 
-uint32_t create_file(char *name, partition_t *p) {
-    if (p->super_bloc.nb_inodes_free <= 0 || p->super_bloc.nb_data_free <= 0) {
-        logger->warn("No more inode or data block free.");
-        return -1;
-    }
-
+/**
+ * @brief Allocates and writes the inode of a new empty file.
+ * @param p The partition.
+ * @param file_type The FILE_TYPE_* of the file.
+ * @return The inode, nb_inodes + 1 if an error occurs.
+ */
+static uint32_t new_file_inode(partition_t *p, uint32_t file_type) {
+    // New files are spread over the groups so that concurrent writers allocate in different groups
+    uint32_t goal = __atomic_fetch_add(&p->next_inode_group, 1, __ATOMIC_RELAXED) % p->super_bloc.nb_groups;
     uint32_t i;
-    if ((i = next_free_inode(p)) == (p->super_bloc.nb_inodes + 1)) {
+    if ((i = allocate_inode(p, goal)) == (p->super_bloc.nb_inodes + 1)) {
         logger->error("An error occurred when trying to find a free inode.");
-        return -1;
+        return i;
     }
 
+    // The content is kept in the inode until it outgrows it, the data blocks are then allocated by the writes
     time_t now = time(NULL);
     inode_t inode = {
             .memory_size_data = 0,
             .last_modification = now,
-            .last_access = now
+            .last_access = now,
+            .file_type = file_type,
+            .flags = INODE_INLINE_DATA
     };
+    // The entries of a directory are read block by block, they are never compressed
+    if ((p->super_bloc.flags & FS_FEATURE_COMPRESS) && file_type == FILE_TYPE_REGULAR) {
+        inode.flags |= INODE_COMPRESSED;
+    }
+
+    if (update_inode(p, inode, i) == -1) {
+        logger->error("An error occurred when trying to update an inode.");
+        delete_inode(p, i);
+        return p->super_bloc.nb_inodes + 1;
+    }
+    return i;
+}
+
+/**
+ * @brief Releases the inodes of files which could not be created.
+ * @param p The partition.
+ * @param inodes The inodes of the files.
+ * @param nb_inodes The number of inodes.
+ */
+static void release_file_inodes(partition_t *p, const uint32_t *inodes, uint32_t nb_inodes) {
+    for (uint32_t k = 0; k < nb_inodes; k++) {
+        if (delete_inode(p, inodes[k]) == -1) {
+            logger->error("An error occurred when trying to release the inode of a file which could not be created.");
+        }
+    }
+}
 
-    if (create_inode(p, i) == -1) {
-        logger->error("An error occurred when trying to create an inode.");
+uint32_t create_file(char *name, partition_t *p, uint32_t dir, uint32_t file_type) {
+    uint32_t i;
+    if (create_files(p, dir, &name, 1, &i, file_type) == -1) {
         return -1;
     }
+    return i;
+}
 
-    if ((inode.data_blocks[0] = next_free_data(p)) == 0) {
-        logger->error("An error occurred when trying to find a free data block.");
+int create_files(partition_t *p, uint32_t dir, char **names, uint32_t nb_files, uint32_t *inodes, uint32_t file_type) {
+    if (nb_files == 0) {
+        return 0;
+    }
+    if (p->super_bloc.nb_inodes_free < nb_files) {
+        logger->warn("Not enough free inodes for the files.");
         return -1;
     }
 
-    if (create_data(p, inode.data_blocks[0]) == -1) {
-        logger->error("An error occurred when trying to create a new data block.");
+    dir_entry_t *entries;
+    if ((entries = (dir_entry_t*) calloc(nb_files, sizeof(dir_entry_t))) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
         return -1;
     }
+    for (uint32_t k = 0; k < nb_files; k++) {
+        if ((inodes[k] = new_file_inode(p, file_type)) == (p->super_bloc.nb_inodes + 1)) {
+            release_file_inodes(p, inodes, k);
+            free(entries);
+            return -1;
+        }
+        strcpy(entries[k].name, names[k]);
+        entries[k].inode = inodes[k];
+    }
 
-    if (update_inode(p, inode, i) == -1) {
-        logger->error("An error occurred when trying to update an inode.");
+    // The directory is written once for all the files, the superblock is written by the flush of the operation
+    int ret = 0;
+    if (add_entries(p, dir, entries, nb_files, file_type) == -1) {
+        logger->error("An error occurred when trying to create the directory entries of the files.");
+        release_file_inodes(p, inodes, nb_files);
+        ret = -1;
+    }
+    free(entries);
+
+    if (ret == 0) {
+        logger->info(nb_files == 1 ? "File created." : "Files created.");
+    }
+    return ret;
+}
+
+uint32_t allocate_file_data(partition_t *p, file_t *f, uint32_t k) {
+    if (f->nb_reserved == 0) {
+        // The window never goes beyond the blocks the file can still address
+        uint32_t wanted = NB_DATA_BLOCKS_INODE - k < DATA_RESERVATION_WINDOW ? NB_DATA_BLOCKS_INODE - k : DATA_RESERVATION_WINDOW;
+        if ((f->reserved_start = reserve_data(p, inode_group(p, f->inode), wanted, &f->nb_reserved)) == 0) {
+            return 0;
+        }
+    }
+
+    f->nb_reserved--;
+    return f->reserved_start++;
+}
+
+int release_file_data(partition_t *p, file_t *f) {
+    if (release_data(p, f->reserved_start, f->nb_reserved) == -1) {
+        logger->error("An error occurred when trying to release the reserved data.");
+        return -1;
+    }
+    f->nb_reserved = 0;
+    return 0;
+}
+
+int uninline_file(partition_t *p, file_t *f, inode_t *inode) {
+    uint8_t content[INLINE_DATA_SIZE];
+    memcpy(content, inode->inline_data, INLINE_DATA_SIZE);
+    memset(inode->inline_data, 0, INLINE_DATA_SIZE);
+    inode->flags &= ~INODE_INLINE_DATA;
+    if (inode->memory_size_data == 0) {
+        return 0;
+    }
+
+    uint8_t *block;
+    if ((block = (uint8_t*) calloc(1, p->super_bloc.block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    memcpy(block, content, inode->memory_size_data);
+    if ((inode->data_blocks[0] = allocate_file_data(p, f, 0)) == 0 || update_data(p, block, inode->data_blocks[0]) == -1) {
+        logger->error("An error occurred when trying to move the inline data to a data block.");
+        free(block);
         return -1;
     }
+    free(block);
+    return 0;
+}
 
-    p->super_bloc.nb_inodes_free--;
-    if (update_bloc(p, &p->super_bloc, sizeof(super_bloc_t), 0, 0) == -1) {
-        logger->error("An error occurred when trying to update the superblock.");
+int pack_tail(partition_t *p, file_t *f) {
+    inode_t inode;
+    if (read_inode(p, &inode, f->inode) == -1) {
         return -1;
     }
 
-    dir_entry_t dir_entry;
-    strcpy(dir_entry.name, name);
-    dir_entry.inode = i;
-    if (insertion_entry(p, dir_entry) == -1) {
-        logger->error("An error occurred when trying to create a directory entry for the file.");
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t tail = inode.memory_size_data % bs;
+    uint32_t k = inode.memory_size_data / bs;
+    if ((inode.flags & (INODE_INLINE_DATA | INODE_TAIL_PACKED | INODE_COMPRESSED)) || tail == 0 || tail > MAX_PACKED_TAIL(bs)
+        || k >= NB_DATA_BLOCKS_INODE || inode.data_blocks[k] == 0) {
+        return 0;
+    }
+
+    uint8_t *block;
+    if ((block = (uint8_t*) malloc(bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
         return -1;
     }
-    if (update_directory(p) == -1) {
-        logger->error("An error occurred when trying to update the directory.");
+    if (read_data(p, block, inode.data_blocks[k]) == -1) {
+        free(block);
         return -1;
     }
 
-    logger->info("File created.");
-    return i;
-}
\ No newline at end of file
+    uint32_t offset;
+    uint32_t frag_block = store_fragment(p, inode_group(p, f->inode), block, tail, &offset);
+    free(block);
+    if (frag_block == 0) {
+        // Without room for a fragment, the tail simply stays in its own block
+        return 0;
+    }
+
+    uint32_t old_block = inode.data_blocks[k];
+    inode.data_blocks[k] = frag_block;
+    inode.tail_offset = offset;
+    inode.flags |= INODE_TAIL_PACKED;
+    if (update_inode(p, inode, f->inode) == -1) {
+        return -1;
+    }
+
+    logger->trace("Tail packed.");
+    return unref_data(p, old_block);
+}
+
+int unpack_tail(partition_t *p, file_t *f, inode_t *inode) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t k = (inode->memory_size_data - 1) / bs;
+
+    uint8_t *block;
+    if ((block = (uint8_t*) malloc(bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    uint32_t new_block;
+    if (read_tail(p, inode, block) == -1 || (new_block = allocate_file_data(p, f, k)) == 0
+        || update_data(p, block, new_block) == -1) {
+        logger->error("An error occurred when trying to move the tail to a data block.");
+        free(block);
+        return -1;
+    }
+    free(block);
+
+    uint32_t frag_block = inode->data_blocks[k];
+    inode->data_blocks[k] = new_block;
+    inode->tail_offset = 0;
+    inode->flags &= ~INODE_TAIL_PACKED;
+    return unref_data(p, frag_block);
+}
+
+int read_tail(partition_t *p, inode_t *inode, uint8_t *block) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t k = (inode->memory_size_data - 1) / bs;
+    uint32_t tail = inode->memory_size_data - k * bs;
+
+    // The whole fragment block is read, so that its checksum can be verified
+    if (read_data(p, block, inode->data_blocks[k]) == -1) {
+        logger->error("An error occurred when trying to read the tail of the file.");
+        return -1;
+    }
+    memmove(block, block + inode->tail_offset, tail);
+    memset(block + tail, 0, bs - tail);
+    return 0;
+}
+
+int is_zero_block(partition_t *p, const uint8_t *block) {
+    return block[0] == 0 && memcmp(block, block + 1, p->super_bloc.block_size - 1) == 0;
+}
+
+int write_file_block(partition_t *p, file_t *f, inode_t *inode, uint32_t k, const uint8_t *block) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t i = inode->data_blocks[k];
+
+    // A block of zeros becomes a hole, which reads as zeros
+    if (is_zero_block(p, block)) {
+        inode->data_blocks[k] = 0;
+        return i != 0 ? unref_data(p, i) : 0;
+    }
+
+    // With deduplication, a block whose content is already stored only costs a reference
+    uint64_t hash = 0;
+    if (p->super_bloc.flags & FS_FEATURE_DEDUP) {
+        hash = hash_block(block, bs);
+        uint32_t shared;
+        if ((shared = find_dedup(p, block, hash)) != 0) {
+            inode->data_blocks[k] = shared;
+            return i != 0 ? unref_data(p, i) : 0;
+        }
+    }
+
+    // A block shared with other files is copied instead of being written in place
+    uint32_t previous = 0;
+    int owned = i != 0 ? own_data(p, i) : 1;
+    if (owned == -1) {
+        return -1;
+    }
+    if (owned == 0) {
+        previous = i;
+        i = 0;
+    }
+    if (i == 0 && (i = allocate_file_data(p, f, k)) == 0) {
+        logger->error("An error occurred when trying to find a new free data block.");
+        return -1;
+    }
+
+    if (update_data(p, block, i) == -1) {
+        return -1;
+    }
+    inode->data_blocks[k] = i;
+    if (previous != 0 && unref_data(p, previous) == -1) {
+        return -1;
+    }
+
+    if ((p->super_bloc.flags & FS_FEATURE_DEDUP) && insert_dedup(p, hash, i) == -1) {
+        logger->warn("The block could not be added to the deduplication index.");
+    }
+    return 0;
+}
+
+int read_cluster(partition_t *p, inode_t *inode, uint32_t c, uint8_t *cluster) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t first = c * COMPRESS_CLUSTER_BLOCKS;
+    memset(cluster, 0, (size_t) COMPRESS_CLUSTER_BLOCKS * bs);
+
+    if (inode->cluster_size[c] == 0) {
+        for (uint32_t j = 0; j < COMPRESS_CLUSTER_BLOCKS; j++) {
+            if (inode->data_blocks[first + j] != 0 && read_data(p, cluster + j * bs, inode->data_blocks[first + j]) == -1) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    uint32_t nb_blocks = DIV_ROUND_UP(inode->cluster_size[c], bs);
+    uint8_t *compressed;
+    if ((compressed = (uint8_t*) malloc((size_t) nb_blocks * bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    for (uint32_t j = 0; j < nb_blocks; j++) {
+        if (inode->data_blocks[first + j] == 0) {
+            memset(compressed + j * bs, 0, bs);
+        } else if (read_data(p, compressed + j * bs, inode->data_blocks[first + j]) == -1) {
+            free(compressed);
+            return -1;
+        }
+    }
+    int ret = lz_decompress(compressed, inode->cluster_size[c], cluster, (size_t) COMPRESS_CLUSTER_BLOCKS * bs);
+    free(compressed);
+    if (ret == -1) {
+        logger->error("A compressed cluster of the file is corrupted.");
+        return -1;
+    }
+    return 0;
+}
+
+size_t compress_cluster(partition_t *p, const inode_t *inode, const uint8_t *cluster, uint32_t length, uint8_t *compressed) {
+    uint32_t bs = p->super_bloc.block_size;
+    bool zeros = true;
+    for (uint32_t j = 0; j < COMPRESS_CLUSTER_BLOCKS && zeros; j++) {
+        zeros = is_zero_block(p, cluster + j * bs);
+    }
+    // The compressed payload has to save at least one of the blocks the cluster uses, otherwise it is stored as is
+    size_t capacity = (size_t) (DIV_ROUND_UP(length, bs) - 1) * bs;
+    if (!(inode->flags & INODE_COMPRESSED) || zeros || capacity == 0) {
+        return 0;
+    }
+    memset(compressed, 0, (size_t) (COMPRESS_CLUSTER_BLOCKS - 1) * bs);
+    return lz_compress(cluster, length, compressed, capacity);
+}
+
+/**
+ * @brief Stores a cluster of a file, compressed if compress_cluster saves a block.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param inode The inode of the file.
+ * @param c The index of the cluster.
+ * @param cluster The content of the cluster (COMPRESS_CLUSTER_BLOCKS blocks).
+ * @param length The number of bytes of the cluster inside the file.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_cluster(partition_t *p, file_t *f, inode_t *inode, uint32_t c, uint8_t *cluster, uint32_t length) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t first = c * COMPRESS_CLUSTER_BLOCKS;
+
+    uint8_t *compressed;
+    if ((compressed = (uint8_t*) malloc((size_t) (COMPRESS_CLUSTER_BLOCKS - 1) * bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    size_t size = compress_cluster(p, inode, cluster, length, compressed);
+
+    uint8_t *source = size != 0 ? compressed : cluster;
+    uint32_t nb_blocks = size != 0 ? DIV_ROUND_UP(size, bs) : DIV_ROUND_UP(length, bs);
+    int ret = 0;
+    for (uint32_t j = 0; j < nb_blocks && ret == 0; j++) {
+        ret = write_file_block(p, f, inode, first + j, source + j * bs);
+    }
+    free(compressed);
+    if (ret == -1) {
+        return -1;
+    }
+
+    // The blocks the cluster does not need anymore are given back
+    for (uint32_t j = nb_blocks; j < COMPRESS_CLUSTER_BLOCKS; j++) {
+        if (inode->data_blocks[first + j] != 0) {
+            if (unref_data(p, inode->data_blocks[first + j]) == -1) {
+                return -1;
+            }
+            inode->data_blocks[first + j] = 0;
+        }
+    }
+    inode->cluster_size[c] = (uint32_t) size;
+    return 0;
+}
+
+int write_clusters(partition_t *p, file_t *f, inode_t *inode, const uint8_t *buffer, uint32_t nb_bytes) {
+    uint32_t cluster_bytes = COMPRESS_CLUSTER_BLOCKS * p->super_bloc.block_size;
+    uint8_t *cluster;
+    if ((cluster = (uint8_t*) malloc(cluster_bytes)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    uint32_t written = 0;
+    while (written < nb_bytes) {
+        uint32_t pos = f->offset + written;
+        uint32_t c = pos / cluster_bytes;
+        uint32_t in_cluster = pos % cluster_bytes;
+        uint32_t n = (cluster_bytes - in_cluster < nb_bytes - written) ? cluster_bytes - in_cluster : nb_bytes - written;
+
+        if (n < cluster_bytes && read_cluster(p, inode, c, cluster) == -1) {
+            break;
+        }
+        memcpy(cluster + in_cluster, buffer + written, n);
+
+        uint32_t end = (pos + n > inode->memory_size_data) ? pos + n : inode->memory_size_data;
+        uint32_t length = (end - c * cluster_bytes < cluster_bytes) ? end - c * cluster_bytes : cluster_bytes;
+        if (write_cluster(p, f, inode, c, cluster, length) == -1) {
+            logger->error("An error occurred when trying to write a cluster of the file.");
+            break;
+        }
+        inode->memory_size_data = end;
+        written += n;
+    }
+
+    free(cluster);
+    return (int) written;
+}
+
+int has_clusters(inode_t *inode) {
+    if (inode->flags & INODE_COMPRESSED) {
+        return 1;
+    }
+    for (uint32_t c = 0; c < NB_DATA_BLOCKS_INODE / COMPRESS_CLUSTER_BLOCKS; c++) {
+        if (inode->cluster_size[c] != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int reclaim_file_data(partition_t *p, inode_t *inode, uint32_t first) {
+    if (inode->flags & INODE_INLINE_DATA) {
+        return 0;
+    }
+
+    int ret = 0;
+    for (uint32_t k = first; k < NB_DATA_BLOCKS_INODE; k++) {
+        if (inode->data_blocks[k] != 0) {
+            if (reclaim_data(p, inode->data_blocks[k]) == -1) {
+                ret = -1;
+            }
+            inode->data_blocks[k] = 0;
+        }
+    }
+    for (uint32_t c = DIV_ROUND_UP(first, COMPRESS_CLUSTER_BLOCKS); c < NB_DATA_BLOCKS_INODE / COMPRESS_CLUSTER_BLOCKS; c++) {
+        inode->cluster_size[c] = 0;
+    }
+    return ret;
+}
+
+int truncate_file(partition_t *p, file_t *f, inode_t *inode, uint32_t size) {
+    uint32_t old_size = inode->memory_size_data;
+    if (inode->flags & INODE_INLINE_DATA) {
+        if (size <= INLINE_DATA_SIZE) {
+            if (size < old_size) {
+                memset(inode->inline_data + size, 0, old_size - size);
+            }
+            inode->memory_size_data = size;
+            return 0;
+        }
+        if (uninline_file(p, f, inode) == -1) {
+            logger->error("An error occurred when trying to move the content of the file out of its inode.");
+            return -1;
+        }
+    }
+
+    // The position of the packed tail depends on the size, so it gets a block of its own again
+    if ((inode->flags & INODE_TAIL_PACKED) && size != old_size && unpack_tail(p, f, inode) == -1) {
+        logger->error("An error occurred when trying to unpack the tail of the file.");
+        return -1;
+    }
+    // Growing only moves the end of the file, the new bytes are a hole
+    if (size >= old_size) {
+        inode->memory_size_data = size;
+        return 0;
+    }
+
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t cluster_bytes = COMPRESS_CLUSTER_BLOCKS * bs;
+    uint32_t c = size / cluster_bytes;
+    uint32_t first = DIV_ROUND_UP(size, bs);
+    if (size % cluster_bytes != 0 && inode->cluster_size[c] != 0) {
+        // A compressed cluster cut in the middle is compressed again, without the bytes past the end
+        uint8_t *cluster;
+        if ((cluster = (uint8_t*) malloc(cluster_bytes)) == NULL) {
+            logger->error("An error occurred when trying to allocate memory.");
+            return -1;
+        }
+        int ret = read_cluster(p, inode, c, cluster);
+        if (ret == 0) {
+            memset(cluster + size % cluster_bytes, 0, cluster_bytes - size % cluster_bytes);
+            ret = write_cluster(p, f, inode, c, cluster, size % cluster_bytes);
+        }
+        free(cluster);
+        if (ret == -1) {
+            logger->error("An error occurred when trying to cut a compressed cluster of the file.");
+            return -1;
+        }
+        // Its compressed payload may use blocks past the end of the file
+        first = (c + 1) * COMPRESS_CLUSTER_BLOCKS;
+    } else if (size % bs != 0 && inode->data_blocks[size / bs] != 0) {
+        // The last block keeps zeros past the end, so that growing the file again reads zeros
+        uint8_t *block;
+        if ((block = (uint8_t*) malloc(bs)) == NULL) {
+            logger->error("An error occurred when trying to allocate memory.");
+            return -1;
+        }
+        int ret = read_data(p, block, inode->data_blocks[size / bs]);
+        if (ret == 0) {
+            memset(block + size % bs, 0, bs - size % bs);
+            ret = write_file_block(p, f, inode, size / bs, block);
+        }
+        free(block);
+        if (ret == -1) {
+            logger->error("An error occurred when trying to cut the last block of the file.");
+            return -1;
+        }
+    }
+
+    inode->memory_size_data = size;
+    return reclaim_file_data(p, inode, first);
+}
@@ -12,9 +12,158 @@
 #include "../../ufs.priv.h"
 
 /**
- * @brief Creates an empty file in the partition.
- * @param name The name of the file (should be unique).
+ * @brief Creates an empty file in a directory.
+ * @param name The name of the file (should be unique in the directory).
  * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param file_type The FILE_TYPE_* of the file.
  * @return The inode if everything went well, -1 otherwise.
  */
-uint32_t create_file(char *name, partition_t *p);
\ No newline at end of file
+uint32_t create_file(char *name, partition_t *p, uint32_t dir, uint32_t file_type);
+
+/**
+ * @brief Creates several empty files in a directory, writing the superblock and the directory once.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param names The names of the files, sorted and unique, not in the directory yet.
+ * @param nb_files The number of files.
+ * @param inodes Where to store the inodes of the files.
+ * @param file_type The FILE_TYPE_* of the files.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int create_files(partition_t *p, uint32_t dir, char **names, uint32_t nb_files, uint32_t *inodes, uint32_t file_type);
+
+/**
+ * @brief Allocates a data block for a file from its reservation window, reserving a new window when it is empty.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param k The index of the block in the file.
+ * @return The index of the allocated data, 0 if there is no more free data.
+ */
+uint32_t allocate_file_data(partition_t *p, file_t *f, uint32_t k);
+
+/**
+ * @brief Gives back the data blocks still reserved by a file.
+ * @param p The partition.
+ * @param f The opened file.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int release_file_data(partition_t *p, file_t *f);
+
+/**
+ * @brief Moves the inline content of a file to its first data block, the inode has to be written back by the caller.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param inode The inode of the file.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int uninline_file(partition_t *p, file_t *f, inode_t *inode);
+
+/**
+ * @brief Moves the last partial block of a file to a shared fragment block, if it is small enough.
+ * @param p The partition.
+ * @param f The opened file.
+ * @return 0 if everything went well (even if the tail has not been packed), -1 otherwise.
+ */
+int pack_tail(partition_t *p, file_t *f);
+
+/**
+ * @brief Moves the packed tail of a file back to a data block of its own, the inode has to be written back by the caller.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param inode The inode of the file.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int unpack_tail(partition_t *p, file_t *f, inode_t *inode);
+
+/**
+ * @brief Reads the packed tail of a file, padded with zeros up to the size of a block.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @param block Where to store the tail (block_size bytes).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int read_tail(partition_t *p, inode_t *inode, uint8_t *block);
+
+/**
+ * @brief Tells if a block only holds zeros, in which case it is not stored (the file has a hole).
+ * @param p The partition.
+ * @param block The content of the block (block_size bytes).
+ * @return 1 if the block only holds zeros, 0 otherwise.
+ */
+int is_zero_block(partition_t *p, const uint8_t *block);
+
+/**
+ * @brief Stores the content of a block of a file: leaves a hole for a block of zeros, shares an identical block
+ * (deduplication), copies a shared block, or allocates a block if needed. The inode has to be written back by the
+ * caller.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param inode The inode of the file.
+ * @param k The index of the block in the file.
+ * @param block The new content of the block (block_size bytes).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int write_file_block(partition_t *p, file_t *f, inode_t *inode, uint32_t k, const uint8_t *block);
+
+/**
+ * @brief Reads a whole cluster of a file, decompressing it if needed.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @param c The index of the cluster.
+ * @param cluster Where to store the cluster (COMPRESS_CLUSTER_BLOCKS blocks).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int read_cluster(partition_t *p, inode_t *inode, uint32_t c, uint8_t *cluster);
+
+/**
+ * @brief Compresses a cluster of a file if the file has the INODE_COMPRESSED flag and if it saves one of the blocks the
+ * cluster uses. A cluster of zeros is not compressed, so that all its blocks become holes.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @param cluster The content of the cluster (COMPRESS_CLUSTER_BLOCKS blocks).
+ * @param length The number of bytes of the cluster inside the file.
+ * @param compressed Where to store the compressed payload, padded with zeros (COMPRESS_CLUSTER_BLOCKS - 1 blocks).
+ * @return The size of the compressed payload, 0 if the cluster is stored as is.
+ */
+size_t compress_cluster(partition_t *p, const inode_t *inode, const uint8_t *cluster, uint32_t length, uint8_t *compressed);
+
+/**
+ * @brief Writes in a file cluster by cluster, compressing each cluster. The inode (whose size is updated) has to be
+ * written back by the caller.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param inode The inode of the file.
+ * @param buffer The bytes to write at the position of the file.
+ * @param nb_bytes The number of bytes to write.
+ * @return The number of bytes written, -1 if an error occurs.
+ */
+int write_clusters(partition_t *p, file_t *f, inode_t *inode, const uint8_t *buffer, uint32_t nb_bytes);
+
+/**
+ * @brief Checks if a file is written cluster by cluster (it is compressed, or has compressed clusters).
+ * @param inode The inode of the file.
+ * @return 1 if the file is written by clusters, 0 otherwise.
+ */
+int has_clusters(inode_t *inode);
+
+/**
+ * @brief Hands the data blocks of a file, from a given block to its end, to the reclaimer. The inode has to be written
+ * back by the caller.
+ * @param p The partition.
+ * @param inode The inode of the file.
+ * @param first The index of the first block to give back.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int reclaim_file_data(partition_t *p, inode_t *inode, uint32_t first);
+
+/**
+ * @brief Changes the size of a file: the blocks past the new end are handed to the reclaimer, a larger file gets a hole.
+ * The inode has to be written back by the caller.
+ * @param p The partition.
+ * @param f The opened file.
+ * @param inode The inode of the file.
+ * @param size The new size of the file.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int truncate_file(partition_t *p, file_t *f, inode_t *inode, uint32_t size);
@@ -0,0 +1,794 @@
+/**
+ * @file fsck.c
+ * @brief This file contains the implementation of the consistency check of a mounted partition.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/direct_io.h"
+#include "../mid_level/bitmap.h"
+#include "../mid_level/checksum.h"
+#include "../mid_level/data.h"
+#include "../mid_level/discard.h"
+#include "directory.h"
+#include "fsck.h"
+#include "namespace.h"
+
+extern logger_t *logger;
+
+/**
+ * @struct fsck_entry_t
+ * @brief A directory entry to remove.
+ * @var dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @var name The name of the entry.
+ */
+typedef struct {
+    uint32_t dir;
+    char name[MAX_FILENAME];
+} fsck_entry_t;
+
+/**
+ * @struct fsck_t
+ * @brief The state of a check, shared by its threads.
+ * @var p The partition.
+ * @var repair Whether the conflicts are repaired.
+ * @var nb_threads The number of threads.
+ * @var dir_blocks The number of data blocks of the root directory, the first ones.
+ * @var refs The number of references to each data block.
+ * @var used The inodes that are used and can be trusted, one bit each.
+ * @var dirs The used inodes that are directories, one bit each.
+ * @var reached The inodes named by an entry, one bit each.
+ * @var verified The data blocks whose checksum has been verified, one bit each.
+ * @var nb_dirs The number of used directories.
+ * @var level The directories of the level of the tree being walked.
+ * @var nb_level The number of directories of the level.
+ * @var next_level The directories of the next level.
+ * @var nb_next_level The number of directories of the next level.
+ * @var next The next unit of work to take.
+ * @var lock The lock of the entries to remove.
+ * @var removals The entries to remove.
+ * @var nb_removals The number of entries to remove.
+ * @var removals_capacity The number of entries the array can hold.
+ * @var nb_data_free The number of free data blocks counted.
+ * @var nb_inodes_free The number of free inodes counted.
+ * @var report The report.
+ * @var error Whether a thread failed.
+ */
+typedef struct {
+    partition_t *p;
+    bool repair;
+    uint32_t nb_threads;
+    uint32_t dir_blocks;
+    uint16_t *refs;
+    uint64_t *used;
+    uint64_t *dirs;
+    uint64_t *reached;
+    uint64_t *verified;
+    uint32_t nb_dirs;
+    uint32_t *level;
+    uint32_t nb_level;
+    uint32_t *next_level;
+    uint32_t nb_next_level;
+    uint32_t next;
+    pthread_mutex_t lock;
+    fsck_entry_t *removals;
+    uint32_t nb_removals;
+    uint32_t removals_capacity;
+    uint32_t nb_data_free;
+    uint32_t nb_inodes_free;
+    fsck_report_t *report;
+    int error;
+} fsck_t;
+
+/**
+ * @brief Tells whether a bit is set.
+ * @param bits The bits.
+ * @param i The index of the bit.
+ * @return Whether it is set.
+ */
+static bool test_bit(uint64_t *bits, uint32_t i) {
+    return (__atomic_load_n(bits + i / 64, __ATOMIC_RELAXED) >> (i % 64)) & 1;
+}
+
+/**
+ * @brief Sets a bit, atomically.
+ * @param bits The bits.
+ * @param i The index of the bit.
+ * @return Whether it was already set.
+ */
+static bool set_bit(uint64_t *bits, uint32_t i) {
+    uint64_t mask = (uint64_t) 1 << (i % 64);
+    return (__atomic_fetch_or(bits + i / 64, mask, __ATOMIC_RELAXED) & mask) != 0;
+}
+
+/**
+ * @brief Adds the counters of a thread to the report.
+ * @param report The report.
+ * @param local The counters of the thread.
+ */
+static void merge_report(fsck_report_t *report, fsck_report_t *local) {
+    uint32_t *dst = (uint32_t*) report;
+    uint32_t *src = (uint32_t*) local;
+    for (size_t k = 0; k < sizeof(fsck_report_t) / sizeof(uint32_t); k++) {
+        if (src[k] != 0) {
+            __atomic_add_fetch(dst + k, src[k], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Runs a task in the threads of a check, the calling thread included, and waits for them.
+ * @param f The check, whose next unit of work is reset.
+ * @param task The task, taking units of work until there is none left.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int run_task(fsck_t *f, void *(*task)(void*)) {
+    f->next = 0;
+
+    // Without threads, the calling thread does all the work
+    pthread_t *threads = (pthread_t*) calloc(f->nb_threads, sizeof(pthread_t));
+    uint32_t started = 0;
+    while (threads != NULL && started + 1 < f->nb_threads && pthread_create(threads + started, NULL, task, f) == 0) {
+        started++;
+    }
+    task(f);
+    for (uint32_t k = 0; k < started; k++) {
+        pthread_join(threads[k], NULL);
+    }
+    free(threads);
+    return f->error ? -1 : 0;
+}
+
+/**
+ * @brief Takes the next unit of work of a task.
+ * @param f The check.
+ * @param nb_units The number of units of the task.
+ * @param unit Where to store the unit.
+ * @return Whether there was one left.
+ */
+static bool take_unit(fsck_t *f, uint32_t nb_units, uint32_t *unit) {
+    if (__atomic_load_n(&f->error, __ATOMIC_RELAXED)) {
+        return false;
+    }
+    *unit = __atomic_fetch_add(&f->next, 1, __ATOMIC_RELAXED);
+    return *unit < nb_units;
+}
+
+/**
+ * @brief Tells whether an inode can reference a data block.
+ * @param f The check.
+ * @param b The index of the data block.
+ * @return Whether it is a data block outside of the root directory.
+ */
+static bool valid_block(fsck_t *f, uint32_t b) {
+    return b >= f->dir_blocks && b < f->p->super_bloc.nb_data;
+}
+
+/**
+ * @brief Tells whether a used inode can be trusted.
+ * @param p The partition.
+ * @param inode The inode.
+ * @return Whether its checksum, its type and its size are valid.
+ */
+static bool valid_inode(partition_t *p, inode_t *inode) {
+    if ((p->super_bloc.flags & FS_FEATURE_CHECKSUM) && inode->checksum != inode_checksum(*inode)) {
+        return false;
+    }
+    if (inode->file_type != FILE_TYPE_REGULAR && inode->file_type != FILE_TYPE_DIRECTORY) {
+        return false;
+    }
+    return !(inode->flags & INODE_INLINE_DATA) || inode->memory_size_data <= INLINE_DATA_SIZE;
+}
+
+/**
+ * @brief Verifies a data block against its checksum, the first time it is referenced.
+ * @param f The check.
+ * @param b The index of the data block.
+ * @param block A buffer of one block.
+ * @param local The counters of the thread.
+ * @return 0 if everything went well (even if the block is corrupted), -1 otherwise.
+ */
+static int verify_block(fsck_t *f, uint32_t b, uint8_t *block, fsck_report_t *local) {
+    partition_t *p = f->p;
+    if (!(p->super_bloc.flags & FS_FEATURE_CHECKSUM) || set_bit(f->verified, b)) {
+        return 0;
+    }
+    if (read_image(p, block, p->super_bloc.block_size, get_data_offset(p, b)) == -1) {
+        logger->error("An error occurred when trying to read a data block.");
+        return -1;
+    }
+    if (verify_checksum(p, b, block) == -1) {
+        local->checksum_errors++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Counts the references of the used inodes of a chunk of an inode table, and verifies the blocks they
+ * reference against their checksums.
+ * @param f The check.
+ * @param g The index of the group.
+ * @param first The index of the first inode of the chunk in the group.
+ * @param buffer A buffer of FSCK_INODE_BATCH blocks.
+ * @param used A buffer of one entry per inode of the chunk.
+ * @param block A buffer of one block.
+ * @param local The counters of the thread.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int scan_inode_chunk(fsck_t *f, uint32_t g, uint32_t first, uint8_t *buffer, uint8_t *used, uint8_t *block,
+                            fsck_report_t *local) {
+    partition_t *p = f->p;
+    group_t *group = p->groups + g;
+    if (first >= group->desc->nb_inodes) {
+        return 0;
+    }
+    uint32_t batch = FSCK_INODE_BATCH * (p->super_bloc.block_size / sizeof(inode_t));
+    uint32_t n = group->desc->nb_inodes - first < batch ? group->desc->nb_inodes - first : batch;
+
+    uint32_t nb_used = 0;
+    pthread_mutex_lock(&group->lock);
+    for (uint32_t j = 0; j < n; j++) {
+        int entry = get_bitmap(p, &group->inode_bitmap, first + j);
+        if (entry == -1) {
+            pthread_mutex_unlock(&group->lock);
+            return -1;
+        }
+        used[j] = entry > 0;
+        nb_used += used[j];
+    }
+    pthread_mutex_unlock(&group->lock);
+
+    // The empty parts of the table are not read
+    if (nb_used == 0) {
+        return 0;
+    }
+    off_t offset = (off_t) group->desc->inode_table_start * p->super_bloc.block_size + (off_t) first * sizeof(inode_t);
+    if (read_image(p, buffer, (size_t) n * sizeof(inode_t), offset) == -1) {
+        logger->error("An error occurred when trying to read the inode table.");
+        return -1;
+    }
+
+    for (uint32_t j = 0; j < n; j++) {
+        if (!used[j]) {
+            continue;
+        }
+        uint32_t i = g * p->super_bloc.inodes_per_group + first + j;
+        inode_t *inode = (inode_t*) (buffer + j * sizeof(inode_t));
+        local->nb_inodes++;
+
+        // A bad inode is left out of the used ones, so that a repair frees it
+        if (!valid_inode(p, inode)) {
+            local->bad_inodes++;
+            continue;
+        }
+        set_bit(f->used, i);
+        if (inode->file_type == FILE_TYPE_DIRECTORY) {
+            set_bit(f->dirs, i);
+            __atomic_add_fetch(&f->nb_dirs, 1, __ATOMIC_RELAXED);
+        }
+        if (inode->flags & INODE_INLINE_DATA) {
+            continue;
+        }
+
+        uint32_t nb_cleared = 0;
+        for (uint32_t k = 0; k < NB_DATA_BLOCKS_INODE; k++) {
+            uint32_t b = inode->data_blocks[k];
+            if (b == 0) {
+                continue;
+            }
+            if (!valid_block(f, b)) {
+                local->bad_blocks++;
+                if (f->repair) {
+                    inode->data_blocks[k] = 0;
+                    nb_cleared++;
+                }
+                continue;
+            }
+            __atomic_add_fetch(f->refs + b, 1, __ATOMIC_RELAXED);
+            if (verify_block(f, b, block, local) == -1) {
+                return -1;
+            }
+        }
+
+        if (nb_cleared > 0) {
+            if (p->super_bloc.flags & FS_FEATURE_CHECKSUM) {
+                inode->checksum = inode_checksum(*inode);
+            }
+            if (write_image(p, inode, sizeof(inode_t), offset + (off_t) j * sizeof(inode_t)) == -1) {
+                logger->error("An error occurred when trying to repair an inode.");
+                return -1;
+            }
+            local->nb_repaired += nb_cleared;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief The task counting the references of the inode tables, by chunks.
+ * @param arg The check.
+ * @return NULL.
+ */
+static void* scan_inodes_task(void *arg) {
+    fsck_t *f = (fsck_t*) arg;
+    partition_t *p = f->p;
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t batch = FSCK_INODE_BATCH * (bs / sizeof(inode_t));
+    uint32_t per_group = DIV_ROUND_UP(p->super_bloc.inodes_per_group, batch);
+
+    uint8_t *buffer = (uint8_t*) malloc((size_t) FSCK_INODE_BATCH * bs);
+    uint8_t *used = (uint8_t*) malloc(batch);
+    uint8_t *block = NULL;
+    if (buffer == NULL || used == NULL || posix_memalign((void**) &block, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+    }
+
+    fsck_report_t local = {0};
+    uint32_t u;
+    while (buffer != NULL && used != NULL && block != NULL && take_unit(f, per_group * p->super_bloc.nb_groups, &u)) {
+        if (scan_inode_chunk(f, u / per_group, u % per_group * batch, buffer, used, block, &local) == -1) {
+            __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+        }
+    }
+    merge_report(f->report, &local);
+    free(buffer);
+    free(used);
+    free(block);
+    return NULL;
+}
+
+/**
+ * @brief Queues a directory entry to remove.
+ * @param f The check.
+ * @param dir The inode of the directory.
+ * @param name The name of the entry.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int add_removal(fsck_t *f, uint32_t dir, const char *name) {
+    pthread_mutex_lock(&f->lock);
+    if (f->nb_removals == f->removals_capacity) {
+        uint32_t capacity = f->removals_capacity == 0 ? 16 : f->removals_capacity * 2;
+        fsck_entry_t *removals;
+        if ((removals = (fsck_entry_t*) realloc(f->removals, capacity * sizeof(fsck_entry_t))) == NULL) {
+            pthread_mutex_unlock(&f->lock);
+            logger->error("An error occurred when trying to allocate memory.");
+            return -1;
+        }
+        f->removals = removals;
+        f->removals_capacity = capacity;
+    }
+    fsck_entry_t *removal = f->removals + f->nb_removals++;
+    removal->dir = dir;
+    strncpy(removal->name, name, MAX_FILENAME - 1);
+    removal->name[MAX_FILENAME - 1] = '\0';
+    pthread_mutex_unlock(&f->lock);
+    return 0;
+}
+
+/**
+ * @brief Marks the inodes named by entries of a directory as reached, and queues the directories among them.
+ * @param f The check.
+ * @param dir The inode of the directory.
+ * @param entries The entries.
+ * @param nb_entries The number of entries.
+ * @param local The counters of the thread.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int check_entries(fsck_t *f, uint32_t dir, dir_entry_t *entries, uint32_t nb_entries, fsck_report_t *local) {
+    for (uint32_t e = 0; e < nb_entries; e++) {
+        uint32_t i = entries[e].inode;
+        local->nb_entries++;
+        if (i >= f->p->super_bloc.nb_inodes || !test_bit(f->used, i)) {
+            local->dangling_entries++;
+            if (add_removal(f, dir, entries[e].name) == -1) {
+                return -1;
+            }
+            continue;
+        }
+        // The bit makes each inode reached once, so a directory linked twice is not walked twice
+        if (set_bit(f->reached, i)) {
+            local->duplicate_entries++;
+            if (add_removal(f, dir, entries[e].name) == -1) {
+                return -1;
+            }
+            continue;
+        }
+        if (test_bit(f->dirs, i)) {
+            f->next_level[__atomic_fetch_add(&f->nb_next_level, 1, __ATOMIC_RELAXED)] = i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief The task checking the blocks of the root directory, one at a time.
+ * @param arg The check.
+ * @return NULL.
+ */
+static void* walk_root_task(void *arg) {
+    fsck_t *f = (fsck_t*) arg;
+    partition_t *p = f->p;
+    uint32_t per_block = p->super_bloc.block_size / sizeof(dir_entry_t);
+    uint32_t nb_entries = p->super_bloc.nb_dir_entries;
+    if (nb_entries > p->directory.nb_blocks * per_block) {
+        nb_entries = p->directory.nb_blocks * per_block;
+    }
+
+    dir_entry_t *entries;
+    if ((entries = (dir_entry_t*) malloc(p->super_bloc.block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    fsck_report_t local = {0};
+    uint32_t k;
+    while (take_unit(f, DIV_ROUND_UP(nb_entries, per_block), &k)) {
+        uint32_t n = nb_entries - k * per_block < per_block ? nb_entries - k * per_block : per_block;
+        if (read_directory_block(p, k, entries) == -1 || check_entries(f, ROOT_DIRECTORY, entries, n, &local) == -1) {
+            __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+        }
+    }
+    merge_report(f->report, &local);
+    free(entries);
+    return NULL;
+}
+
+/**
+ * @brief Checks the entries of a directory stored in an inode.
+ * @param f The check.
+ * @param dir The inode of the directory.
+ * @param entries A buffer of one block.
+ * @param local The counters of the thread.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int walk_directory(fsck_t *f, uint32_t dir, dir_entry_t *entries, fsck_report_t *local) {
+    partition_t *p = f->p;
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t per_block = bs / sizeof(dir_entry_t);
+
+    inode_t inode;
+    off_t offset = (off_t) p->gdt[dir / p->super_bloc.inodes_per_group].inode_table_start * bs
+                   + (off_t) (dir % p->super_bloc.inodes_per_group) * sizeof(inode_t);
+    if (read_image(p, &inode, sizeof(inode_t), offset) == -1) {
+        logger->error("An error occurred when trying to read a directory.");
+        return -1;
+    }
+    uint32_t nb_entries = inode.memory_size_data / sizeof(dir_entry_t);
+    if (inode.flags & INODE_INLINE_DATA) {
+        memcpy(entries, inode.inline_data, nb_entries * sizeof(dir_entry_t));
+        return check_entries(f, dir, entries, nb_entries, local);
+    }
+    if (nb_entries > NB_DATA_BLOCKS_INODE * per_block) {
+        nb_entries = NB_DATA_BLOCKS_INODE * per_block;
+    }
+
+    // The blocks are read as they are on the disk, whatever their entry in the data bitmap
+    for (uint32_t k = 0; k * per_block < nb_entries; k++) {
+        uint32_t b = inode.data_blocks[k];
+        if (b == 0 || !valid_block(f, b)) {
+            continue;
+        }
+        if (read_image(p, entries, bs, get_data_offset(p, b)) == -1) {
+            logger->error("An error occurred when trying to read a directory.");
+            return -1;
+        }
+        uint32_t n = nb_entries - k * per_block < per_block ? nb_entries - k * per_block : per_block;
+        if (check_entries(f, dir, entries, n, local) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief The task checking the directories of a level of the tree, one at a time.
+ * @param arg The check.
+ * @return NULL.
+ */
+static void* walk_level_task(void *arg) {
+    fsck_t *f = (fsck_t*) arg;
+
+    dir_entry_t *entries;
+    if ((entries = (dir_entry_t*) malloc(f->p->super_bloc.block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    fsck_report_t local = {0};
+    uint32_t u;
+    while (take_unit(f, f->nb_level, &u)) {
+        local.nb_directories++;
+        if (walk_directory(f, f->level[u], entries, &local) == -1) {
+            __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+        }
+    }
+    merge_report(f->report, &local);
+    free(entries);
+    return NULL;
+}
+
+/**
+ * @brief Walks the tree of directories level by level, from the root directory.
+ * @param f The check.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int walk_tree(fsck_t *f) {
+    f->level = (uint32_t*) malloc(((size_t) f->nb_dirs + 1) * sizeof(uint32_t));
+    f->next_level = (uint32_t*) malloc(((size_t) f->nb_dirs + 1) * sizeof(uint32_t));
+    if (f->level == NULL || f->next_level == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    // The root directory may hold most of the entries, so its blocks are shared between the threads
+    f->report->nb_directories++;
+    f->nb_next_level = 0;
+    if (run_task(f, walk_root_task) == -1) {
+        return -1;
+    }
+    while (f->nb_next_level > 0) {
+        uint32_t *level = f->level;
+        f->level = f->next_level;
+        f->nb_level = f->nb_next_level;
+        f->next_level = level;
+        f->nb_next_level = 0;
+        if (run_task(f, walk_level_task) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Leaves the used inodes that were not reached out of the used ones, and drops their references.
+ * @param f The check.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int drop_orphans(fsck_t *f) {
+    partition_t *p = f->p;
+    uint32_t bs = p->super_bloc.block_size;
+    for (uint32_t w = 0; w < DIV_ROUND_UP(p->super_bloc.nb_inodes, 64); w++) {
+        uint64_t orphans = f->used[w] & ~f->reached[w];
+        f->used[w] &= ~orphans;
+        for (; orphans != 0; orphans &= orphans - 1) {
+            uint32_t i = w * 64 + __builtin_ctzll(orphans);
+            f->report->orphan_inodes++;
+
+            inode_t inode;
+            off_t offset = (off_t) p->gdt[i / p->super_bloc.inodes_per_group].inode_table_start * bs
+                           + (off_t) (i % p->super_bloc.inodes_per_group) * sizeof(inode_t);
+            if (read_image(p, &inode, sizeof(inode_t), offset) == -1) {
+                logger->error("An error occurred when trying to read an inode.");
+                return -1;
+            }
+            if (inode.flags & INODE_INLINE_DATA) {
+                continue;
+            }
+            for (uint32_t k = 0; k < NB_DATA_BLOCKS_INODE; k++) {
+                if (inode.data_blocks[k] != 0 && valid_block(f, inode.data_blocks[k])) {
+                    f->refs[inode.data_blocks[k]]--;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Compares the bitmaps and the free counters of a group with the references counted, under the lock of the
+ * group.
+ * @param f The check.
+ * @param g The index of the group.
+ * @param local The counters of the thread.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int check_group(fsck_t *f, uint32_t g, fsck_report_t *local) {
+    partition_t *p = f->p;
+    group_t *group = p->groups + g;
+    uint32_t first_data = g * p->super_bloc.data_per_group;
+    uint32_t first_inode = g * p->super_bloc.inodes_per_group;
+    uint32_t nb_repaired = local->nb_repaired;
+
+    pthread_mutex_lock(&group->lock);
+    uint32_t nb_data_free = 0;
+    for (uint32_t j = 0; j < group->desc->nb_data; j++) {
+        int entry = get_bitmap(p, &group->data_bitmap, j);
+        if (entry == -1) {
+            pthread_mutex_unlock(&group->lock);
+            return -1;
+        }
+        uint32_t refs = f->refs[first_data + j];
+        uint32_t expected = refs > DATA_REFCOUNT_MASK ? DATA_REFCOUNT_MASK : refs;
+        if ((uint32_t) (entry & DATA_REFCOUNT_MASK) != expected) {
+            local->data_errors++;
+            if (f->repair) {
+                int value = expected == 0 ? 0 : (int) expected | (entry & DATA_INDEXED);
+                if (set_bitmap(p, &group->data_bitmap, j, value) == -1) {
+                    pthread_mutex_unlock(&group->lock);
+                    return -1;
+                }
+                if (value == 0) {
+                    queue_discard(p, first_data + j);
+                }
+                entry = value;
+                local->nb_repaired++;
+            }
+        }
+        nb_data_free += entry == 0;
+    }
+
+    // The bad and orphan inodes are the only used inodes left out, they are counted in their own conflicts
+    uint32_t nb_inodes_free = 0;
+    for (uint32_t j = 0; j < group->desc->nb_inodes; j++) {
+        int entry = get_bitmap(p, &group->inode_bitmap, j);
+        if (entry == -1) {
+            pthread_mutex_unlock(&group->lock);
+            return -1;
+        }
+        if (entry > 0 && !test_bit(f->used, first_inode + j) && f->repair) {
+            if (set_bitmap(p, &group->inode_bitmap, j, 0) == -1) {
+                pthread_mutex_unlock(&group->lock);
+                return -1;
+            }
+            entry = 0;
+            local->nb_repaired++;
+        }
+        nb_inodes_free += entry == 0;
+    }
+
+    if (group->desc->nb_data_free != nb_data_free) {
+        local->counter_errors++;
+        if (f->repair) {
+            group->desc->nb_data_free = nb_data_free;
+            local->nb_repaired++;
+        }
+    }
+    if (group->desc->nb_inodes_free != nb_inodes_free) {
+        local->counter_errors++;
+        if (f->repair) {
+            group->desc->nb_inodes_free = nb_inodes_free;
+            local->nb_repaired++;
+        }
+    }
+    if (local->nb_repaired != nb_repaired) {
+        group->dirty = true;
+    }
+    pthread_mutex_unlock(&group->lock);
+
+    __atomic_add_fetch(&f->nb_data_free, nb_data_free, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&f->nb_inodes_free, nb_inodes_free, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief The task comparing the groups with the references counted, one at a time.
+ * @param arg The check.
+ * @return NULL.
+ */
+static void* check_groups_task(void *arg) {
+    fsck_t *f = (fsck_t*) arg;
+    fsck_report_t local = {0};
+    uint32_t g;
+    while (take_unit(f, f->p->super_bloc.nb_groups, &g)) {
+        if (check_group(f, g, &local) == -1) {
+            __atomic_store_n(&f->error, 1, __ATOMIC_RELAXED);
+        }
+    }
+    merge_report(f->report, &local);
+    return NULL;
+}
+
+/**
+ * @brief Compares the free counters of the superblock with the ones of the groups.
+ * @param f The check.
+ */
+static void check_super_bloc(fsck_t *f) {
+    partition_t *p = f->p;
+    if (__atomic_load_n(&p->super_bloc.nb_data_free, __ATOMIC_RELAXED) != f->nb_data_free) {
+        f->report->counter_errors++;
+        if (f->repair) {
+            __atomic_store_n(&p->super_bloc.nb_data_free, f->nb_data_free, __ATOMIC_RELAXED);
+            f->report->nb_repaired++;
+        }
+    }
+    if (__atomic_load_n(&p->super_bloc.nb_inodes_free, __ATOMIC_RELAXED) != f->nb_inodes_free) {
+        f->report->counter_errors++;
+        if (f->repair) {
+            __atomic_store_n(&p->super_bloc.nb_inodes_free, f->nb_inodes_free, __ATOMIC_RELAXED);
+            f->report->nb_repaired++;
+        }
+    }
+}
+
+/**
+ * @brief Removes the dangling and duplicate entries found, once the bitmaps are repaired.
+ * @param f The check.
+ */
+static void remove_entries(fsck_t *f) {
+    for (uint32_t k = 0; k < f->nb_removals; k++) {
+        if (remove_entry(f->p, f->removals[k].dir, f->removals[k].name) == -1) {
+            logger->error("An error occurred when trying to remove a directory entry.");
+            continue;
+        }
+        f->report->nb_repaired++;
+    }
+}
+
+/**
+ * @brief Releases the memory of a check.
+ * @param f The check.
+ */
+static void free_check(fsck_t *f) {
+    free(f->refs);
+    free(f->used);
+    free(f->dirs);
+    free(f->reached);
+    free(f->verified);
+    free(f->level);
+    free(f->next_level);
+    free(f->removals);
+}
+
+int check_partition(partition_t *p, bool repair, uint32_t nb_threads, fsck_report_t *report) {
+    memset(report, 0, sizeof(fsck_report_t));
+    uint32_t nb_words = DIV_ROUND_UP(p->super_bloc.nb_inodes, 64);
+    fsck_t f = {
+            .p = p,
+            .repair = repair,
+            .nb_threads = nb_threads,
+            .dir_blocks = DIV_ROUND_UP(p->super_bloc.nb_inodes * sizeof(dir_entry_t), p->super_bloc.block_size),
+            .refs = (uint16_t*) calloc(p->super_bloc.nb_data, sizeof(uint16_t)),
+            .used = (uint64_t*) calloc(nb_words, sizeof(uint64_t)),
+            .dirs = (uint64_t*) calloc(nb_words, sizeof(uint64_t)),
+            .reached = (uint64_t*) calloc(nb_words, sizeof(uint64_t)),
+            .verified = (uint64_t*) calloc(DIV_ROUND_UP(p->super_bloc.nb_data, 64), sizeof(uint64_t)),
+            .report = report
+    };
+    if (f.refs == NULL || f.used == NULL || f.dirs == NULL || f.reached == NULL || f.verified == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free_check(&f);
+        return -1;
+    }
+    if (pthread_mutex_init(&f.lock, NULL) != 0) {
+        logger->error("An error occurred when trying to create a lock.");
+        free_check(&f);
+        return -1;
+    }
+
+    // The root directory and the current fragment block hold a reference no inode accounts for
+    for (uint32_t b = 0; b < f.dir_blocks; b++) {
+        f.refs[b] = 1;
+    }
+    if (p->super_bloc.frag_block != 0 && valid_block(&f, p->super_bloc.frag_block)) {
+        f.refs[p->super_bloc.frag_block]++;
+    }
+
+    int ret = 0;
+    if (run_task(&f, scan_inodes_task) == -1 || walk_tree(&f) == -1 || drop_orphans(&f) == -1
+        || run_task(&f, check_groups_task) == -1) {
+        logger->error("An error occurred when trying to check the partition.");
+        ret = -1;
+    } else {
+        check_super_bloc(&f);
+        if (repair) {
+            remove_entries(&f);
+        }
+        ret = (int) (report->bad_inodes + report->bad_blocks + report->dangling_entries + report->duplicate_entries
+                     + report->orphan_inodes + report->data_errors + report->checksum_errors + report->counter_errors);
+        logger->trace("Partition checked.");
+    }
+
+    pthread_mutex_destroy(&f.lock);
+    free_check(&f);
+    return ret;
+}
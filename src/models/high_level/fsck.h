@@ -0,0 +1,32 @@
+/**
+ * @file fsck.h
+ * @brief This file contains the consistency check of a mounted partition.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def FSCK_INODE_BATCH The number of inode table blocks in a chunk taken by a thread of the check.
+ */
+#define FSCK_INODE_BATCH 64
+
+/**
+ * @brief Checks the bitmaps, the references of the inodes, the tree of directories and the free counters of a
+ * partition, and repairs them.
+ * @param p The mounted partition, without opened files.
+ * @param repair Whether to repair the conflicts found.
+ * @param nb_threads The number of threads, the calling thread included (at least 1).
+ * @param report Where to store the conflicts found.
+ * @return The number of conflicts found, -1 if an error occurs.
+ */
+int check_partition(partition_t *p, bool repair, uint32_t nb_threads, fsck_report_t *report);
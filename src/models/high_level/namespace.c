@@ -0,0 +1,404 @@
+/**
+ * @file namespace.c
+ * @brief This file contains the implementation of the operations available on the tree of directories.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "logging/logging.h"
+
+#include "../mid_level/cache.h"
+#include "../mid_level/data.h"
+#include "../mid_level/dentry.h"
+#include "../mid_level/inode.h"
+#include "directory.h"
+#include "file.h"
+#include "namespace.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Returns an entry of a directory stored in an inode, through the block cache.
+ * @param p The partition.
+ * @param inode The inode of the directory.
+ * @param j The index of the entry.
+ * @param entry Where to copy the entry.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int get_subdir_entry(partition_t *p, inode_t *inode, uint32_t j, dir_entry_t *entry) {
+    if (inode->flags & INODE_INLINE_DATA) {
+        memcpy(entry, inode->inline_data + j * sizeof(dir_entry_t), sizeof(dir_entry_t));
+        return 0;
+    }
+
+    uint32_t per_block = p->super_bloc.block_size / sizeof(dir_entry_t);
+    cache_entry_t *block;
+    if ((block = get_cached_block(p, inode->data_blocks[j / per_block])) == NULL) {
+        return -1;
+    }
+    memcpy(entry, (dir_entry_t*) block->data + j % per_block, sizeof(dir_entry_t));
+    put_cached_block(p, block);
+    return 0;
+}
+
+/**
+ * @brief Looks for a name in a directory stored in an inode with a binary search.
+ * @param p The partition.
+ * @param dir The inode of the directory.
+ * @param name The name.
+ * @param i Where to store the inode of the entry.
+ * @return 1 if the directory has an entry with this name, 0 if it has not, -1 if an error occurs.
+ */
+static int search_subdir(partition_t *p, uint32_t dir, const char *name, uint32_t *i) {
+    inode_t inode;
+    if (read_inode(p, &inode, dir) == -1) {
+        return -1;
+    }
+
+    int64_t low = 0;
+    int64_t high = (int64_t) (inode.memory_size_data / sizeof(dir_entry_t)) - 1;
+    while (low <= high) {
+        int64_t mid = (low + high) / 2;
+        dir_entry_t e;
+        if (get_subdir_entry(p, &inode, (uint32_t) mid, &e) == -1) {
+            return -1;
+        }
+
+        int cmp = strncmp(name, e.name, MAX_FILENAME);
+        if (cmp == 0) {
+            *i = e.inode;
+            return 1;
+        }
+        if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return 0;
+}
+
+int lookup_name(partition_t *p, uint32_t dir, const char *name, uint32_t *inode, uint32_t *file_type) {
+    dentry_t *e;
+    if ((e = lookup_dentry(p, dir, name)) != NULL) {
+        *inode = e->inode;
+        *file_type = e->file_type;
+        return e->negative ? 0 : 1;
+    }
+
+    int found;
+    if (dir == ROOT_DIRECTORY) {
+        int k = find_entry(p, name);
+        found = k != -1;
+        if (found) {
+            *inode = get_entry(p, k)->inode;
+        }
+    } else if ((found = search_subdir(p, dir, name, inode)) == -1) {
+        return -1;
+    }
+
+    inode_t i;
+    if (found && read_inode(p, &i, *inode) == -1) {
+        return -1;
+    }
+    *file_type = found ? i.file_type : FILE_TYPE_REGULAR;
+    add_dentry(p, dir, name, !found, found ? *inode : 0, *file_type);
+    return found;
+}
+
+int resolve_parent(partition_t *p, const char *path, uint32_t avoid, uint32_t *dir, char *name) {
+    if (strlen(path) >= MAX_PATHNAME) {
+        logger->error("The path is too long.");
+        return -1;
+    }
+
+    // Each name but the last one must be a directory, found through the dentry cache
+    uint32_t current = ROOT_DIRECTORY;
+    const char *c = path;
+    name[0] = '\0';
+    while (true) {
+        while (*c == '/') {
+            c++;
+        }
+        if (*c == '\0') {
+            break;
+        }
+
+        const char *end = strchr(c, '/');
+        size_t length = end != NULL ? (size_t) (end - c) : strlen(c);
+        if (length >= MAX_FILENAME) {
+            logger->error("A name of the path is too long.");
+            return -1;
+        }
+        memcpy(name, c, length);
+        name[length] = '\0';
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            logger->error("The names . and .. are not supported in a path.");
+            return -1;
+        }
+
+        c += length;
+        while (*c == '/') {
+            c++;
+        }
+        if (*c == '\0') {
+            break;
+        }
+
+        uint32_t inode;
+        uint32_t file_type;
+        int found;
+        if ((found = lookup_name(p, current, name, &inode, &file_type)) == -1) {
+            return -1;
+        }
+        if (!found || file_type != FILE_TYPE_DIRECTORY) {
+            logger->error("There is no directory with this path.");
+            return -1;
+        }
+        if (inode == avoid) {
+            logger->error("A directory cannot be moved inside itself.");
+            return -1;
+        }
+        current = inode;
+    }
+
+    *dir = current;
+    return 0;
+}
+
+int resolve_path(partition_t *p, const char *path, uint32_t *inode, uint32_t *file_type) {
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    if (resolve_parent(p, path, ROOT_DIRECTORY, &dir, name) == -1) {
+        return -1;
+    }
+    if (name[0] == '\0') {
+        *inode = ROOT_DIRECTORY;
+        *file_type = FILE_TYPE_DIRECTORY;
+        return 1;
+    }
+    return lookup_name(p, dir, name, inode, file_type);
+}
+
+int read_dir_block(partition_t *p, uint32_t dir, uint32_t k, dir_entry_t *entries, uint32_t *nb_entries) {
+    if (dir == ROOT_DIRECTORY) {
+        *nb_entries = p->super_bloc.nb_dir_entries;
+        return read_directory_block(p, k, entries);
+    }
+
+    inode_t inode;
+    if (read_inode(p, &inode, dir) == -1) {
+        return -1;
+    }
+    *nb_entries = inode.memory_size_data / sizeof(dir_entry_t);
+
+    memset(entries, 0, p->super_bloc.block_size);
+    if (inode.flags & INODE_INLINE_DATA) {
+        memcpy(entries, inode.inline_data, inode.memory_size_data);
+        return 0;
+    }
+    if (k >= NB_DATA_BLOCKS_INODE || inode.data_blocks[k] == 0) {
+        return 0;
+    }
+    return read_data(p, (uint8_t*) entries, inode.data_blocks[k]);
+}
+
+/**
+ * @brief Reads all the entries of a directory stored in an inode.
+ * @param p The partition.
+ * @param dir The inode of the directory.
+ * @param inode Where to store the inode of the directory.
+ * @param extra The number of entries to leave room for after the entries.
+ * @param nb_entries Where to store the number of entries.
+ * @return The entries, NULL if an error occurs.
+ */
+static dir_entry_t* load_subdir(partition_t *p, uint32_t dir, inode_t *inode, uint32_t extra, uint32_t *nb_entries) {
+    if (read_inode(p, inode, dir) == -1) {
+        return NULL;
+    }
+    if (inode->file_type != FILE_TYPE_DIRECTORY) {
+        logger->error("This inode is not a directory.");
+        return NULL;
+    }
+
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t size = inode->memory_size_data;
+    *nb_entries = size / sizeof(dir_entry_t);
+    dir_entry_t *entries;
+    if ((entries = (dir_entry_t*) calloc(1, (size_t) DIV_ROUND_UP(size + extra * sizeof(dir_entry_t), bs) * bs + bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return NULL;
+    }
+
+    if (inode->flags & INODE_INLINE_DATA) {
+        memcpy(entries, inode->inline_data, size);
+        return entries;
+    }
+    for (uint32_t k = 0; k * bs < size; k++) {
+        if (inode->data_blocks[k] != 0 && read_data(p, (uint8_t*) entries + (size_t) k * bs, inode->data_blocks[k]) == -1) {
+            free(entries);
+            return NULL;
+        }
+    }
+    return entries;
+}
+
+/**
+ * @brief Writes the entries of a directory stored in an inode.
+ * @param p The partition.
+ * @param dir The inode of the directory.
+ * @param inode The inode of the directory, updated.
+ * @param entries The entries, padded with zeros to a whole number of blocks.
+ * @param nb_entries The number of entries.
+ * @param first The index of the first entry that changed, the blocks before it are not rewritten.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int store_subdir(partition_t *p, uint32_t dir, inode_t *inode, dir_entry_t *entries, uint32_t nb_entries, uint32_t first) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t size = nb_entries * sizeof(dir_entry_t);
+    if (nb_entries > MAX_SUBDIR_ENTRIES(bs)) {
+        logger->error("The directory is full.");
+        return -1;
+    }
+
+    if ((inode->flags & INODE_INLINE_DATA) && size <= INLINE_DATA_SIZE) {
+        memset(inode->inline_data, 0, INLINE_DATA_SIZE);
+        memcpy(inode->inline_data, entries, size);
+    } else {
+        // The entries outgrow the inode: they move to data blocks, all of which are written
+        if (inode->flags & INODE_INLINE_DATA) {
+            memset(inode->inline_data, 0, INLINE_DATA_SIZE);
+            inode->flags &= ~INODE_INLINE_DATA;
+            first = 0;
+        }
+
+        file_t f = {.inode = dir};
+        uint32_t nb_blocks = DIV_ROUND_UP(size, bs);
+        int ret = 0;
+        for (uint32_t k = first * sizeof(dir_entry_t) / bs; k < nb_blocks && ret == 0; k++) {
+            ret = write_file_block(p, &f, inode, k, (const uint8_t*) entries + (size_t) k * bs);
+        }
+        for (uint32_t k = nb_blocks; k < NB_DATA_BLOCKS_INODE && ret == 0; k++) {
+            if (inode->data_blocks[k] != 0) {
+                ret = unref_data(p, inode->data_blocks[k]);
+                inode->data_blocks[k] = 0;
+            }
+        }
+        if (release_file_data(p, &f) == -1 || ret == -1) {
+            logger->error("An error occurred when trying to write the entries of the directory.");
+            return -1;
+        }
+    }
+
+    inode->memory_size_data = size;
+    inode->last_modification = time(NULL);
+    return update_inode(p, *inode, dir);
+}
+
+int add_entries(partition_t *p, uint32_t dir, const dir_entry_t *entries, uint32_t nb_entries, uint32_t file_type) {
+    if (dir == ROOT_DIRECTORY) {
+        if (insertion_entries(p, entries, nb_entries) == -1 || update_directory(p) == -1) {
+            return -1;
+        }
+    } else {
+        inode_t inode;
+        uint32_t nb_existing;
+        dir_entry_t *merged;
+        if ((merged = load_subdir(p, dir, &inode, nb_entries, &nb_existing)) == NULL) {
+            return -1;
+        }
+
+        // Merges from the end, like the root directory
+        int64_t i = (int64_t) nb_existing - 1;
+        int64_t j = (int64_t) nb_entries - 1;
+        int64_t dst = (int64_t) nb_existing + nb_entries - 1;
+        for (; j >= 0; dst--) {
+            int cmp = i >= 0 ? strncmp(merged[i].name, entries[j].name, MAX_FILENAME) : -1;
+            if (cmp == 0) {
+                logger->error("You're trying to create directory entry with a name already use.");
+                free(merged);
+                return -1;
+            }
+            merged[dst] = cmp > 0 ? merged[i--] : entries[j--];
+        }
+
+        int ret = store_subdir(p, dir, &inode, merged, nb_existing + nb_entries, (uint32_t) (dst + 1));
+        free(merged);
+        if (ret == -1) {
+            return -1;
+        }
+    }
+
+    for (uint32_t k = 0; k < nb_entries; k++) {
+        add_dentry(p, dir, entries[k].name, false, entries[k].inode, file_type);
+    }
+    return 0;
+}
+
+int remove_entry(partition_t *p, uint32_t dir, const char *name) {
+    if (dir == ROOT_DIRECTORY) {
+        int k;
+        if ((k = find_entry(p, name)) == -1) {
+            logger->error("There is no file with this name.");
+            return -1;
+        }
+        if (delete_entry(p, *get_entry(p, k)) == -1 || update_directory(p) == -1) {
+            return -1;
+        }
+    } else {
+        inode_t inode;
+        uint32_t nb_entries;
+        dir_entry_t *entries;
+        if ((entries = load_subdir(p, dir, &inode, 0, &nb_entries)) == NULL) {
+            return -1;
+        }
+
+        uint32_t k = 0;
+        while (k < nb_entries && strncmp(entries[k].name, name, MAX_FILENAME) != 0) {
+            k++;
+        }
+        if (k == nb_entries) {
+            logger->error("There is no file with this name.");
+            free(entries);
+            return -1;
+        }
+        memmove(entries + k, entries + k + 1, (nb_entries - k - 1) * sizeof(dir_entry_t));
+        memset(entries + nb_entries - 1, 0, sizeof(dir_entry_t));
+
+        int ret = store_subdir(p, dir, &inode, entries, nb_entries - 1, k);
+        free(entries);
+        if (ret == -1) {
+            return -1;
+        }
+    }
+
+    add_dentry(p, dir, name, true, 0, FILE_TYPE_REGULAR);
+    return 0;
+}
+
+int set_entries(partition_t *p, uint32_t dir, const dir_entry_t *entries, uint32_t nb_entries) {
+    if (dir == ROOT_DIRECTORY) {
+        return replace_entries(p, entries, nb_entries) == -1 || update_directory(p) == -1 ? -1 : 0;
+    }
+
+    inode_t inode;
+    uint32_t nb_existing;
+    dir_entry_t *padded;
+    if ((padded = load_subdir(p, dir, &inode, nb_entries, &nb_existing)) == NULL) {
+        return -1;
+    }
+    // The entries are padded with zeros up to the end of their last block
+    uint32_t bs = p->super_bloc.block_size;
+    memset(padded, 0, (size_t) DIV_ROUND_UP((nb_existing + nb_entries) * sizeof(dir_entry_t), bs) * bs);
+    memcpy(padded, entries, nb_entries * sizeof(dir_entry_t));
+
+    int ret = store_subdir(p, dir, &inode, padded, nb_entries, 0);
+    free(padded);
+    return ret;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file namespace.h
+ * @brief This file contains the operations available on the tree of directories: path walks and directory entries.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Looks up a name in a directory, through the dentry cache.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param name The name.
+ * @param inode Where to store the inode of the entry.
+ * @param file_type Where to store the FILE_TYPE_* of the entry.
+ * @return 1 if the directory has an entry with this name, 0 if it has not, -1 if an error occurs.
+ */
+int lookup_name(partition_t *p, uint32_t dir, const char *name, uint32_t *inode, uint32_t *file_type);
+
+/**
+ * @brief Walks a path down to the directory holding its last name.
+ * @param p The partition.
+ * @param path The path (names separated by '/', from the root directory).
+ * @param avoid An inode the walk must not go through, ROOT_DIRECTORY (or any index past the inodes) for none.
+ * @param dir Where to store the inode of the directory holding the last name, ROOT_DIRECTORY for the root directory.
+ * @param name Where to store the last name (MAX_FILENAME bytes), empty if the path is the root directory.
+ * @return 0 if everything went well, -1 if a directory of the path does not exist or the path is invalid.
+ */
+int resolve_parent(partition_t *p, const char *path, uint32_t avoid, uint32_t *dir, char *name);
+
+/**
+ * @brief Walks a whole path.
+ * @param p The partition.
+ * @param path The path.
+ * @param inode Where to store the inode of the path, ROOT_DIRECTORY for the root directory.
+ * @param file_type Where to store the FILE_TYPE_* of the path.
+ * @return 1 if the path exists, 0 if it does not (its directory does), -1 otherwise.
+ */
+int resolve_path(partition_t *p, const char *path, uint32_t *inode, uint32_t *file_type);
+
+/**
+ * @brief Copies a block of entries of a directory.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param k The index of the block.
+ * @param entries Where to copy the entries (a whole block).
+ * @param nb_entries Where to store the number of entries of the directory.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int read_dir_block(partition_t *p, uint32_t dir, uint32_t k, dir_entry_t *entries, uint32_t *nb_entries);
+
+/**
+ * @brief Adds entries to a directory and writes it.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param entries The entries, sorted by name, whose names are not in the directory yet.
+ * @param nb_entries The number of entries.
+ * @param file_type The FILE_TYPE_* of the entries.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int add_entries(partition_t *p, uint32_t dir, const dir_entry_t *entries, uint32_t nb_entries, uint32_t file_type);
+
+/**
+ * @brief Removes an entry from a directory and writes it.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param name The name of the entry.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int remove_entry(partition_t *p, uint32_t dir, const char *name);
+
+/**
+ * @brief Replaces all the entries of a directory and writes it. The names that are not kept are left in the dentry
+ * cache, the caller forgets them.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param entries The new entries, sorted by name.
+ * @param nb_entries The number of entries.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int set_entries(partition_t *p, uint32_t dir, const dir_entry_t *entries, uint32_t nb_entries);
@@ -0,0 +1,744 @@
+/**
+ * @file populate.c
+ * @brief This file contains the implementation of the population of a new filesystem from a host directory tree.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/crc32c.h"
+#include "../low_level/direct_io.h"
+#include "../mid_level/checksum.h"
+#include "../mid_level/data.h"
+#include "../mid_level/inode.h"
+#include "file.h"
+#include "populate.h"
+
+/**
+ * @def POPULATE_WRITE_BLOCKS The maximum number of contiguous data blocks written at once.
+ */
+#define POPULATE_WRITE_BLOCKS 256
+
+/**
+ * @def POPULATE_LOG_SIZE The size of the messages naming a host file, whose path is shorter than PATH_MAX.
+ */
+#define POPULATE_LOG_SIZE (PATH_MAX + 128)
+
+extern logger_t *logger;
+
+/**
+ * @struct host_file_t
+ * @brief A regular file or a directory of the host tree.
+ * @var name The name of the file in its directory.
+ * @var path The path of the file on the host.
+ * @var file_type The FILE_TYPE_* of the file.
+ * @var parent The index of the directory of the file, ROOT_DIRECTORY for the root directory.
+ * @var size The size of the file (of the entries of a directory).
+ * @var mtime The time of the last modification of the file.
+ * @var atime The time of the last access to the file.
+ * @var first_entry The index of the first entry of a directory in the entries of the tree.
+ */
+typedef struct {
+    char name[MAX_FILENAME];
+    char *path;
+    uint32_t file_type;
+    uint32_t parent;
+    uint32_t size;
+    uint32_t mtime;
+    uint32_t atime;
+    uint32_t first_entry;
+} host_file_t;
+
+/**
+ * @struct host_tree_t
+ * @brief The files of the host tree, in the order of their inodes (each directory before its content).
+ * @var files The files.
+ * @var nb_files The number of files.
+ * @var capacity The number of files the array can hold.
+ * @var max_size The size of the largest file the filesystem can hold.
+ * @var entries The entries of all the directories, those of each one together and sorted by name.
+ * @var nb_root_entries The number of entries of the root directory, which come first.
+ */
+typedef struct {
+    host_file_t *files;
+    uint32_t nb_files;
+    uint32_t capacity;
+    uint32_t max_size;
+    dir_entry_t *entries;
+    uint32_t nb_root_entries;
+} host_tree_t;
+
+/**
+ * @struct data_writer_t
+ * @brief Gathers the data blocks written in order into large writes.
+ * @var buffer The pending blocks.
+ * @var first The index of the first pending block.
+ * @var count The number of pending blocks.
+ */
+typedef struct {
+    uint8_t *buffer;
+    uint32_t first;
+    uint32_t count;
+} data_writer_t;
+
+static int add_host_file(host_tree_t *tree, const char *path, const char *name, uint32_t parent, const struct stat *st) {
+    if (strlen(name) >= MAX_FILENAME) {
+        char log_buf[POPULATE_LOG_SIZE];
+        snprintf(log_buf, sizeof(log_buf), "The name of this file is too long for the filesystem: %s", path);
+        logger->error(log_buf);
+        return -1;
+    }
+    if (S_ISREG(st->st_mode) && (uint64_t) st->st_size > tree->max_size) {
+        char log_buf[POPULATE_LOG_SIZE];
+        snprintf(log_buf, sizeof(log_buf), "This file is too large for the filesystem: %s", path);
+        logger->error(log_buf);
+        return -1;
+    }
+
+    if (tree->nb_files == tree->capacity) {
+        uint32_t capacity = tree->capacity == 0 ? 256 : tree->capacity * 2;
+        host_file_t *files;
+        if ((files = (host_file_t*) realloc(tree->files, capacity * sizeof(host_file_t))) == NULL) {
+            logger->error("An error occurred when trying to allocate memory.");
+            return -1;
+        }
+        tree->files = files;
+        tree->capacity = capacity;
+    }
+
+    host_file_t *file = tree->files + tree->nb_files;
+    strcpy(file->name, name);
+    if ((file->path = strdup(path)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    file->file_type = S_ISDIR(st->st_mode) ? FILE_TYPE_DIRECTORY : FILE_TYPE_REGULAR;
+    file->parent = parent;
+    file->size = S_ISDIR(st->st_mode) ? 0 : (uint32_t) st->st_size;
+    file->mtime = (uint32_t) st->st_mtime;
+    file->atime = (uint32_t) st->st_atime;
+    tree->nb_files++;
+    return 0;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+/**
+ * @brief Lists the names of a host directory, sorted.
+ * @param path The path of the directory on the host.
+ * @param nb_names Where to store the number of names.
+ * @return The names (to free with each name), NULL if an error occurs.
+ */
+static char** list_host_directory(const char *path, uint32_t *nb_names) {
+    DIR *dir;
+    if ((dir = opendir(path)) == NULL) {
+        char log_buf[POPULATE_LOG_SIZE];
+        snprintf(log_buf, sizeof(log_buf), "An error occurred when trying to open this directory: %s", path);
+        logger->error(log_buf);
+        return NULL;
+    }
+
+    char **names = NULL;
+    uint32_t capacity = 0;
+    *nb_names = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        if (*nb_names == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            char **grown;
+            if ((grown = (char**) realloc(names, capacity * sizeof(char*))) == NULL) {
+                break;
+            }
+            names = grown;
+        }
+        if ((names[*nb_names] = strdup(entry->d_name)) == NULL) {
+            break;
+        }
+        (*nb_names)++;
+    }
+    closedir(dir);
+
+    // An empty directory still gets a list
+    if (entry != NULL || (names == NULL && (names = (char**) malloc(sizeof(char*))) == NULL)) {
+        logger->error("An error occurred when trying to allocate memory.");
+        for (uint32_t k = 0; k < *nb_names; k++) {
+            free(names[k]);
+        }
+        free(names);
+        return NULL;
+    }
+    qsort(names, *nb_names, sizeof(char*), compare_names);
+    return names;
+}
+
+/**
+ * @brief Lists the regular files and the subdirectories of a host directory, each subdirectory followed by its
+ * content.
+ * @param tree The list to fill.
+ * @param path The path of the directory on the host.
+ * @param parent The index of the directory in the list, ROOT_DIRECTORY for the root.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int walk_host_directory(host_tree_t *tree, const char *path, uint32_t parent) {
+    uint32_t nb_names;
+    char **names;
+    if ((names = list_host_directory(path, &nb_names)) == NULL) {
+        return -1;
+    }
+
+    int ret = 0;
+    uint32_t nb_entries = 0;
+    for (uint32_t k = 0; k < nb_names && ret == 0; k++) {
+        char child_path[PATH_MAX];
+        int length = snprintf(child_path, sizeof(child_path), "%s/%s", path, names[k]);
+
+        struct stat st;
+        if (length < 0 || (size_t) length >= sizeof(child_path)) {
+            char log_buf[POPULATE_LOG_SIZE];
+            snprintf(log_buf, sizeof(log_buf), "The path of a file of this directory is too long for the host: %s", path);
+            logger->error(log_buf);
+            ret = -1;
+        } else if (lstat(child_path, &st) == -1) {
+            logger->error("An error occurred when trying to read the attributes of a host file.");
+            ret = -1;
+        } else if (S_ISDIR(st.st_mode) || S_ISREG(st.st_mode)) {
+            uint32_t index = tree->nb_files;
+            nb_entries++;
+            if ((ret = add_host_file(tree, child_path, names[k], parent, &st)) == 0 && S_ISDIR(st.st_mode)) {
+                ret = walk_host_directory(tree, child_path, index);
+            }
+        }
+    }
+    for (uint32_t k = 0; k < nb_names; k++) {
+        free(names[k]);
+    }
+    free(names);
+
+    // The entries of a subdirectory are its content, which cannot be larger than a file
+    if (ret == 0 && parent != ROOT_DIRECTORY) {
+        if ((uint64_t) nb_entries * sizeof(dir_entry_t) > tree->max_size) {
+            char log_buf[POPULATE_LOG_SIZE];
+            snprintf(log_buf, sizeof(log_buf), "This directory has too many entries for the filesystem: %s", path);
+            logger->error(log_buf);
+            return -1;
+        }
+        tree->files[parent].size = nb_entries * sizeof(dir_entry_t);
+    }
+    return ret;
+}
+
+/**
+ * @brief Gathers the entries of each directory.
+ * @param tree The files, whose index is their inode and where the files of a directory are in the order of their names.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int build_directories(host_tree_t *tree) {
+    if ((tree->entries = (dir_entry_t*) calloc(tree->nb_files + 1, sizeof(dir_entry_t))) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    // The entries of the root come first, then those of the subdirectories in the order of their inodes
+    tree->nb_root_entries = 0;
+    for (uint32_t k = 0; k < tree->nb_files; k++) {
+        tree->nb_root_entries += tree->files[k].parent == ROOT_DIRECTORY;
+    }
+    uint32_t next = tree->nb_root_entries;
+    for (uint32_t k = 0; k < tree->nb_files; k++) {
+        if (tree->files[k].file_type == FILE_TYPE_DIRECTORY) {
+            tree->files[k].first_entry = next;
+            next += tree->files[k].size / sizeof(dir_entry_t);
+        }
+    }
+
+    uint32_t nb_root = 0;
+    uint32_t *filled;
+    if ((filled = (uint32_t*) calloc(tree->nb_files + 1, sizeof(uint32_t))) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    for (uint32_t k = 0; k < tree->nb_files; k++) {
+        const host_file_t *file = tree->files + k;
+        dir_entry_t *entry;
+        if (file->parent == ROOT_DIRECTORY) {
+            entry = tree->entries + nb_root++;
+        } else {
+            entry = tree->entries + tree->files[file->parent].first_entry + filled[file->parent]++;
+        }
+        strcpy(entry->name, file->name);
+        entry->inode = k;
+    }
+    free(filled);
+    return 0;
+}
+
+static void free_host_tree(host_tree_t *tree) {
+    for (uint32_t k = 0; k < tree->nb_files; k++) {
+        free(tree->files[k].path);
+    }
+    free(tree->files);
+    free(tree->entries);
+}
+
+static int flush_data_writer(partition_t *p, data_writer_t *w) {
+    if (w->count == 0) {
+        return 0;
+    }
+    if (write_image(p, w->buffer, (size_t) w->count * p->super_bloc.block_size, get_data_offset(p, w->first)) == -1) {
+        logger->error("An error occurred when trying to write the data of the files.");
+        return -1;
+    }
+    w->count = 0;
+    return 0;
+}
+
+/**
+ * @brief Appends a data block to the pending write, which is flushed first if the block does not follow it on disk.
+ * @param p The partition.
+ * @param w The writer.
+ * @param i The index of the data block.
+ * @param block The content of the block.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_populated_block(partition_t *p, data_writer_t *w, uint32_t i, const uint8_t *block) {
+    uint32_t dpg = p->super_bloc.data_per_group;
+    bool contiguous = w->count > 0 && i == w->first + w->count && i / dpg == w->first / dpg;
+    if ((!contiguous || w->count == POPULATE_WRITE_BLOCKS) && flush_data_writer(p, w) == -1) {
+        return -1;
+    }
+    if (w->count == 0) {
+        w->first = i;
+    }
+    memcpy(w->buffer + (size_t) w->count * p->super_bloc.block_size, block, p->super_bloc.block_size);
+    w->count++;
+    return 0;
+}
+
+/**
+ * @brief Writes a fragment block holding the tails of the populated files.
+ * @param p The partition.
+ * @param frag The content of the fragment block.
+ * @param i The index of the fragment block.
+ * @param crcs Where to store the checksum of the fragment block.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_populated_fragment(partition_t *p, const uint8_t *frag, uint32_t i, uint32_t *crcs) {
+    if (write_image(p, frag, p->super_bloc.block_size, get_data_offset(p, i)) == -1) {
+        logger->error("An error occurred when trying to write the tails of the files.");
+        return -1;
+    }
+    crcs[i] = crc32c(frag, p->super_bloc.block_size);
+    return 0;
+}
+
+/**
+ * @brief Finds where the next blocks are laid out: they are moved to the next group rather than split, unless they are
+ * larger than the rest of a group.
+ * @param p The partition.
+ * @param next The index of the next free data block.
+ * @param nb_blocks The number of blocks to lay out.
+ * @return The index of the first block, p->super_bloc.nb_data if the partition is too small.
+ */
+static uint32_t place_blocks(partition_t *p, uint32_t next, uint32_t nb_blocks) {
+    uint32_t dpg = p->super_bloc.data_per_group;
+    uint32_t g = next / dpg;
+    uint32_t group_end = g * dpg + p->gdt[g].nb_data;
+    if (next + nb_blocks > group_end && g + 1 < p->super_bloc.nb_groups && nb_blocks <= p->gdt[g + 1].nb_data) {
+        next = (g + 1) * dpg;
+    }
+    if (next + nb_blocks > p->super_bloc.nb_data) {
+        logger->error("The partition is too small to hold the files of the directory.");
+        return p->super_bloc.nb_data;
+    }
+    return next;
+}
+
+/**
+ * @brief Reads a whole host file.
+ * @param file The file.
+ * @param buffer Where to store its content (the size of the largest file).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int read_host_file(const host_file_t *file, uint8_t *buffer) {
+    int fd;
+    if ((fd = open(file->path, O_RDONLY)) == -1) {
+        char log_buf[POPULATE_LOG_SIZE];
+        snprintf(log_buf, sizeof(log_buf), "An error occurred when trying to open this file: %s", file->path);
+        logger->error(log_buf);
+        return -1;
+    }
+
+    uint32_t length = 0;
+    ssize_t n = 0;
+    while (length < file->size && (n = read(fd, buffer + length, file->size - length)) > 0) {
+        length += (uint32_t) n;
+    }
+    close(fd);
+    if (length != file->size) {
+        char log_buf[POPULATE_LOG_SIZE];
+        snprintf(log_buf, sizeof(log_buf), "An error occurred when trying to read this file: %s", file->path);
+        logger->error(log_buf);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Computes the blocks a file is stored in, compressing its clusters and leaving holes like write_clusters does.
+ * @param p The partition.
+ * @param inode The inode of the file, whose cluster sizes are set.
+ * @param content The content of the file, padded with zeros to a whole number of blocks.
+ * @param stored Where to store the blocks, each one at the position it has in the file.
+ * @param present Set to 1 for each block of the file that has to be stored.
+ * @return The number of blocks to store.
+ */
+static uint32_t encode_file(partition_t *p, inode_t *inode, const uint8_t *content, uint8_t *stored, uint8_t *present) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t cluster_bytes = COMPRESS_CLUSTER_BLOCKS * bs;
+    uint32_t size = inode->memory_size_data;
+    uint32_t nb_blocks = 0;
+
+    memset(present, 0, NB_DATA_BLOCKS_INODE);
+    for (uint32_t c = 0; c * cluster_bytes < size; c++) {
+        uint32_t length = size - c * cluster_bytes < cluster_bytes ? size - c * cluster_bytes : cluster_bytes;
+        uint8_t *dst = stored + (size_t) c * cluster_bytes;
+
+        size_t compressed = compress_cluster(p, inode, content + c * cluster_bytes, length, dst);
+        if (compressed == 0) {
+            memcpy(dst, content + c * cluster_bytes, DIV_ROUND_UP(length, bs) * bs);
+        }
+        inode->cluster_size[c] = (uint32_t) compressed;
+
+        // The blocks of zeros are holes, like write_file_block leaves them
+        uint32_t n = compressed != 0 ? DIV_ROUND_UP(compressed, bs) : DIV_ROUND_UP(length, bs);
+        for (uint32_t j = 0; j < n; j++) {
+            present[c * COMPRESS_CLUSTER_BLOCKS + j] = !is_zero_block(p, dst + j * bs);
+            nb_blocks += present[c * COMPRESS_CLUSTER_BLOCKS + j];
+        }
+    }
+    return nb_blocks;
+}
+
+/**
+ * @brief Writes the metadata of a group covering the populated inodes and data blocks.
+ * @param p The partition.
+ * @param g The index of the group.
+ * @param used The data bitmap entries of all the data blocks.
+ * @param nb_used The number of data blocks laid out (used or skipped).
+ * @param inodes The inodes of all the files.
+ * @param nb_files The number of files.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_group_metadata(partition_t *p, uint32_t g, const uint8_t *used, uint32_t nb_used, const inode_t *inodes,
+                                uint32_t nb_files) {
+    uint32_t bs = p->super_bloc.block_size;
+    group_desc_t *gd = p->gdt + g;
+    uint32_t first_data = g * p->super_bloc.data_per_group;
+    uint32_t first_inode = g * p->super_bloc.inodes_per_group;
+
+    // The bitmaps of the group only need the blocks covering the entries laid out in it
+    uint32_t data_entries = nb_used > first_data ? nb_used - first_data : 0;
+    data_entries = data_entries < gd->nb_data ? data_entries : gd->nb_data;
+    uint32_t inode_entries = nb_files > first_inode ? nb_files - first_inode : 0;
+    inode_entries = inode_entries < gd->nb_inodes ? inode_entries : gd->nb_inodes;
+    uint32_t data_bitmap_blocks = DIV_ROUND_UP(data_entries, bs);
+    uint32_t inode_bitmap_blocks = DIV_ROUND_UP(inode_entries, bs);
+    uint32_t inode_table_blocks = DIV_ROUND_UP(inode_entries * sizeof(inode_t), bs);
+
+    uint32_t max_blocks = data_bitmap_blocks > inode_bitmap_blocks ? data_bitmap_blocks : inode_bitmap_blocks;
+    max_blocks = max_blocks > inode_table_blocks ? max_blocks : inode_table_blocks;
+    if (max_blocks == 0) {
+        return 0;
+    }
+    uint8_t *buf;
+    if (posix_memalign((void**) &buf, bs, (size_t) max_blocks * bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    int ret = 0;
+    if (data_bitmap_blocks > 0) {
+        memset(buf, 0, (size_t) data_bitmap_blocks * bs);
+        memcpy(buf, used + first_data, data_entries);
+        ret = write_image(p, buf, (size_t) data_bitmap_blocks * bs, (off_t) gd->data_bitmap_start * bs) == -1 ? -1 : 0;
+        gd->data_bitmap_init = gd->data_bitmap_init > data_bitmap_blocks ? gd->data_bitmap_init : data_bitmap_blocks;
+    }
+    if (ret == 0 && inode_bitmap_blocks > 0) {
+        memset(buf, 0, (size_t) inode_bitmap_blocks * bs);
+        memset(buf, 1, inode_entries);
+        ret = write_image(p, buf, (size_t) inode_bitmap_blocks * bs, (off_t) gd->inode_bitmap_start * bs) == -1 ? -1 : 0;
+        gd->inode_bitmap_init = gd->inode_bitmap_init > inode_bitmap_blocks ? gd->inode_bitmap_init : inode_bitmap_blocks;
+        gd->nb_inodes_free -= inode_entries;
+        p->super_bloc.nb_inodes_free -= inode_entries;
+    }
+    if (ret == 0 && inode_table_blocks > 0) {
+        memset(buf, 0, (size_t) inode_table_blocks * bs);
+        memcpy(buf, inodes + first_inode, inode_entries * sizeof(inode_t));
+        ret = write_image(p, buf, (size_t) inode_table_blocks * bs, (off_t) gd->inode_table_start * bs) == -1 ? -1 : 0;
+        gd->inode_table_init = inode_table_blocks;
+    }
+    free(buf);
+
+    if (ret == -1) {
+        logger->error("An error occurred when trying to write the metadata of a group.");
+    }
+    return ret;
+}
+
+/**
+ * @brief Writes the checksums of the populated data blocks.
+ * @param p The partition.
+ * @param crcs The checksums of the data blocks, as many blocks of checksums as the region.
+ * @param nb_used The number of data blocks laid out.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_populated_checksums(partition_t *p, const uint32_t *crcs, uint32_t nb_used) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t blocks = DIV_ROUND_UP(nb_used, bs / sizeof(uint32_t));
+    if (write_image(p, crcs, (size_t) blocks * bs, (off_t) p->super_bloc.checksum_start * bs) == -1) {
+        logger->error("An error occurred when trying to write the checksums.");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes the entries of the root directory, which are sorted by name.
+ * @param p The partition.
+ * @param tree The files.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_populated_directory(partition_t *p, const host_tree_t *tree) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t per_block = bs / sizeof(dir_entry_t);
+    dir_entry_t *block;
+    if (posix_memalign((void**) &block, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    for (uint32_t k = 0; k * per_block < tree->nb_root_entries; k++) {
+        uint32_t n = tree->nb_root_entries - k * per_block < per_block ? tree->nb_root_entries - k * per_block : per_block;
+        memset(block, 0, bs);
+        memcpy(block, tree->entries + k * per_block, n * sizeof(dir_entry_t));
+        if (write_image(p, block, bs, get_data_offset(p, k)) == -1) {
+            logger->error("An error occurred when trying to write the directory.");
+            free(block);
+            return -1;
+        }
+    }
+    free(block);
+
+    p->super_bloc.nb_dir_entries = tree->nb_root_entries;
+    return 0;
+}
+
+/**
+ * @brief Lays out the files contiguously and streams their data.
+ * @param p The partition.
+ * @param tree The files, in the order of their inodes.
+ * @param inodes Where to store the inodes of the files.
+ * @param used Where to mark the data blocks used.
+ * @param crcs Where to store the checksums of the data blocks.
+ * @param nb_used Where to store the number of data blocks laid out (used or skipped).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int write_populated_data(partition_t *p, const host_tree_t *tree, inode_t *inodes, uint8_t *used, uint32_t *crcs,
+                                uint32_t *nb_used) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t dpg = p->super_bloc.data_per_group;
+    size_t file_bytes = (size_t) NB_DATA_BLOCKS_INODE * bs;
+
+    uint8_t *content = (uint8_t*) malloc(file_bytes);
+    uint8_t *stored = (uint8_t*) malloc(file_bytes);
+    uint8_t *frag = NULL;
+    data_writer_t w = {NULL, 0, 0};
+    if (content == NULL || stored == NULL || posix_memalign((void**) &w.buffer, bs, (size_t) POPULATE_WRITE_BLOCKS * bs) != 0
+        || posix_memalign((void**) &frag, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(w.buffer);
+        free(content);
+        free(stored);
+        return -1;
+    }
+
+    // The data blocks follow the directory, which uses the first ones
+    uint32_t next = (uint32_t) DIV_ROUND_UP(p->super_bloc.nb_inodes * sizeof(dir_entry_t), bs);
+    uint32_t frag_block = 0;
+    uint32_t frag_used = 0;
+    int ret = 0;
+    for (uint32_t k = 0; k < tree->nb_files && ret == 0; k++) {
+        const host_file_t *file = tree->files + k;
+        inode_t *inode = inodes + k;
+        inode->memory_size_data = file->size;
+        inode->last_modification = file->mtime;
+        inode->last_access = file->atime;
+        inode->file_type = file->file_type;
+        inode->flags = file->file_type == FILE_TYPE_REGULAR && (p->super_bloc.flags & FS_FEATURE_COMPRESS) ? INODE_COMPRESSED : 0;
+
+        memset(content, 0, file_bytes);
+        if (file->file_type == FILE_TYPE_DIRECTORY) {
+            memcpy(content, tree->entries + file->first_entry, file->size);
+        } else if ((ret = read_host_file(file, content)) == -1) {
+            break;
+        }
+
+        // Small files are kept in their inode, as the writes would do
+        if (file->size <= INLINE_DATA_SIZE) {
+            inode->flags |= INODE_INLINE_DATA;
+            memcpy(inode->inline_data, content, file->size);
+            continue;
+        }
+
+        uint8_t present[NB_DATA_BLOCKS_INODE];
+        uint32_t nb_blocks = encode_file(p, inode, content, stored, present);
+
+        // The tail of a regular file goes to a fragment block, where pack_tail would put it when the file is closed
+        uint32_t tail = file->size % bs;
+        uint32_t t = file->size / bs;
+        if (file->file_type == FILE_TYPE_REGULAR && !(inode->flags & INODE_COMPRESSED) && tail > 0
+            && tail <= MAX_PACKED_TAIL(bs) && present[t]) {
+            if (frag_block == 0 || frag_used + tail > bs || used[frag_block] == DATA_REFCOUNT_MASK - 1) {
+                if (frag_block != 0 && (ret = write_populated_fragment(p, frag, frag_block, crcs)) == -1) {
+                    break;
+                }
+                if ((next = place_blocks(p, next, 1)) == p->super_bloc.nb_data) {
+                    ret = -1;
+                    break;
+                }
+                frag_block = next++;
+                frag_used = 0;
+                memset(frag, 0, bs);
+                p->gdt[frag_block / dpg].nb_data_free--;
+                p->super_bloc.nb_data_free--;
+            }
+            memcpy(frag + frag_used, stored + (size_t) t * bs, tail);
+            inode->data_blocks[t] = frag_block;
+            inode->tail_offset = frag_used;
+            inode->flags |= INODE_TAIL_PACKED;
+            frag_used += tail;
+            used[frag_block]++;
+            present[t] = 0;
+            nb_blocks--;
+        }
+
+        if ((next = place_blocks(p, next, nb_blocks)) == p->super_bloc.nb_data) {
+            ret = -1;
+            break;
+        }
+
+        for (uint32_t b = 0; b < NB_DATA_BLOCKS_INODE && ret == 0; b++) {
+            if (!present[b]) {
+                continue;
+            }
+            uint32_t i = next++;
+            const uint8_t *block = stored + (size_t) b * bs;
+            inode->data_blocks[b] = i;
+            used[i] = 1;
+            crcs[i] = crc32c(block, bs);
+            p->gdt[i / dpg].nb_data_free--;
+            p->super_bloc.nb_data_free--;
+            ret = write_populated_block(p, &w, i, block);
+        }
+    }
+    if (ret == 0) {
+        ret = flush_data_writer(p, &w);
+    }
+
+    // The last fragment block stays the one being filled, which holds a reference of its own
+    if (ret == 0 && frag_block != 0) {
+        ret = write_populated_fragment(p, frag, frag_block, crcs);
+        used[frag_block]++;
+        p->super_bloc.frag_block = frag_block;
+        p->super_bloc.frag_used = frag_used;
+    }
+
+    free(frag);
+    free(w.buffer);
+    free(content);
+    free(stored);
+    *nb_used = next;
+    return ret;
+}
+
+int populate_from_directory(partition_t *p, const char *root) {
+    host_tree_t tree = {
+            .files = NULL,
+            .nb_files = 0,
+            .capacity = 0,
+            .max_size = NB_DATA_BLOCKS_INODE * p->super_bloc.block_size,
+            .entries = NULL,
+            .nb_root_entries = 0
+    };
+    if (walk_host_directory(&tree, root, ROOT_DIRECTORY) == -1) {
+        free_host_tree(&tree);
+        return -1;
+    }
+    if (tree.nb_files > p->super_bloc.nb_inodes) {
+        logger->error("The partition does not have enough inodes for the files of the directory.");
+        free_host_tree(&tree);
+        return -1;
+    }
+    if (build_directories(&tree) == -1) {
+        free_host_tree(&tree);
+        return -1;
+    }
+
+    // The directory blocks are already marked as used, they are part of the bitmaps written back
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t per_block = bs / sizeof(uint32_t);
+    uint8_t *used = (uint8_t*) calloc(p->super_bloc.nb_data, sizeof(uint8_t));
+    uint32_t *crcs = (uint32_t*) calloc((size_t) DIV_ROUND_UP(p->super_bloc.nb_data, per_block) * per_block, sizeof(uint32_t));
+    inode_t *inodes = (inode_t*) calloc(tree.nb_files + 1, sizeof(inode_t));
+    if (used == NULL || crcs == NULL || inodes == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(used);
+        free(crcs);
+        free(inodes);
+        free_host_tree(&tree);
+        return -1;
+    }
+    memset(used, 1, DIV_ROUND_UP(p->super_bloc.nb_inodes * sizeof(dir_entry_t), bs));
+
+    uint32_t nb_used = 0;
+    int ret = write_populated_data(p, &tree, inodes, used, crcs, &nb_used);
+    if (ret == 0 && (p->super_bloc.flags & FS_FEATURE_CHECKSUM)) {
+        for (uint32_t k = 0; k < tree.nb_files; k++) {
+            inodes[k].checksum = inode_checksum(inodes[k]);
+        }
+        ret = write_populated_checksums(p, crcs, nb_used);
+    }
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups && ret == 0; g++) {
+        ret = write_group_metadata(p, g, used, nb_used, inodes, tree.nb_files);
+    }
+    if (ret == 0) {
+        ret = write_populated_directory(p, &tree);
+    }
+
+    if (ret == 0) {
+        char log_buf[128];
+        sprintf(log_buf, "%u files copied in %u data blocks.", tree.nb_files, p->super_bloc.nb_data - p->super_bloc.nb_data_free);
+        logger->info(log_buf);
+    }
+    free(used);
+    free(crcs);
+    free(inodes);
+    free_host_tree(&tree);
+    return ret;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file populate.h
+ * @brief This file contains the population of a new filesystem from a host directory tree.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Copies the regular files and the directories of a host directory tree into a filesystem being created.
+ * @param p The partition being created: its groups are laid out, its bitmaps, directory and checksums created, but
+ * its group descriptors are not written yet.
+ * @param root The host directory.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The files keep their names and directories. Their inodes are taken in order from the first group, each directory
+ * before its content, which is visited by name. Their data blocks are laid out contiguously after the directory (a file is moved to the next group
+ * rather than split between two). The data is streamed with large sequential writes, then the checksums, bitmaps,
+ * inode tables and directory blocks are each written once. The descriptors record the inode table blocks written,
+ * so that create_groups only zeroes the rest.
+ */
+int populate_from_directory(partition_t *p, const char *root);
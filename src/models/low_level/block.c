@@ -6,6 +6,8 @@
  * @date 03-28-2024
  */
 
+#define _GNU_SOURCE
+
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,6 +18,12 @@
 #include "unix_fs_sim/exits.h"
 
 #include "block.h"
+#include "direct_io.h"
+
+/**
+ * @def ZERO_WRITE_BLOCKS The number of blocks zeroed by a single write when fallocate is not available.
+ */
+#define ZERO_WRITE_BLOCKS 256
 
 extern logger_t *logger;
 
@@ -34,11 +42,7 @@ int read_block(partition_t *p, void *buf, uint32_t i) {
         return -1;
     }
 
-    if (lseek(p->fd, (off_t) i * p->super_bloc.block_size, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-    if (read(p->fd, buf, p->super_bloc.block_size) == -1) {
+    if (read_image(p, buf, p->super_bloc.block_size, (off_t) i * p->super_bloc.block_size) == -1) {
         logger->error("An error occurred when trying to read the file.");
         return -1;
     }
@@ -52,15 +56,10 @@ int update_bloc(partition_t *p, void *buf, uint32_t data_length, uint32_t i, uin
         return -1;
     }
 
-    if (lseek(p->fd, (off_t) (i * p->super_bloc.block_size) + offset, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-
     data_length = data_length > (p->super_bloc.block_size - offset)
             ? p->super_bloc.block_size - offset
             : data_length;
-    if (write(p->fd, buf, data_length) == -1) {
+    if (write_image(p, buf, data_length, (off_t) i * p->super_bloc.block_size + offset) == -1) {
         logger->error("An error occurred when trying to update the block.");
         return -1;
     }
@@ -74,11 +73,7 @@ int write_bloc(partition_t *p, const void *buf, uint32_t i) {
         return -1;
     }
 
-    if (lseek(p->fd, (off_t) i * p->super_bloc.block_size, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-    if (write(p->fd, buf, p->super_bloc.block_size) == -1) {
+    if (write_image(p, buf, p->super_bloc.block_size, (off_t) i * p->super_bloc.block_size) == -1) {
         logger->error("An error occurred when trying to write the block.");
         return -1;
     }
@@ -92,22 +87,77 @@ int delete_block(partition_t *p, uint32_t i) {
         return -1;
     }
 
-    if (lseek(p->fd, (off_t) i * p->super_bloc.block_size, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+    // The block is punched out of the image when the host allows it, and overwritten with zeros otherwise
+    if (zero_blocks(p, i, 1) == -1) {
+        logger->error("An error occurred when trying to delete the block.");
         return -1;
     }
 
-    char *buf;
-    if ((buf = (char*) malloc(p->super_bloc.block_size * sizeof(char))) == NULL) {
+    logger->trace("Block deleted.");
+    return 0;
+}
+
+int punch_blocks(partition_t *p, uint32_t first, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+#ifdef __linux__
+    off_t offset = (off_t) first * p->super_bloc.block_size;
+    off_t length = (off_t) count * p->super_bloc.block_size;
+    if (fallocate(p->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) == 0) {
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+int zero_blocks_fast(partition_t *p, uint32_t first, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    // Punching a hole does not reserve any space on the host, unlike zeroing the range
+    if (punch_blocks(p, first, count) == 0) {
+        return 0;
+    }
+#ifdef __linux__
+    off_t offset = (off_t) first * p->super_bloc.block_size;
+    off_t length = (off_t) count * p->super_bloc.block_size;
+    if (fallocate(p->fd, FALLOC_FL_ZERO_RANGE, offset, length) == 0) {
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+int zero_blocks(partition_t *p, uint32_t first, uint32_t count) {
+    if (first + count > p->super_bloc.nb_blocks) {
+        logger->error("You are trying to zero blocks beyond the partition.");
+        return -1;
+    }
+
+    if (zero_blocks_fast(p, first, count) == 0) {
+        logger->trace("Blocks zeroed.");
+        return 0;
+    }
+
+    uint32_t chunk = count < ZERO_WRITE_BLOCKS ? count : ZERO_WRITE_BLOCKS;
+    void *buf;
+    if (posix_memalign(&buf, p->super_bloc.block_size, (size_t) chunk * p->super_bloc.block_size) != 0) {
         logger->error("An error occurred when trying to allocate memory.");
         exit(ERR_MALLOC);
     }
-    memset(buf, 0, p->super_bloc.block_size);
-    if (write(p->fd, buf, p->super_bloc.block_size) == -1) {
-        logger->error("An error occurred when trying to delete the block.");
-        return -1;
+    memset(buf, 0, (size_t) chunk * p->super_bloc.block_size);
+
+    for (uint32_t done = 0; done < count; done += chunk) {
+        uint32_t n = count - done < chunk ? count - done : chunk;
+        if (write_image(p, buf, (size_t) n * p->super_bloc.block_size, (off_t) (first + done) * p->super_bloc.block_size) == -1) {
+            logger->error("An error occurred when trying to zero the blocks.");
+            free(buf);
+            return -1;
+        }
     }
 
-    logger->trace("Block deleted.");
+    free(buf);
+    logger->trace("Blocks zeroed.");
     return 0;
 }
\ No newline at end of file
@@ -57,4 +57,33 @@ int write_bloc(partition_t *p, const void *buf, uint32_t i);
  * @param i The index of the block to delete.
  * @return 0 if everything went well, -1 otherwise.
  */
-int delete_block(partition_t *p, uint32_t i);
\ No newline at end of file
+int delete_block(partition_t *p, uint32_t i);
+
+/**
+ * @brief Gives the host storage of a range of blocks back, punching a hole in the image.
+ * @param p The partition.
+ * @param first The index of the first block.
+ * @param count The number of blocks.
+ * @return 0 if the range has been punched, -1 if the host does not support it.
+ *
+ * The content of the range is lost: it reads back as zeros.
+ */
+int punch_blocks(partition_t *p, uint32_t first, uint32_t count);
+
+/**
+ * @brief Zeroes a range of blocks using fallocate, without writing any data.
+ * @param p The partition.
+ * @param first The index of the first block to zero.
+ * @param count The number of blocks to zero.
+ * @return 0 if the range now reads back as zeros, -1 if the host does not support it.
+ */
+int zero_blocks_fast(partition_t *p, uint32_t first, uint32_t count);
+
+/**
+ * @brief Zeroes a range of blocks, falling back to large aligned writes if fallocate is not supported.
+ * @param p The partition.
+ * @param first The index of the first block to zero.
+ * @param count The number of blocks to zero.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int zero_blocks(partition_t *p, uint32_t first, uint32_t count);
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+ * @file crc32c.c
+ * @brief This file contains the implementation of the CRC32C checksum.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+#include "crc32c.h"
+
+/**
+ * @def CRC32C_POLY The reversed polynomial of CRC32C.
+ */
+#define CRC32C_POLY 0x82F63B78U
+
+static uint32_t crc32c_table[8][256];
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+static int crc32c_hw_available;
+
+static void crc32c_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t crc = n;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        crc32c_table[0][n] = crc;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+        for (int t = 1; t < 8; t++) {
+            crc32c_table[t][n] = (crc32c_table[t - 1][n] >> 8) ^ crc32c_table[0][crc32c_table[t - 1][n] & 0xFF];
+        }
+    }
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    crc32c_hw_available = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+/**
+ * @brief Software CRC32C, slicing by 8 bytes.
+ */
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, size_t length) {
+    while (length >= 8) {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, p, 4);
+        memcpy(&high, p + 4, 4);
+        low ^= crc;
+        crc = crc32c_table[7][low & 0xFF] ^ crc32c_table[6][(low >> 8) & 0xFF]
+              ^ crc32c_table[5][(low >> 16) & 0xFF] ^ crc32c_table[4][low >> 24]
+              ^ crc32c_table[3][high & 0xFF] ^ crc32c_table[2][(high >> 8) & 0xFF]
+              ^ crc32c_table[1][(high >> 16) & 0xFF] ^ crc32c_table[0][high >> 24];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+/**
+ * @brief Hardware CRC32C, 8 bytes per crc32 instruction.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, size_t length) {
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        length -= 8;
+    }
+    crc = (uint32_t) crc64;
+    while (length-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+uint32_t crc32c(const void *data, size_t length) {
+    pthread_once(&crc32c_once, crc32c_init);
+
+#if defined(__x86_64__)
+    if (crc32c_hw_available) {
+        return ~crc32c_hw(~0U, (const uint8_t*) data, length);
+    }
+#endif
+    return ~crc32c_sw(~0U, (const uint8_t*) data, length);
+}
@@ -0,0 +1,20 @@
+/**
+ * @file crc32c.h
+ * @brief This file contains the CRC32C (Castagnoli) checksum used to detect the corruption of the blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Computes the CRC32C of a buffer, with the crc32 instruction of SSE 4.2 when the processor has it.
+ * @param data The buffer.
+ * @param length The length of the buffer.
+ * @return The CRC32C of the buffer.
+ */
+uint32_t crc32c(const void *data, size_t length);
@@ -0,0 +1,204 @@
+/**
+ * @file direct_io.c
+ * @brief This file contains the implementation of the transfers with the image of a partition.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "direct_io.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Tells whether a transfer can go straight between the image and the buffer of the caller.
+ * @param p The partition.
+ * @param buf The buffer of the caller.
+ * @param length The length of the transfer.
+ * @param offset The position of the transfer in the image.
+ * @return Whether the buffer, the length and the offset are aligned on the blocks.
+ */
+static bool is_aligned(partition_t *p, const void *buf, size_t length, off_t offset) {
+    uint32_t bs = p->super_bloc.block_size;
+    return (uintptr_t) buf % bs == 0 && length % bs == 0 && offset % bs == 0;
+}
+
+/**
+ * @brief Takes a buffer of the pool, waiting for one to be given back if they are all used.
+ * @param p The partition.
+ * @return The buffer.
+ */
+static uint8_t* take_buffer(partition_t *p) {
+    buffer_pool_t *pool = &p->pool;
+    pthread_mutex_lock(&pool->lock);
+    while (pool->nb_free == 0) {
+        pthread_cond_wait(&pool->cond, &pool->lock);
+    }
+    uint32_t k = pool->free_buffers[--pool->nb_free];
+    pthread_mutex_unlock(&pool->lock);
+    return pool->memory + (size_t) k * pool->buffer_size;
+}
+
+/**
+ * @brief Gives a buffer back to the pool.
+ * @param p The partition.
+ * @param buffer The buffer.
+ */
+static void give_buffer(partition_t *p, uint8_t *buffer) {
+    buffer_pool_t *pool = &p->pool;
+    pthread_mutex_lock(&pool->lock);
+    pool->free_buffers[pool->nb_free++] = (uint32_t) ((buffer - pool->memory) / pool->buffer_size);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int start_direct_io(partition_t *p) {
+    buffer_pool_t *pool = &p->pool;
+    uint32_t bs = p->super_bloc.block_size;
+    pool->nb_buffers = DIRECT_IO_BUFFERS;
+    pool->buffer_size = DIRECT_IO_BUFFER_BLOCKS * bs;
+    pool->nb_free = DIRECT_IO_BUFFERS;
+    void *memory;
+    if (posix_memalign(&memory, bs, (size_t) pool->nb_buffers * pool->buffer_size) != 0
+        || (pool->free_buffers = (uint32_t*) malloc(pool->nb_buffers * sizeof(uint32_t))) == NULL) {
+        logger->error("An error occurred when trying to allocate the buffers of the direct I/O.");
+        return -1;
+    }
+    pool->memory = (uint8_t*) memory;
+    for (uint32_t k = 0; k < pool->nb_buffers; k++) {
+        pool->free_buffers[k] = k;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0 || pthread_cond_init(&pool->cond, NULL) != 0) {
+        logger->error("An error occurred when trying to create the lock of the buffers of the direct I/O.");
+        return -1;
+    }
+    for (uint32_t k = 0; k < DIRECT_IO_LOCKS; k++) {
+        if (pthread_mutex_init(pool->block_locks + k, NULL) != 0) {
+            logger->error("An error occurred when trying to create the locks of the blocks.");
+            return -1;
+        }
+    }
+
+    // The host may need larger transfers than the blocks of the partition: the first block tells
+    int flags;
+    if ((flags = fcntl(p->fd, F_GETFL)) == -1 || fcntl(p->fd, F_SETFL, flags | O_DIRECT) == -1) {
+        logger->error("The host does not support direct I/O on this partition.");
+        return -1;
+    }
+    if (pread(p->fd, pool->memory, bs, 0) != (ssize_t) bs) {
+        logger->error("The host does not accept direct transfers of the blocks of this partition.");
+        return -1;
+    }
+
+    p->direct_io = true;
+    logger->trace("Direct I/O started.");
+    return 0;
+}
+
+void stop_direct_io(partition_t *p) {
+    if (!p->direct_io) {
+        return;
+    }
+    buffer_pool_t *pool = &p->pool;
+    for (uint32_t k = 0; k < DIRECT_IO_LOCKS; k++) {
+        pthread_mutex_destroy(pool->block_locks + k);
+    }
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->free_buffers);
+    free(pool->memory);
+    p->direct_io = false;
+}
+
+ssize_t read_image(partition_t *p, void *buf, size_t length, off_t offset) {
+    if (!p->direct_io || is_aligned(p, buf, length, offset)) {
+        return pread(p->fd, buf, length, offset);
+    }
+
+    // The range is read by whole blocks into the pool, a buffer at a time
+    uint32_t bs = p->super_bloc.block_size;
+    uint8_t *buffer = take_buffer(p);
+    size_t done = 0;
+    ssize_t ret = 0;
+    while (done < length) {
+        off_t pos = offset + (off_t) done;
+        off_t start = pos - pos % bs;
+        size_t skip = (size_t) (pos - start);
+        size_t span = DIV_ROUND_UP(skip + length - done, bs) * bs;
+        if (span > p->pool.buffer_size) {
+            span = p->pool.buffer_size;
+        }
+
+        ssize_t n;
+        if ((n = pread(p->fd, buffer, span, start)) == -1) {
+            ret = -1;
+            break;
+        }
+        size_t copy = (size_t) n > skip ? (size_t) n - skip : 0;
+        copy = copy < length - done ? copy : length - done;
+        memcpy((uint8_t*) buf + done, buffer + skip, copy);
+        done += copy;
+        // The end of the image
+        if ((size_t) n < span) {
+            break;
+        }
+    }
+    give_buffer(p, buffer);
+    return ret == -1 ? -1 : (ssize_t) done;
+}
+
+ssize_t write_image(partition_t *p, const void *buf, size_t length, off_t offset) {
+    if (!p->direct_io || is_aligned(p, buf, length, offset)) {
+        return pwrite(p->fd, buf, length, offset);
+    }
+
+    uint32_t bs = p->super_bloc.block_size;
+    uint8_t *buffer = take_buffer(p);
+    size_t done = 0;
+    ssize_t ret = 0;
+    while (done < length && ret == 0) {
+        off_t pos = offset + (off_t) done;
+        off_t start = pos - pos % bs;
+        size_t skip = (size_t) (pos - start);
+
+        if (skip == 0 && length - done >= bs) {
+            // The whole blocks are copied to the pool and written a buffer at a time
+            size_t span = (length - done) / bs * bs;
+            if (span > p->pool.buffer_size) {
+                span = p->pool.buffer_size;
+            }
+            memcpy(buffer, (const uint8_t*) buf + done, span);
+            if (pwrite(p->fd, buffer, span, start) == -1) {
+                ret = -1;
+            }
+            done += span;
+            continue;
+        }
+
+        // A block written partially keeps the rest of its content
+        size_t n = bs - skip < length - done ? bs - skip : length - done;
+        pthread_mutex_t *lock = p->pool.block_locks + (start / bs) % DIRECT_IO_LOCKS;
+        pthread_mutex_lock(lock);
+        if (pread(p->fd, buffer, bs, start) == -1) {
+            ret = -1;
+        } else {
+            memcpy(buffer + skip, (const uint8_t*) buf + done, n);
+            if (pwrite(p->fd, buffer, bs, start) == -1) {
+                ret = -1;
+            }
+        }
+        pthread_mutex_unlock(lock);
+        done += n;
+    }
+    give_buffer(p, buffer);
+    return ret == -1 ? -1 : (ssize_t) done;
+}
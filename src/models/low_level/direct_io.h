@@ -0,0 +1,62 @@
+/**
+ * @file direct_io.h
+ * @brief This file contains the transfers with the image of a partition, which may be opened with O_DIRECT.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def DIRECT_IO_BUFFERS The number of buffers of the pool.
+ */
+#define DIRECT_IO_BUFFERS 16
+
+/**
+ * @def DIRECT_IO_BUFFER_BLOCKS The number of blocks of a buffer of the pool.
+ */
+#define DIRECT_IO_BUFFER_BLOCKS 16
+
+/**
+ * @brief Switches the image of a partition to direct I/O and allocates the pool of aligned buffers.
+ * @param p The partition, whose superblock is read.
+ * @return 0 if everything went well, -1 otherwise (also when the host refuses direct transfers of a block).
+ */
+int start_direct_io(partition_t *p);
+
+/**
+ * @brief Frees the pool of aligned buffers.
+ * @param p The partition.
+ */
+void stop_direct_io(partition_t *p);
+
+/**
+ * @brief Reads a range of the image, like pread.
+ * @param p The partition.
+ * @param buf Where to store the range.
+ * @param length The length of the range.
+ * @param offset The position of the range in the image.
+ * @return The number of bytes read, -1 if an error occurs.
+ */
+ssize_t read_image(partition_t *p, void *buf, size_t length, off_t offset);
+
+/**
+ * @brief Writes a range of the image, like pwrite.
+ * @param p The partition.
+ * @param buf The content of the range.
+ * @param length The length of the range.
+ * @param offset The position of the range in the image.
+ * @return The number of bytes written, -1 if an error occurs.
+ *
+ * With direct I/O, a block written partially is read, patched and written back under the lock of its stripe. The
+ * blocks written whole do not take it: a block must not be written whole and partially at the same time.
+ */
+ssize_t write_image(partition_t *p, const void *buf, size_t length, off_t offset);
@@ -0,0 +1,20 @@
+/**
+ * @file hash.h
+ * @brief This file contains the hash function used to identify the content of the blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Computes a 64 bits hash of a buffer (XXH64 with a seed of 0).
+ * @param data The buffer to hash.
+ * @param length The length of the buffer.
+ * @return The hash of the buffer.
+ */
+uint64_t hash_block(const void *data, size_t length);
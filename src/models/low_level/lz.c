@@ -0,0 +1,196 @@
+/**
+ * @file lz.c
+ * @brief This file contains the implementation of the codec used to compress the clusters of the compressed files.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <string.h>
+
+#include "lz.h"
+
+/**
+ * @def LZ_HASH_BITS The number of bits of the hash of the match finder (4096 entries).
+ */
+#define LZ_HASH_BITS 12
+
+/**
+ * @def LZ_MIN_MATCH The length of the shortest match.
+ */
+#define LZ_MIN_MATCH 4
+
+/**
+ * @def LZ_LAST_LITERALS The number of bytes at the end of the input always stored as literals.
+ */
+#define LZ_LAST_LITERALS 5
+
+/**
+ * @def LZ_MATCH_LIMIT No match starts in the last LZ_MATCH_LIMIT bytes of the input.
+ */
+#define LZ_MATCH_LIMIT 12
+
+#define LZ_MAX_OFFSET 65535
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief Writes a length continued on extra bytes (255 means that another byte follows).
+ * @return The new position in dst, 0 if dst is too small.
+ */
+static size_t put_length(uint8_t *dst, size_t op, size_t capacity, size_t length) {
+    while (length >= 255) {
+        if (op >= capacity) {
+            return 0;
+        }
+        dst[op++] = 255;
+        length -= 255;
+    }
+    if (op >= capacity) {
+        return 0;
+    }
+    dst[op++] = (uint8_t) length;
+    return op;
+}
+
+/**
+ * @brief Writes a sequence: a token, the literals, then the match (if match_length is not 0).
+ * @return The new position in dst, 0 if dst is too small.
+ */
+static size_t put_sequence(uint8_t *dst, size_t op, size_t capacity, const uint8_t *literals, size_t nb_literals,
+                           size_t offset, size_t match_length) {
+    if (op >= capacity) {
+        return 0;
+    }
+    size_t token = op++;
+    size_t ml = match_length != 0 ? match_length - LZ_MIN_MATCH : 0;
+    dst[token] = (uint8_t) (((nb_literals < 15 ? nb_literals : 15) << 4) | (ml < 15 ? ml : 15));
+
+    if (nb_literals >= 15 && (op = put_length(dst, op, capacity, nb_literals - 15)) == 0) {
+        return 0;
+    }
+    if (op + nb_literals > capacity) {
+        return 0;
+    }
+    memcpy(dst + op, literals, nb_literals);
+    op += nb_literals;
+
+    if (match_length == 0) {
+        return op;
+    }
+    if (op + 2 > capacity) {
+        return 0;
+    }
+    dst[op++] = (uint8_t) (offset & 0xFF);
+    dst[op++] = (uint8_t) (offset >> 8);
+    if (ml >= 15 && (op = put_length(dst, op, capacity, ml - 15)) == 0) {
+        return 0;
+    }
+    return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity) {
+    uint32_t table[1 << LZ_HASH_BITS] = {0};
+    size_t ip = 0;
+    size_t anchor = 0;
+    size_t op = 0;
+
+    if (length > LZ_MATCH_LIMIT) {
+        size_t limit = length - LZ_MATCH_LIMIT;
+        while (ip < limit) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t h = (sequence * 2654435761U) >> (32 - LZ_HASH_BITS);
+            size_t ref = table[h];
+            table[h] = (uint32_t) ip;
+
+            if (ref >= ip || ip - ref > LZ_MAX_OFFSET || read32(src + ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            size_t match_length = LZ_MIN_MATCH;
+            while (ip + match_length < length - LZ_LAST_LITERALS && src[ref + match_length] == src[ip + match_length]) {
+                match_length++;
+            }
+            if ((op = put_sequence(dst, op, capacity, src + anchor, ip - anchor, ip - ref, match_length)) == 0) {
+                return 0;
+            }
+            ip += match_length;
+            anchor = ip;
+        }
+    }
+
+    // The last sequence only holds literals
+    if ((op = put_sequence(dst, op, capacity, src + anchor, length - anchor, 0, 0)) == 0) {
+        return 0;
+    }
+    return op;
+}
+
+int lz_decompress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity) {
+    size_t ip = 0;
+    size_t op = 0;
+
+    while (ip < length) {
+        uint8_t token = src[ip++];
+
+        size_t nb_literals = token >> 4;
+        if (nb_literals == 15) {
+            uint8_t b;
+            do {
+                if (ip >= length) {
+                    return -1;
+                }
+                b = src[ip++];
+                nb_literals += b;
+            } while (b == 255);
+        }
+        if (ip + nb_literals > length || op + nb_literals > capacity) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, nb_literals);
+        ip += nb_literals;
+        op += nb_literals;
+
+        if (ip >= length) {
+            break;
+        }
+
+        if (ip + 2 > length) {
+            return -1;
+        }
+        size_t offset = src[ip] | ((size_t) src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return -1;
+        }
+
+        size_t match_length = token & 0x0F;
+        if (match_length == 15) {
+            uint8_t b;
+            do {
+                if (ip >= length) {
+                    return -1;
+                }
+                b = src[ip++];
+                match_length += b;
+            } while (b == 255);
+        }
+        match_length += LZ_MIN_MATCH;
+        if (op + match_length > capacity) {
+            return -1;
+        }
+
+        // The match may overlap the bytes it produces
+        for (size_t k = 0; k < match_length; k++) {
+            dst[op + k] = dst[op - offset + k];
+        }
+        op += match_length;
+    }
+
+    return (int) op;
+}
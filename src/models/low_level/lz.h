@@ -0,0 +1,32 @@
+/**
+ * @file lz.h
+ * @brief This file contains the codec used to compress the clusters of the compressed files.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Compresses a buffer (LZ77 with the sequence format of LZ4 blocks).
+ * @param src The buffer to compress.
+ * @param length The length of the buffer.
+ * @param dst Where to store the compressed data.
+ * @param capacity The size of dst.
+ * @return The length of the compressed data, 0 if it does not fit in dst.
+ */
+size_t lz_compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity);
+
+/**
+ * @brief Decompresses a buffer compressed with lz_compress.
+ * @param src The compressed data.
+ * @param length The length of the compressed data.
+ * @param dst Where to store the decompressed data.
+ * @param capacity The size of dst.
+ * @return The length of the decompressed data, -1 if the compressed data is corrupted or does not fit in dst.
+ */
+int lz_decompress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity);
@@ -0,0 +1,169 @@
+/**
+ * @file bitmap.c
+ * @brief This file contains the implementation of the operations available on a bitmap loaded chunk by chunk.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "../low_level/direct_io.h"
+#include "bitmap.h"
+#include "lazy_init.h"
+
+extern logger_t *logger;
+
+int init_bitmap(bitmap_t *b, uint32_t start, uint32_t nb_entries, uint32_t block_size, uint32_t *init, uint32_t uninit_flag) {
+    b->start = start;
+    b->nb_entries = nb_entries;
+    b->nb_chunks = DIV_ROUND_UP(nb_entries, block_size);
+    b->init = init;
+    b->uninit_flag = uninit_flag;
+    b->hint = 0;
+    b->chunks = (uint8_t**) calloc(b->nb_chunks, sizeof(uint8_t*));
+    b->dirty = (uint8_t*) calloc(b->nb_chunks, sizeof(uint8_t));
+    if (b->chunks == NULL || b->dirty == NULL) {
+        logger->error("An error occurred when trying to allocate the bitmap.");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns a chunk of the bitmap, reading it from the disk the first time it is touched.
+ * @param p The partition.
+ * @param b The bitmap.
+ * @param k The index of the chunk.
+ * @return The chunk, NULL if an error occurs.
+ */
+static uint8_t* load_chunk(partition_t *p, bitmap_t *b, uint32_t k) {
+    if (b->chunks[k] != NULL) {
+        return b->chunks[k];
+    }
+
+    uint32_t bs = p->super_bloc.block_size;
+    uint8_t *chunk;
+    if (posix_memalign((void**) &chunk, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate a bitmap chunk.");
+        return NULL;
+    }
+
+    // The blocks above the initialization mark may contain garbage: they are read as zeros
+    if (k < *b->init) {
+        if (read_image(p, chunk, bs, (off_t) (b->start + k) * bs) == -1) {
+            logger->error("An error occurred when trying to read a bitmap chunk.");
+            free(chunk);
+            return NULL;
+        }
+    } else {
+        memset(chunk, 0, bs);
+    }
+
+    b->chunks[k] = chunk;
+    return chunk;
+}
+
+int get_bitmap(partition_t *p, bitmap_t *b, uint32_t i) {
+    if (i >= b->nb_entries) {
+        logger->error("You are trying to read an entry beyond the bitmap.");
+        return -1;
+    }
+
+    uint8_t *chunk;
+    if ((chunk = load_chunk(p, b, i / p->super_bloc.block_size)) == NULL) {
+        return -1;
+    }
+    return chunk[i % p->super_bloc.block_size];
+}
+
+int set_bitmap(partition_t *p, bitmap_t *b, uint32_t i, uint8_t value) {
+    if (i >= b->nb_entries) {
+        logger->error("You are trying to update an entry beyond the bitmap.");
+        return -1;
+    }
+
+    uint8_t *chunk;
+    if ((chunk = load_chunk(p, b, i / p->super_bloc.block_size)) == NULL) {
+        return -1;
+    }
+    chunk[i % p->super_bloc.block_size] = value;
+    b->dirty[i / p->super_bloc.block_size] = 1;
+    return 0;
+}
+
+uint32_t find_free_bitmap(partition_t *p, bitmap_t *b) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t first = b->hint < b->nb_entries ? b->hint : 0;
+
+    // Looks from the hint to the end, then from the beginning to the hint
+    for (uint32_t n = 0; n <= b->nb_chunks; n++) {
+        uint32_t k = (first / bs + n) % b->nb_chunks;
+        uint8_t *chunk;
+        if ((chunk = load_chunk(p, b, k)) == NULL) {
+            return b->nb_entries;
+        }
+
+        uint32_t from = (n == 0) ? first % bs : 0;
+        uint32_t to = (k == b->nb_chunks - 1) ? b->nb_entries - k * bs : bs;
+        if (n == b->nb_chunks) {
+            to = first % bs;
+        }
+        if (from >= to) {
+            continue;
+        }
+
+        uint8_t *free_entry = (uint8_t*) memchr(chunk + from, 0, to - from);
+        if (free_entry != NULL) {
+            b->hint = k * bs + (uint32_t) (free_entry - chunk);
+            return b->hint;
+        }
+    }
+    return b->nb_entries;
+}
+
+int flush_bitmap(partition_t *p, bitmap_t *b) {
+    uint32_t bs = p->super_bloc.block_size;
+
+    for (uint32_t k = 0; k < b->nb_chunks; k++) {
+        if (!b->dirty[k]) {
+            continue;
+        }
+
+        // The untouched blocks between the initialization mark and this chunk are zeroed first
+        if (k > *b->init && zero_blocks(p, b->start + *b->init, k - *b->init) == -1) {
+            logger->error("An error occurred when trying to initialize the bitmap.");
+            return -1;
+        }
+
+        if (write_image(p, b->chunks[k], bs, (off_t) (b->start + k) * bs) == -1) {
+            logger->error("An error occurred when trying to write a bitmap chunk.");
+            return -1;
+        }
+        b->dirty[k] = 0;
+
+        if (k >= *b->init && lazy_init_bitmap(p, b, k + 1) == -1) {
+            return -1;
+        }
+    }
+
+    logger->trace("Bitmap flushed.");
+    return 0;
+}
+
+void free_bitmap(bitmap_t *b) {
+    if (b->chunks != NULL) {
+        for (uint32_t k = 0; k < b->nb_chunks; k++) {
+            free(b->chunks[k]);
+        }
+    }
+    free(b->chunks);
+    free(b->dirty);
+    b->chunks = NULL;
+    b->dirty = NULL;
+}
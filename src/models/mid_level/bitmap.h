@@ -0,0 +1,66 @@
+/**
+ * @file bitmap.h
+ * @brief This file contains the operations available on a bitmap loaded chunk by chunk.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Initializes a bitmap without reading anything from the disk.
+ * @param b The bitmap to initialize.
+ * @param start The index of the first block of the bitmap.
+ * @param nb_entries The number of entries of the bitmap.
+ * @param block_size The size of the blocks.
+ * @param init The number of blocks of the bitmap already initialized on disk.
+ * @param uninit_flag The superblock flag set while the bitmap is not entirely initialized.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int init_bitmap(bitmap_t *b, uint32_t start, uint32_t nb_entries, uint32_t block_size, uint32_t *init, uint32_t uninit_flag);
+
+/**
+ * @brief Returns the value of an entry, loading its chunk if needed.
+ * @param p The partition.
+ * @param b The bitmap.
+ * @param i The index of the entry.
+ * @return The value of the entry, -1 if an error occurs.
+ */
+int get_bitmap(partition_t *p, bitmap_t *b, uint32_t i);
+
+/**
+ * @brief Sets the value of an entry, loading its chunk if needed.
+ * @param p The partition.
+ * @param b The bitmap.
+ * @param i The index of the entry.
+ * @param value The new value.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int set_bitmap(partition_t *p, bitmap_t *b, uint32_t i, uint8_t value);
+
+/**
+ * @brief Finds the next entry equal to zero, starting from the hint of the bitmap.
+ * @param p The partition.
+ * @param b The bitmap.
+ * @return The index of the free entry, nb_entries if there is none.
+ */
+uint32_t find_free_bitmap(partition_t *p, bitmap_t *b);
+
+/**
+ * @brief Writes the modified chunks of a bitmap on the disk.
+ * @param p The partition.
+ * @param b The bitmap.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int flush_bitmap(partition_t *p, bitmap_t *b);
+
+/**
+ * @brief Frees the memory used by a bitmap.
+ * @param b The bitmap.
+ */
+void free_bitmap(bitmap_t *b);
@@ -0,0 +1,169 @@
+/**
+ * @file block_queue.c
+ * @brief This file contains the implementation of the queues of data blocks processed by a background task.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "logging/logging.h"
+
+#include "block_queue.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Takes the queued blocks and processes them, the lock of the queue is released in the meantime.
+ * @param q The queue, whose lock is held.
+ */
+static void process_block_queue(block_queue_t *q) {
+    uint32_t *blocks = q->blocks;
+    uint32_t nb_blocks = q->nb_blocks;
+    q->blocks = NULL;
+    q->nb_blocks = 0;
+    q->capacity = 0;
+    q->busy = true;
+    pthread_mutex_unlock(&q->lock);
+
+    int ret = q->handler(q->arg, blocks, nb_blocks);
+    free(blocks);
+
+    pthread_mutex_lock(&q->lock);
+    q->busy = false;
+    if (ret == -1) {
+        q->stop = true;
+        free(q->blocks);
+        q->blocks = NULL;
+        q->nb_blocks = 0;
+        q->capacity = 0;
+    }
+    pthread_cond_broadcast(&q->cond);
+}
+
+/**
+ * @brief The background task processing the queued blocks by batches.
+ * @param arg The queue.
+ * @return NULL.
+ */
+static void* block_queue_task(void *arg) {
+    block_queue_t *q = (block_queue_t*) arg;
+
+    pthread_mutex_lock(&q->lock);
+    while (!q->stop || q->nb_blocks > 0) {
+        if (q->nb_blocks == 0) {
+            pthread_cond_wait(&q->cond, &q->lock);
+            continue;
+        }
+        // A partial batch waits a little for more blocks
+        if (!q->stop && q->nb_blocks < q->batch) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += BLOCK_QUEUE_DELAY_S;
+            if (pthread_cond_timedwait(&q->cond, &q->lock, &deadline) != ETIMEDOUT) {
+                continue;
+            }
+            if (q->nb_blocks == 0) {
+                continue;
+            }
+        }
+        process_block_queue(q);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return NULL;
+}
+
+int start_block_queue(block_queue_t *q, int (*handler)(void*, uint32_t*, uint32_t), void *arg, uint32_t batch,
+                      uint32_t max_blocks) {
+    q->blocks = NULL;
+    q->nb_blocks = 0;
+    q->capacity = 0;
+    q->batch = batch;
+    q->max_blocks = max_blocks;
+    q->handler = handler;
+    q->arg = arg;
+    q->busy = false;
+    q->running = false;
+    q->stop = false;
+    if (pthread_mutex_init(&q->lock, NULL) != 0 || pthread_cond_init(&q->cond, NULL) != 0) {
+        logger->error("An error occurred when trying to create a queue of blocks.");
+        return -1;
+    }
+
+    if (pthread_create(&q->thread, NULL, block_queue_task, q) != 0) {
+        logger->warn("Unable to start the background task of a queue of blocks.");
+        return 0;
+    }
+    q->running = true;
+    return 0;
+}
+
+int push_block_queue(block_queue_t *q, uint32_t i) {
+    if (!q->running) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&q->lock);
+    if (q->stop) {
+        pthread_mutex_unlock(&q->lock);
+        return -1;
+    }
+    if (q->nb_blocks == q->capacity) {
+        uint32_t capacity = q->capacity == 0 ? q->batch : q->capacity * 2;
+        uint32_t *blocks;
+        if (capacity > q->max_blocks || (blocks = (uint32_t*) realloc(q->blocks, capacity * sizeof(uint32_t))) == NULL) {
+            pthread_mutex_unlock(&q->lock);
+            return -1;
+        }
+        q->blocks = blocks;
+        q->capacity = capacity;
+    }
+
+    q->blocks[q->nb_blocks++] = i;
+    if (q->nb_blocks == q->batch || q->nb_blocks == 1) {
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+int flush_block_queue(block_queue_t *q) {
+    if (!q->running) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&q->lock);
+    while (q->busy) {
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    if (q->nb_blocks > 0) {
+        process_block_queue(q);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+int stop_block_queue(block_queue_t *q) {
+    if (q->running) {
+        pthread_mutex_lock(&q->lock);
+        q->stop = true;
+        pthread_cond_broadcast(&q->cond);
+        pthread_mutex_unlock(&q->lock);
+
+        if (pthread_join(q->thread, NULL) != 0) {
+            logger->error("An error occurred when trying to stop the background task of a queue of blocks.");
+            return -1;
+        }
+        q->running = false;
+    }
+
+    free(q->blocks);
+    q->blocks = NULL;
+    q->nb_blocks = 0;
+    pthread_cond_destroy(&q->cond);
+    pthread_mutex_destroy(&q->lock);
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file block_queue.h
+ * @brief This file contains the queues of data blocks processed by a background task.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def BLOCK_QUEUE_DELAY_S The longest time (in seconds) a block waits in a queue before a partial batch is processed.
+ */
+#define BLOCK_QUEUE_DELAY_S 1
+
+/**
+ * @brief Starts the background task of a queue.
+ * @param q The queue.
+ * @param handler Processes a batch of blocks (the array can be reordered), returns -1 to stop the queue.
+ * @param arg The first argument of the handler.
+ * @param batch The number of blocks that wakes the task up.
+ * @param max_blocks The number of blocks the queue can hold.
+ * @return 0 if everything went well, -1 otherwise. The queue refuses every block if its task could not be started.
+ */
+int start_block_queue(block_queue_t *q, int (*handler)(void*, uint32_t*, uint32_t), void *arg, uint32_t batch,
+                      uint32_t max_blocks);
+
+/**
+ * @brief Queues a block.
+ * @param q The queue.
+ * @param i The index of the data block.
+ * @return 0 if the block has been queued, -1 if the queue is full, stopped or not running.
+ */
+int push_block_queue(block_queue_t *q, uint32_t i);
+
+/**
+ * @brief Processes the queued blocks in the calling thread, after the batch the task is processing, if any.
+ * @param q The queue.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int flush_block_queue(block_queue_t *q);
+
+/**
+ * @brief Stops the background task of a queue, after it has processed the blocks still queued.
+ * @param q The queue.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int stop_block_queue(block_queue_t *q);
@@ -0,0 +1,190 @@
+/**
+ * @file cache.c
+ * @brief This file contains the implementation of the operations available on the block cache.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+
+#include "logging/logging.h"
+
+#include "cache.h"
+#include "data.h"
+
+extern logger_t *logger;
+
+int init_cache(partition_t *p) {
+    block_cache_t *c = &p->cache;
+    c->nb_buckets = 2 * BLOCK_CACHE_BLOCKS;
+    c->nb_entries = 0;
+    c->generation = 0;
+    c->lru.lru_prev = &c->lru;
+    c->lru.lru_next = &c->lru;
+    if ((c->buckets = (cache_entry_t**) calloc(c->nb_buckets, sizeof(cache_entry_t*))) == NULL) {
+        logger->error("An error occurred when trying to allocate the block cache.");
+        return -1;
+    }
+    if (pthread_mutex_init(&c->lock, NULL) != 0) {
+        logger->error("An error occurred when trying to create the lock of the block cache.");
+        return -1;
+    }
+    return 0;
+}
+
+static void lru_remove(cache_entry_t *e) {
+    e->lru_prev->lru_next = e->lru_next;
+    e->lru_next->lru_prev = e->lru_prev;
+    e->lru_prev = NULL;
+    e->lru_next = NULL;
+}
+
+static void lru_push(block_cache_t *c, cache_entry_t *e) {
+    e->lru_prev = &c->lru;
+    e->lru_next = c->lru.lru_next;
+    c->lru.lru_next->lru_prev = e;
+    c->lru.lru_next = e;
+}
+
+/**
+ * @brief Takes an entry out of the hash table. The lock of the cache must be held.
+ */
+static void unlink_entry(block_cache_t *c, cache_entry_t *e) {
+    cache_entry_t **link = &c->buckets[e->block % c->nb_buckets];
+    while (*link != e) {
+        link = &(*link)->next;
+    }
+    *link = e->next;
+    c->nb_entries--;
+}
+
+static void free_entry(cache_entry_t *e) {
+    free(e->data);
+    free(e);
+}
+
+static cache_entry_t* lookup(block_cache_t *c, uint32_t i) {
+    cache_entry_t *e = c->buckets[i % c->nb_buckets];
+    while (e != NULL && e->block != i) {
+        e = e->next;
+    }
+    return e;
+}
+
+cache_entry_t* get_cached_block(partition_t *p, uint32_t i) {
+    block_cache_t *c = &p->cache;
+
+    pthread_mutex_lock(&c->lock);
+    cache_entry_t *e = lookup(c, i);
+    if (e != NULL) {
+        if (e->refcount++ == 0) {
+            lru_remove(e);
+        }
+        pthread_mutex_unlock(&c->lock);
+        return e;
+    }
+    uint64_t generation = c->generation;
+    pthread_mutex_unlock(&c->lock);
+
+    // The block is read without the lock, so that a miss does not stall the readers of the other blocks
+    cache_entry_t *loaded = (cache_entry_t*) calloc(1, sizeof(cache_entry_t));
+    uint32_t bs = p->super_bloc.block_size;
+    if (loaded == NULL || posix_memalign((void**) &loaded->data, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(loaded);
+        return NULL;
+    }
+    if (read_data(p, loaded->data, i) == -1) {
+        free_entry(loaded);
+        return NULL;
+    }
+    loaded->block = i;
+    loaded->refcount = 1;
+
+    pthread_mutex_lock(&c->lock);
+    if ((e = lookup(c, i)) != NULL) {
+        if (e->refcount++ == 0) {
+            lru_remove(e);
+        }
+        pthread_mutex_unlock(&c->lock);
+        free_entry(loaded);
+        return e;
+    }
+
+    // A block rewritten during the read may have been read before the write: it is not shared
+    if (generation != c->generation) {
+        loaded->detached = true;
+        pthread_mutex_unlock(&c->lock);
+        return loaded;
+    }
+
+    cache_entry_t **bucket = &c->buckets[i % c->nb_buckets];
+    loaded->next = *bucket;
+    *bucket = loaded;
+    c->nb_entries++;
+
+    // The least recently used blocks that nobody uses are evicted
+    while (c->nb_entries > BLOCK_CACHE_BLOCKS && c->lru.lru_prev != &c->lru) {
+        cache_entry_t *victim = c->lru.lru_prev;
+        lru_remove(victim);
+        unlink_entry(c, victim);
+        free_entry(victim);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return loaded;
+}
+
+void put_cached_block(partition_t *p, cache_entry_t *entry) {
+    block_cache_t *c = &p->cache;
+
+    pthread_mutex_lock(&c->lock);
+    if (--entry->refcount == 0) {
+        if (entry->detached) {
+            free_entry(entry);
+        } else {
+            lru_push(c, entry);
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+void invalidate_cached_block(partition_t *p, uint32_t i) {
+    block_cache_t *c = &p->cache;
+    if (c->buckets == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&c->lock);
+    c->generation++;
+    cache_entry_t *e = lookup(c, i);
+    if (e != NULL) {
+        unlink_entry(c, e);
+        if (e->refcount == 0) {
+            lru_remove(e);
+            free_entry(e);
+        } else {
+            e->detached = true;
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+void free_cache(partition_t *p) {
+    block_cache_t *c = &p->cache;
+    if (c->buckets == NULL) {
+        return;
+    }
+
+    for (uint32_t b = 0; b < c->nb_buckets; b++) {
+        cache_entry_t *e = c->buckets[b];
+        while (e != NULL) {
+            cache_entry_t *next = e->next;
+            free_entry(e);
+            e = next;
+        }
+    }
+    free(c->buckets);
+    c->buckets = NULL;
+    pthread_mutex_destroy(&c->lock);
+}
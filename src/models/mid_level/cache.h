@@ -0,0 +1,51 @@
+/**
+ * @file cache.h
+ * @brief This file contains the operations available on the block cache.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Prepares an empty block cache.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int init_cache(partition_t *p);
+
+/**
+ * @brief Returns a data block from the cache, reading (and verifying) it on a miss. The block stays valid until it is
+ * released, even if it is rewritten meanwhile.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @return The entry of the block, NULL if an error occurs.
+ */
+cache_entry_t* get_cached_block(partition_t *p, uint32_t i);
+
+/**
+ * @brief Releases a block returned by get_cached_block.
+ * @param p The partition.
+ * @param entry The entry of the block.
+ */
+void put_cached_block(partition_t *p, cache_entry_t *entry);
+
+/**
+ * @brief Drops a data block from the cache because its content changed.
+ * @param p The partition.
+ * @param i The index of the data block.
+ */
+void invalidate_cached_block(partition_t *p, uint32_t i);
+
+/**
+ * @brief Frees the block cache (the blocks must have been released).
+ * @param p The partition.
+ */
+void free_cache(partition_t *p);
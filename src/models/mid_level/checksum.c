@@ -0,0 +1,156 @@
+/**
+ * @file checksum.c
+ * @brief This file contains the implementation of the operations available on the checksums of the data blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "../low_level/crc32c.h"
+#include "../low_level/direct_io.h"
+#include "checksum.h"
+
+extern logger_t *logger;
+
+int create_checksums(partition_t *p) {
+    if (zero_blocks(p, p->super_bloc.checksum_start, p->super_bloc.checksum_blocks) == -1) {
+        logger->error("An error occurred when trying to create the checksum region.");
+        return -1;
+    }
+
+    logger->info("Checksums created");
+    return 0;
+}
+
+int read_checksums(partition_t *p) {
+    checksums_t *c = &p->checksums;
+    c->nb_blocks = p->super_bloc.checksum_blocks;
+    c->blocks = (uint32_t**) calloc(c->nb_blocks, sizeof(uint32_t*));
+    c->dirty = (uint8_t*) calloc(c->nb_blocks, sizeof(uint8_t));
+    if (c->nb_blocks > 0 && (c->blocks == NULL || c->dirty == NULL)) {
+        logger->error("An error occurred when trying to allocate the checksums.");
+        return -1;
+    }
+
+    logger->trace("Checksums read");
+    return 0;
+}
+
+/**
+ * @brief Returns the block of the checksum region holding the checksum of a data block, reading it when first touched.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @return The block of checksums, NULL if an error occurs.
+ *
+ * Concurrent callers may both read the block, only one of them installs it.
+ */
+static uint32_t* load_checksums(partition_t *p, uint32_t i) {
+    checksums_t *c = &p->checksums;
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t k = i / (bs / sizeof(uint32_t));
+    if (k >= c->nb_blocks) {
+        logger->error("You are trying to access a checksum beyond the checksum region.");
+        return NULL;
+    }
+
+    uint32_t *block = __atomic_load_n(&c->blocks[k], __ATOMIC_ACQUIRE);
+    if (block != NULL) {
+        return block;
+    }
+
+    if (posix_memalign((void**) &block, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return NULL;
+    }
+    if (read_image(p, block, bs, ((off_t) p->super_bloc.checksum_start + k) * bs) == -1) {
+        logger->error("An error occurred when trying to read the checksums.");
+        free(block);
+        return NULL;
+    }
+
+    uint32_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&c->blocks[k], &expected, block, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(block);
+        return expected;
+    }
+    return block;
+}
+
+int set_checksum(partition_t *p, uint32_t i, const uint8_t *data) {
+    if (!(p->super_bloc.flags & FS_FEATURE_CHECKSUM)) {
+        return 0;
+    }
+
+    uint32_t *block;
+    if ((block = load_checksums(p, i)) == NULL) {
+        return -1;
+    }
+    uint32_t per_block = p->super_bloc.block_size / sizeof(uint32_t);
+    __atomic_store_n(&block[i % per_block], crc32c(data, p->super_bloc.block_size), __ATOMIC_RELAXED);
+    __atomic_store_n(&p->checksums.dirty[i / per_block], 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int verify_checksum(partition_t *p, uint32_t i, const uint8_t *data) {
+    if (!(p->super_bloc.flags & FS_FEATURE_CHECKSUM)) {
+        return 0;
+    }
+
+    uint32_t *block;
+    if ((block = load_checksums(p, i)) == NULL) {
+        return -1;
+    }
+    uint32_t per_block = p->super_bloc.block_size / sizeof(uint32_t);
+    if (__atomic_load_n(&block[i % per_block], __ATOMIC_RELAXED) != crc32c(data, p->super_bloc.block_size)) {
+        char log_buf[128];
+        sprintf(log_buf, "The data block %u is corrupted (checksum mismatch).", i);
+        logger->error(log_buf);
+        return -1;
+    }
+    return 0;
+}
+
+int update_checksums(partition_t *p) {
+    checksums_t *c = &p->checksums;
+    uint32_t bs = p->super_bloc.block_size;
+
+    for (uint32_t k = 0; k < c->nb_blocks; k++) {
+        // The flag is cleared first, so that a checksum set during the write is written by the next flush
+        if (!__atomic_exchange_n(&c->dirty[k], 0, __ATOMIC_ACQ_REL)) {
+            continue;
+        }
+        if (write_image(p, c->blocks[k], bs, ((off_t) p->super_bloc.checksum_start + k) * bs) == -1) {
+            c->dirty[k] = 1;
+            logger->error("An error occurred when trying to write the checksums.");
+            return -1;
+        }
+    }
+
+    logger->trace("Checksums updated");
+    return 0;
+}
+
+void free_checksums(partition_t *p) {
+    checksums_t *c = &p->checksums;
+    if (c->blocks != NULL) {
+        for (uint32_t k = 0; k < c->nb_blocks; k++) {
+            free(c->blocks[k]);
+        }
+    }
+    free(c->blocks);
+    free(c->dirty);
+    c->blocks = NULL;
+    c->dirty = NULL;
+}
+
+uint32_t inode_checksum(inode_t inode) {
+    inode.checksum = 0;
+    return crc32c(&inode, sizeof(inode_t));
+}
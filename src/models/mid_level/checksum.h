@@ -0,0 +1,67 @@
+/**
+ * @file checksum.h
+ * @brief This file contains the operations available on the checksums of the data blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Creates an empty checksum region on disk.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int create_checksums(partition_t *p);
+
+/**
+ * @brief Prepares the checksums in memory, their blocks are read from the disk when first touched.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int read_checksums(partition_t *p);
+
+/**
+ * @brief Records the checksum of the content of a data block.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @param data The content of the data block (block_size bytes).
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int set_checksum(partition_t *p, uint32_t i, const uint8_t *data);
+
+/**
+ * @brief Verifies the content of a data block against its checksum.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @param data The content of the data block (block_size bytes).
+ * @return 0 if the content is intact, -1 otherwise.
+ */
+int verify_checksum(partition_t *p, uint32_t i, const uint8_t *data);
+
+/**
+ * @brief Writes the modified checksums on the disk.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int update_checksums(partition_t *p);
+
+/**
+ * @brief Frees the checksums loaded in memory.
+ * @param p The partition.
+ */
+void free_checksums(partition_t *p);
+
+/**
+ * @brief Computes the checksum of an inode.
+ * @param inode The inode.
+ * @return The CRC32C of the inode, computed with its checksum field set to 0.
+ */
+uint32_t inode_checksum(inode_t inode);
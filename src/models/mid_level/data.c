@@ -6,59 +6,433 @@
  * @date 03-31-2024
  */
 
-#include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "logging/logging.h"
 
+#include "../low_level/direct_io.h"
+#include "bitmap.h"
+#include "cache.h"
+#include "checksum.h"
 #include "data.h"
+#include "data_bitmap.h"
+#include "discard.h"
+#include "group.h"
+#include "reclaim.h"
 
-logger_t  *logger;
+extern logger_t *logger;
 
 off_t get_data_offset(partition_t *p, uint32_t i) {
-    double block_size = p->super_bloc.block_size;
-    double nb_data = p->super_bloc.nb_data;
-    double nb_inodes = p->super_bloc.nb_inodes;
-    return (off_t) (1 + ceil(nb_data / block_size) + ceil(nb_inodes / block_size) + ceil((nb_inodes * sizeof(inode_t)) / block_size) + i) * block_size;
+    uint32_t g = data_group(p, i);
+    return ((off_t) p->gdt[g].data_start + i % p->super_bloc.data_per_group) * p->super_bloc.block_size;
+}
+
+/**
+ * @brief Marks a free data block of a group as used. The lock of the group must be held.
+ * @param p The partition to use.
+ * @param g The index of the group.
+ * @param j The index of the data block in the group.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int take_data(partition_t *p, uint32_t g, uint32_t j) {
+    group_t *group = p->groups + g;
+    if (set_bitmap(p, &group->data_bitmap, j, 1) == -1) {
+        return -1;
+    }
+    group->desc->nb_data_free--;
+    group->dirty = true;
+    __atomic_sub_fetch(&p->super_bloc.nb_data_free, 1, __ATOMIC_RELAXED);
+    return 0;
 }
 
 int create_data(partition_t *p, uint32_t i) {
-    if (i > p->super_bloc.nb_data) {
+    if (i >= p->super_bloc.nb_data) {
         logger->error("You are trying to create data beyond the accepted range.");
         return -1;
     }
 
-    if (p->data_bitmap[i] == 1) {
-        logger->error("You are trying to create data that already exists.");
+    uint32_t g = data_group(p, i);
+    pthread_mutex_lock(&p->groups[g].lock);
+    int used = get_bitmap(p, &p->groups[g].data_bitmap, i % p->super_bloc.data_per_group);
+    if (used != 0) {
+        pthread_mutex_unlock(&p->groups[g].lock);
+        if (used > 0) {
+            logger->error("You are trying to create data that already exists.");
+        }
+        return -1;
+    }
+    int ret = take_data(p, g, i % p->super_bloc.data_per_group);
+    pthread_mutex_unlock(&p->groups[g].lock);
+    if (ret == -1) {
         return -1;
     }
-
-    p->data_bitmap[i] = 1;
-    p->super_bloc.nb_data_free--;
 
     logger->trace("Data created.");
     return 0;
 }
 
+/**
+ * @brief Takes a free data block, in the preferred group if possible.
+ * @param p The partition to use.
+ * @param goal The preferred group.
+ * @return The index of the data block, 0 if there is no free block.
+ */
+static uint32_t find_data(partition_t *p, uint32_t goal) {
+    // Looks in the preferred group first, then in the following ones
+    for (uint32_t n = 0; n < p->super_bloc.nb_groups; n++) {
+        uint32_t g = (goal + n) % p->super_bloc.nb_groups;
+        group_t *group = p->groups + g;
+        if (__atomic_load_n(&group->desc->nb_data_free, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&group->lock);
+        uint32_t j = group->desc->nb_data_free > 0 ? find_free_bitmap(p, &group->data_bitmap) : group->desc->nb_data;
+        int ret = j < group->desc->nb_data ? take_data(p, g, j) : -1;
+        pthread_mutex_unlock(&group->lock);
+        if (ret == 0) {
+            logger->trace("Data allocated.");
+            return g * p->super_bloc.data_per_group + j;
+        }
+    }
+    return 0;
+}
+
+uint32_t allocate_data(partition_t *p, uint32_t goal) {
+    uint32_t i = find_data(p, goal);
+    // The blocks waiting for the reclaimer are freed before giving up
+    if (i == 0 && flush_reclaim(p) == 0) {
+        i = find_data(p, goal);
+    }
+    if (i == 0) {
+        logger->warn("No more free data");
+    }
+    return i;
+}
+
+/**
+ * @brief Takes a run of free data blocks, in the preferred group if possible.
+ * @param p The partition to use.
+ * @param goal The preferred group.
+ * @param wanted The number of blocks wanted.
+ * @param count The number of blocks taken.
+ * @return The index of the first data block, 0 if there is no free block.
+ */
+static uint32_t find_data_run(partition_t *p, uint32_t goal, uint32_t wanted, uint32_t *count) {
+    *count = 0;
+    for (uint32_t n = 0; n < p->super_bloc.nb_groups; n++) {
+        uint32_t g = (goal + n) % p->super_bloc.nb_groups;
+        group_t *group = p->groups + g;
+        if (__atomic_load_n(&group->desc->nb_data_free, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&group->lock);
+        uint32_t j = group->desc->nb_data_free > 0 ? find_free_bitmap(p, &group->data_bitmap) : group->desc->nb_data;
+        if (j >= group->desc->nb_data) {
+            pthread_mutex_unlock(&group->lock);
+            continue;
+        }
+
+        // The window is the run of free blocks starting at the first free one, up to the wanted size
+        uint32_t k = 0;
+        while (k < wanted && j + k < group->desc->nb_data && get_bitmap(p, &group->data_bitmap, j + k) == 0) {
+            if (set_bitmap(p, &group->data_bitmap, j + k, 1) == -1) {
+                break;
+            }
+            k++;
+        }
+        group->desc->nb_data_free -= k;
+        group->dirty = true;
+        group->data_bitmap.hint = j + k;
+        pthread_mutex_unlock(&group->lock);
+        __atomic_sub_fetch(&p->super_bloc.nb_data_free, k, __ATOMIC_RELAXED);
+
+        if (k > 0) {
+            *count = k;
+            logger->trace("Data reserved.");
+            return g * p->super_bloc.data_per_group + j;
+        }
+    }
+    return 0;
+}
+
+uint32_t reserve_data(partition_t *p, uint32_t goal, uint32_t wanted, uint32_t *count) {
+    uint32_t i = find_data_run(p, goal, wanted, count);
+    if (*count == 0 && flush_reclaim(p) == 0) {
+        i = find_data_run(p, goal, wanted, count);
+    }
+    if (*count == 0) {
+        logger->warn("No more free data");
+    }
+    return i;
+}
+
+/**
+ * @brief Takes a run of exactly count free data blocks, in the preferred group if possible.
+ * @param p The partition to use.
+ * @param goal The preferred group.
+ * @param count The number of blocks.
+ * @return The index of the first data block, 0 if no group has such a run.
+ */
+static uint32_t find_data_extent(partition_t *p, uint32_t goal, uint32_t count) {
+    for (uint32_t n = 0; n < p->super_bloc.nb_groups; n++) {
+        uint32_t g = (goal + n) % p->super_bloc.nb_groups;
+        group_t *group = p->groups + g;
+        if (__atomic_load_n(&group->desc->nb_data_free, __ATOMIC_RELAXED) < count) {
+            continue;
+        }
+
+        // First fit: the run restarts after each used block
+        pthread_mutex_lock(&group->lock);
+        uint32_t start = 0;
+        uint32_t length = 0;
+        for (uint32_t j = 0; j < group->desc->nb_data && length < count; j++) {
+            if (get_bitmap(p, &group->data_bitmap, j) == 0) {
+                start = length == 0 ? j : start;
+                length++;
+            } else {
+                length = 0;
+            }
+        }
+        if (length < count) {
+            pthread_mutex_unlock(&group->lock);
+            continue;
+        }
+
+        uint32_t k = 0;
+        while (k < count && set_bitmap(p, &group->data_bitmap, start + k, 1) == 0) {
+            k++;
+        }
+        group->desc->nb_data_free -= k;
+        group->dirty = true;
+        pthread_mutex_unlock(&group->lock);
+        __atomic_sub_fetch(&p->super_bloc.nb_data_free, k, __ATOMIC_RELAXED);
+        if (k < count) {
+            release_data(p, g * p->super_bloc.data_per_group + start, k);
+            return 0;
+        }
+        return g * p->super_bloc.data_per_group + start;
+    }
+    return 0;
+}
+
+uint32_t reserve_data_extent(partition_t *p, uint32_t goal, uint32_t count) {
+    if (count == 0 || count > p->super_bloc.data_per_group) {
+        return 0;
+    }
+    uint32_t i = find_data_extent(p, goal, count);
+    if (i == 0 && flush_reclaim(p) == 0) {
+        i = find_data_extent(p, goal, count);
+    }
+    if (i != 0) {
+        logger->trace("Data reserved.");
+    }
+    return i;
+}
+
+int release_data(partition_t *p, uint32_t i, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    if (i + count > p->super_bloc.nb_data || data_group(p, i) != data_group(p, i + count - 1)) {
+        logger->error("You are trying to release data beyond the reserved range.");
+        return -1;
+    }
+
+    uint32_t g = data_group(p, i);
+    group_t *group = p->groups + g;
+    pthread_mutex_lock(&group->lock);
+    for (uint32_t k = 0; k < count; k++) {
+        if (set_bitmap(p, &group->data_bitmap, (i + k) % p->super_bloc.data_per_group, 0) == -1) {
+            pthread_mutex_unlock(&group->lock);
+            return -1;
+        }
+    }
+    group->desc->nb_data_free += count;
+    group->dirty = true;
+    pthread_mutex_unlock(&group->lock);
+    __atomic_add_fetch(&p->super_bloc.nb_data_free, count, __ATOMIC_RELAXED);
+
+    logger->trace("Data released.");
+    return 0;
+}
+
+/**
+ * @brief Locks the group of a data block and returns its bitmap entry.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return The bitmap entry (the group is left locked), -1 if an error occurs (the group is unlocked).
+ */
+static int lock_data_entry(partition_t *p, uint32_t i) {
+    if (i >= p->super_bloc.nb_data) {
+        logger->error("You are trying to reference data beyond the accepted range.");
+        return -1;
+    }
+
+    group_t *group = p->groups + data_group(p, i);
+    pthread_mutex_lock(&group->lock);
+    int entry = get_bitmap(p, &group->data_bitmap, i % p->super_bloc.data_per_group);
+    if (entry <= 0) {
+        pthread_mutex_unlock(&group->lock);
+        logger->error("You are trying to reference data that does not exists.");
+        return -1;
+    }
+    return entry;
+}
+
+/**
+ * @brief Writes the bitmap entry of a data block and unlocks its group.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @param entry The new bitmap entry.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int unlock_data_entry(partition_t *p, uint32_t i, int entry) {
+    group_t *group = p->groups + data_group(p, i);
+    int ret = set_bitmap(p, &group->data_bitmap, i % p->super_bloc.data_per_group, entry);
+    if (ret == 0 && entry == 0) {
+        group->desc->nb_data_free++;
+        group->dirty = true;
+        __atomic_add_fetch(&p->super_bloc.nb_data_free, 1, __ATOMIC_RELAXED);
+        queue_discard(p, i);
+    }
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+int ref_data(partition_t *p, uint32_t i) {
+    int entry;
+    if ((entry = lock_data_entry(p, i)) == -1) {
+        return -1;
+    }
+    if ((entry & DATA_REFCOUNT_MASK) == DATA_REFCOUNT_MASK) {
+        pthread_mutex_unlock(&p->groups[data_group(p, i)].lock);
+        return -1;
+    }
+    return unlock_data_entry(p, i, entry + 1);
+}
+
+int ref_indexed_data(partition_t *p, uint32_t i) {
+    int entry;
+    if ((entry = lock_data_entry(p, i)) == -1) {
+        return -1;
+    }
+    // The block may have been rewritten in place since it was indexed
+    if (!(entry & DATA_INDEXED) || (entry & DATA_REFCOUNT_MASK) == DATA_REFCOUNT_MASK) {
+        pthread_mutex_unlock(&p->groups[data_group(p, i)].lock);
+        return -1;
+    }
+    return unlock_data_entry(p, i, entry + 1);
+}
+
+int unref_data(partition_t *p, uint32_t i) {
+    int entry;
+    if ((entry = lock_data_entry(p, i)) == -1) {
+        return -1;
+    }
+    // The last reference frees the block, and takes it out of the index
+    return unlock_data_entry(p, i, (entry & DATA_REFCOUNT_MASK) == 1 ? 0 : entry - 1);
+}
+
+static int compare_data(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+int unref_data_batch(partition_t *p, uint32_t *blocks, uint32_t nb_blocks) {
+    qsort(blocks, nb_blocks, sizeof(uint32_t), compare_data);
+
+    int ret = 0;
+    uint32_t first = 0;
+    while (first < nb_blocks && blocks[first] < p->super_bloc.nb_data) {
+        uint32_t g = data_group(p, blocks[first]);
+        group_t *group = p->groups + g;
+        uint32_t freed = 0;
+
+        // The blocks of a group are dropped under a single lock, and its counters are updated once
+        pthread_mutex_lock(&group->lock);
+        for (; first < nb_blocks && blocks[first] < p->super_bloc.nb_data && data_group(p, blocks[first]) == g; first++) {
+            uint32_t j = blocks[first] % p->super_bloc.data_per_group;
+            int entry = get_bitmap(p, &group->data_bitmap, j);
+            if (entry <= 0) {
+                ret = -1;
+                continue;
+            }
+            entry = (entry & DATA_REFCOUNT_MASK) == 1 ? 0 : entry - 1;
+            if (set_bitmap(p, &group->data_bitmap, j, entry) == -1) {
+                ret = -1;
+                continue;
+            }
+            if (entry == 0) {
+                freed++;
+                queue_discard(p, blocks[first]);
+            }
+        }
+        if (freed > 0) {
+            group->desc->nb_data_free += freed;
+            group->dirty = true;
+        }
+        pthread_mutex_unlock(&group->lock);
+        __atomic_add_fetch(&p->super_bloc.nb_data_free, freed, __ATOMIC_RELAXED);
+    }
+
+    if (ret == -1 || first < nb_blocks) {
+        logger->error("You are trying to release data that does not exists.");
+        return -1;
+    }
+    logger->trace("Data released.");
+    return 0;
+}
+
+int count_data_refs(partition_t *p, uint32_t i) {
+    int entry;
+    if ((entry = lock_data_entry(p, i)) == -1) {
+        return -1;
+    }
+    pthread_mutex_unlock(&p->groups[data_group(p, i)].lock);
+    return entry & DATA_REFCOUNT_MASK;
+}
+
+int own_data(partition_t *p, uint32_t i) {
+    int entry;
+    if ((entry = lock_data_entry(p, i)) == -1) {
+        return -1;
+    }
+    if ((entry & DATA_REFCOUNT_MASK) > 1) {
+        pthread_mutex_unlock(&p->groups[data_group(p, i)].lock);
+        return 0;
+    }
+    return unlock_data_entry(p, i, entry & ~DATA_INDEXED) == -1 ? -1 : 1;
+}
+
+int mark_data_indexed(partition_t *p, uint32_t i) {
+    int entry;
+    if ((entry = lock_data_entry(p, i)) == -1) {
+        return -1;
+    }
+    return unlock_data_entry(p, i, entry | DATA_INDEXED);
+}
+
 int read_data(partition_t *p, uint8_t *data, uint32_t i) {
-    if (i > p->super_bloc.nb_data) {
+    if (i >= p->super_bloc.nb_data) {
         logger->error("You are trying to read data beyond the accepted range.");
         return -1;
     }
 
-    if (p->data_bitmap[i] == 0) {
+    if (get_databitmap(p, i) <= 0) {
         logger->error("You are trying to read data that does not exists.");
         return -1;
     }
 
-    off_t data_pos = get_data_offset(p, i);
-    if (lseek(p->fd, data_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+    if (read_image(p, data, p->super_bloc.block_size, get_data_offset(p, i)) == -1) {
+        logger->error("An error occurred when trying to read data.");
         return -1;
     }
-    if (read(p->fd, data, p->super_bloc.block_size) == -1) {
-        logger->error("An error occurred when trying to read data.");
+    if (verify_checksum(p, i, data) == -1) {
         return -1;
     }
 
@@ -67,43 +441,53 @@ int read_data(partition_t *p, uint8_t *data, uint32_t i) {
 }
 
 int update_data(partition_t *p, const uint8_t *data, uint32_t i) {
-    if (i > p->super_bloc.nb_data) {
+    if (i >= p->super_bloc.nb_data) {
         logger->error("You are trying to update data beyond the accepted range.");
         return -1;
     }
 
-    if (p->data_bitmap[i] == 0) {
+    if (get_databitmap(p, i) <= 0) {
         logger->error("You are trying to update data that does not exists.");
         return -1;
     }
 
-    off_t data_pos = get_data_offset(p, i);
-    if (lseek(p->fd, data_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+    if (write_image(p, data, p->super_bloc.block_size, get_data_offset(p, i)) == -1) {
+        logger->error("An error occurred when trying to update data.");
         return -1;
     }
-    if (write(p->fd, data, p->super_bloc.block_size) == -1) {
-        logger->error("An error occurred when trying to update data.");
+    if (set_checksum(p, i, data) == -1) {
         return -1;
     }
+    invalidate_cached_block(p, i);
 
     logger->trace("Data updated.");
     return 0;
 }
 
 int delete_data(partition_t *p, uint32_t i) {
-    if (i > p->super_bloc.nb_data) {
+    if (i >= p->super_bloc.nb_data) {
         logger->error("You are trying to delete data beyond the accepted range.");
         return -1;
     }
 
-    if (p->data_bitmap[i] == 0) {
+    uint32_t g = data_group(p, i);
+    group_t *group = p->groups + g;
+    pthread_mutex_lock(&group->lock);
+    if (get_bitmap(p, &group->data_bitmap, i % p->super_bloc.data_per_group) <= 0) {
+        pthread_mutex_unlock(&group->lock);
         logger->error("You are trying to delete data that does not exists.");
         return -1;
     }
 
-    p->data_bitmap[i] = 0;
-    p->super_bloc.nb_data_free++;
+    if (set_bitmap(p, &group->data_bitmap, i % p->super_bloc.data_per_group, 0) == -1) {
+        pthread_mutex_unlock(&group->lock);
+        return -1;
+    }
+    group->desc->nb_data_free++;
+    group->dirty = true;
+    queue_discard(p, i);
+    pthread_mutex_unlock(&group->lock);
+    __atomic_add_fetch(&p->super_bloc.nb_data_free, 1, __ATOMIC_RELAXED);
 
     logger->trace("Data deleted.");
     return 0;
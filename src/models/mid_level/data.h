@@ -14,6 +14,12 @@
 
 #include "../../ufs.priv.h"
 
+/**
+ * @brief Returns the position of a data block in the partition.
+ * @param p The partition to use.
+ * @param i The index of the data block.
+ * @return The offset (in bytes) of the data block.
+ */
 off_t get_data_offset(partition_t *p, uint32_t i);
 
 /**
@@ -24,6 +30,99 @@ off_t get_data_offset(partition_t *p, uint32_t i);
  */
 int create_data(partition_t *p, uint32_t i);
 
+/**
+ * @brief Finds a free data block and marks it as used, preferably in the given block group.
+ * @param p The partition to use.
+ * @param goal The index of the preferred group (usually the group of the inode).
+ * @return The index of the allocated data, 0 if there is no more free data.
+ */
+uint32_t allocate_data(partition_t *p, uint32_t goal);
+
+/**
+ * @brief Marks a run of contiguous free data blocks as used in one step, preferably in the given block group.
+ * @param p The partition to use.
+ * @param goal The index of the preferred group (usually the group of the inode).
+ * @param wanted The maximum number of blocks to reserve.
+ * @param count Where to store the number of blocks actually reserved.
+ * @return The index of the first reserved data, 0 if there is no more free data.
+ */
+uint32_t reserve_data(partition_t *p, uint32_t goal, uint32_t wanted, uint32_t *count);
+
+/**
+ * @brief Marks a run of exactly count contiguous free data blocks as used, preferably in the given block group.
+ * @param p The partition to use.
+ * @param goal The index of the preferred group.
+ * @param count The number of blocks of the run.
+ * @return The index of the first data of the run, 0 if no group has a free run that long.
+ */
+uint32_t reserve_data_extent(partition_t *p, uint32_t goal, uint32_t count);
+
+/**
+ * @brief Gives back the unused part of a reservation.
+ * @param p The partition to use.
+ * @param i The index of the first data to release.
+ * @param count The number of data to release.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int release_data(partition_t *p, uint32_t i, uint32_t count);
+
+/**
+ * @brief Adds a reference to a used data block shared by several owners (the low bits of its bitmap entry are its reference count).
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return 0 if everything went well, -1 otherwise (or if the reference count is saturated).
+ */
+int ref_data(partition_t *p, uint32_t i);
+
+/**
+ * @brief Adds a reference to a data block found in the deduplication index, if it is still indexed.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return 0 if everything went well, -1 otherwise (or if the block can not be shared anymore).
+ */
+int ref_indexed_data(partition_t *p, uint32_t i);
+
+/**
+ * @brief Drops a reference to a data block, the block is freed when its last reference is dropped.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int unref_data(partition_t *p, uint32_t i);
+
+/**
+ * @brief Drops a reference to each block of a list, updating the free counters of each group once.
+ * @param p The partition to use.
+ * @param blocks The data blocks (the array is sorted), a block can appear as many times as it has references dropped.
+ * @param nb_blocks The number of blocks.
+ * @return 0 if everything went well, -1 if a block was not referenced (the other ones are still dropped).
+ */
+int unref_data_batch(partition_t *p, uint32_t *blocks, uint32_t nb_blocks);
+
+/**
+ * @brief Returns the number of references to a data block.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return The number of references, -1 if the block is free or an error occurs.
+ */
+int count_data_refs(partition_t *p, uint32_t i);
+
+/**
+ * @brief Checks that a data block can be written in place, and takes it out of the deduplication index if so.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return 1 if the block has a single owner, 0 if it is shared (and must be copied), -1 if an error occurs.
+ */
+int own_data(partition_t *p, uint32_t i);
+
+/**
+ * @brief Marks a data block as present in the deduplication index, so that it can be shared.
+ * @param p The partition to use.
+ * @param i The index of the data.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int mark_data_indexed(partition_t *p, uint32_t i);
+
 /**
  * @brief Reads data located at the specified index.
  * @param p The partition to use.
@@ -6,35 +6,26 @@
  * @date 03-29-2024
  */
 
-#include <stdlib.h>
-#include <string.h>
-#include <math.h>
-#include <unistd.h>
 #include "logging/logging.h"
 
+#include "../low_level/block.h"
+#include "bitmap.h"
 #include "data_bitmap.h"
-
+#include "group.h"
 
 extern logger_t *logger;
 
 int create_databitmap(partition_t *p){
-    off_t bitmap_pos = (int) p->super_bloc.block_size;
-
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-
-    p->data_bitmap = (uint8_t*) malloc(p->super_bloc.nb_data * sizeof(uint8_t));
-    memset(p->data_bitmap, 0, p->super_bloc.nb_data);
-    if (p->data_bitmap == NULL){
-        logger->error("An error occurred when trying to allocate your bitmap");
-        return -1;
-    }
-
-    if (write(p->fd, p->data_bitmap, p->super_bloc.nb_data) == -1){
-        logger->error("An error occurred when trying to create the data bitmap.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_desc_t *gd = p->gdt + g;
+        uint32_t bitmap_blocks = gd->inode_bitmap_start - gd->data_bitmap_start;
+
+        if (zero_blocks_fast(p, gd->data_bitmap_start, bitmap_blocks) == 0) {
+            gd->data_bitmap_init = bitmap_blocks;
+        } else {
+            gd->flags |= BG_DATA_BITMAP_UNINIT;
+            gd->data_bitmap_init = 0;
+        }
     }
 
     logger->info("Data bitmap created");
@@ -42,15 +33,15 @@ int create_databitmap(partition_t *p){
 }
 
 int read_databitmap(partition_t *p){
-    off_t bitmap_pos = (int) p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-
-    if (read(p->fd, p->data_bitmap, p->super_bloc. nb_data) == -1) {
-        logger->error("An error occurred when trying to read the data bitmap.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_t *group = p->groups + g;
+        if (init_bitmap(&group->data_bitmap, group->desc->data_bitmap_start, group->desc->nb_data, p->super_bloc.block_size,
+                        &group->desc->data_bitmap_init, BG_DATA_BITMAP_UNINIT) == -1) {
+            logger->error("An error occurred when trying to read the data bitmap.");
+            return -1;
+        }
+        group->data_bitmap.group = g;
+        group->data_bitmap.flags = &group->desc->flags;
     }
 
     logger->trace("Data bitmap read");
@@ -58,15 +49,14 @@ int read_databitmap(partition_t *p){
 }
 
 int update_databitmap(partition_t *p){
-    off_t bitmap_pos = (int) p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-
-    if (write(p->fd, p->data_bitmap, p->super_bloc.nb_data) == -1) {
-        logger->error("An error occurred when trying to update the data bitmap.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        pthread_mutex_lock(&p->groups[g].lock);
+        int ret = flush_bitmap(p, &p->groups[g].data_bitmap);
+        pthread_mutex_unlock(&p->groups[g].lock);
+        if (ret == -1) {
+            logger->error("An error occurred when trying to update the data bitmap.");
+            return -1;
+        }
     }
 
     logger->trace("Data bitmap update");
@@ -75,22 +65,30 @@ int update_databitmap(partition_t *p){
 }
 
 int delete_databitmap(partition_t *p){
-    off_t bitmap_pos = (int) p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_desc_t *gd = p->gdt + g;
+        if (zero_blocks(p, gd->data_bitmap_start, gd->inode_bitmap_start - gd->data_bitmap_start) == -1) {
+            logger->error("An error occurred when trying to delete the data bitmap.");
+            return -1;
+        }
+        free_bitmap(&p->groups[g].data_bitmap);
     }
 
-    uint8_t* bitmap = (uint8_t*) malloc(p->super_bloc.nb_data * sizeof(uint8_t ));
+    logger->info("Data bitmap deleted");
+    return 0;
+}
 
-    if (write(p->fd, bitmap, p->super_bloc.nb_data) == -1) {
-        logger->error("An error occurred when trying to delete the inode bitmap.");
-        free(bitmap);
+int get_databitmap(partition_t *p, uint32_t i) {
+    if (i >= p->super_bloc.nb_data) {
+        logger->error("You are trying to read the state of data beyond the accepted range.");
         return -1;
     }
-    free(p->data_bitmap);
-    logger->info("Data bitmap deleted");
-    return 0;
+
+    group_t *group = p->groups + data_group(p, i);
+    pthread_mutex_lock(&group->lock);
+    int value = get_bitmap(p, &group->data_bitmap, i % p->super_bloc.data_per_group);
+    pthread_mutex_unlock(&group->lock);
+    return value;
 }
 
 uint32_t next_free_data(partition_t *p){
@@ -99,7 +97,14 @@ uint32_t next_free_data(partition_t *p){
         return 0;
     }
 
-    uint32_t i = 0;
-    while (p->data_bitmap[i]) i++;
-    return i;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_t *group = p->groups + g;
+        pthread_mutex_lock(&group->lock);
+        uint32_t j = group->desc->nb_data_free > 0 ? find_free_bitmap(p, &group->data_bitmap) : group->desc->nb_data;
+        pthread_mutex_unlock(&group->lock);
+        if (j < group->desc->nb_data) {
+            return g * p->super_bloc.data_per_group + j;
+        }
+    }
+    return 0;
 }
\ No newline at end of file
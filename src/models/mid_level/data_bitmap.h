@@ -17,18 +17,20 @@
  * @brief Creates a new data bitmap on disk.
  * @param p The partition where to create your databitmap.
  * @return 0 if everything went well, -1 otherwise.
+ *
+ * The bitmap is zeroed with fallocate when possible, otherwise it is marked as uninitialized in the superblock.
  */
 int create_databitmap(partition_t *p);
 
 /**
- * @brief Reads the data bitmap and store it in memory.
+ * @brief Prepares the data bitmap in memory, its chunks are read from the disk when first touched.
  * @param p The partition.
  * @return 0 if everything went well, -1 otherwise.
  */
 int read_databitmap(partition_t *p);
 
 /**
- * @brief Writes the data bitmap on the disk.
+ * @brief Writes the modified chunks of the data bitmap on the disk.
  * @param p The partition.
  * @return 0 if everything went well, -1 otherwise.
  */
@@ -41,9 +43,17 @@ int update_databitmap(partition_t *p);
  */
 int delete_databitmap(partition_t *p);
 
+/**
+ * @brief Returns the state of a data block in the data bitmap of its group.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @return The value of the entry (0 if the block is free), -1 if an error occurs.
+ */
+int get_databitmap(partition_t *p, uint32_t i);
+
 /**
  * @brief Finds the next free data and returns its index.
  * @param p The partition.
- * @return The index of the next free data or -1 if an error occurs or there is no more free data.
+ * @return The index of the next free data or 0 if an error occurs or there is no more free data.
  */
 uint32_t next_free_data(partition_t *p);
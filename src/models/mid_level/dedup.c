@@ -0,0 +1,152 @@
+/**
+ * @file dedup.c
+ * @brief This file contains the implementation of the operations available on the deduplication index.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "../low_level/direct_io.h"
+#include "data.h"
+#include "data_bitmap.h"
+#include "dedup.h"
+
+extern logger_t *logger;
+
+/**
+ * @def DEDUP_MAX_CANDIDATES The maximum number of blocks compared for a single lookup.
+ */
+#define DEDUP_MAX_CANDIDATES 4
+
+int create_dedup_index(partition_t *p) {
+    if (zero_blocks(p, p->super_bloc.dedup_start, p->super_bloc.dedup_blocks) == -1) {
+        logger->error("An error occurred when trying to create the deduplication index.");
+        return -1;
+    }
+
+    logger->info("Deduplication index created");
+    return 0;
+}
+
+/**
+ * @brief Checks if a data block is still in the index (it has not been freed or rewritten since it was indexed).
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @return 1 if the block is indexed, 0 otherwise.
+ */
+static int is_indexed(partition_t *p, uint32_t i) {
+    int entry = get_databitmap(p, i);
+    return entry > 0 && (entry & DATA_INDEXED);
+}
+
+/**
+ * @brief Reads the bucket of a hash.
+ * @param p The partition.
+ * @param hash The hash.
+ * @param bucket Where to store the bucket (block_size bytes).
+ * @return The offset of the bucket in the partition, -1 if an error occurs.
+ */
+static off_t read_bucket(partition_t *p, uint64_t hash, dedup_entry_t *bucket) {
+    uint32_t bs = p->super_bloc.block_size;
+    off_t pos = ((off_t) p->super_bloc.dedup_start + (off_t) (hash % p->super_bloc.dedup_blocks)) * bs;
+    if (read_image(p, bucket, bs, pos) == -1) {
+        logger->error("An error occurred when trying to read the deduplication index.");
+        return -1;
+    }
+    return pos;
+}
+
+uint32_t find_dedup(partition_t *p, const uint8_t *block, uint64_t hash) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t nb_entries = bs / sizeof(dedup_entry_t);
+    dedup_entry_t *bucket = (dedup_entry_t*) malloc(bs);
+    uint8_t *candidate = (uint8_t*) malloc(bs);
+    if (bucket == NULL || candidate == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(bucket);
+        free(candidate);
+        return 0;
+    }
+
+    pthread_mutex_lock(&p->dedup_lock);
+    off_t pos = read_bucket(p, hash, bucket);
+    pthread_mutex_unlock(&p->dedup_lock);
+
+    uint32_t shared = 0;
+    uint32_t nb_candidates = 0;
+    for (uint32_t e = 0; pos != -1 && e < nb_entries && nb_candidates < DEDUP_MAX_CANDIDATES; e++) {
+        uint32_t i = bucket[e].block;
+        // The fragment block being filled is never shared, its content still changes
+        if (i == 0 || bucket[e].hash != hash || i == p->super_bloc.frag_block) {
+            continue;
+        }
+        nb_candidates++;
+        if (!is_indexed(p, i) || read_data(p, candidate, i) == -1) {
+            continue;
+        }
+        if (memcmp(candidate, block, bs) == 0 && ref_indexed_data(p, i) == 0) {
+            shared = i;
+            break;
+        }
+    }
+
+    free(bucket);
+    free(candidate);
+    if (shared != 0) {
+        logger->trace("Data deduplicated.");
+    }
+    return shared;
+}
+
+int insert_dedup(partition_t *p, uint64_t hash, uint32_t i) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t nb_entries = bs / sizeof(dedup_entry_t);
+    dedup_entry_t *bucket;
+    if ((bucket = (dedup_entry_t*) malloc(bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    pthread_mutex_lock(&p->dedup_lock);
+    off_t pos;
+    if ((pos = read_bucket(p, hash, bucket)) == -1) {
+        pthread_mutex_unlock(&p->dedup_lock);
+        free(bucket);
+        return -1;
+    }
+
+    // The entries whose block has been freed or rewritten since are reused, a full bucket evicts an entry
+    uint32_t slot = nb_entries;
+    for (uint32_t e = 0; e < nb_entries && slot == nb_entries; e++) {
+        if (bucket[e].block == 0 || bucket[e].block == i || !is_indexed(p, bucket[e].block)) {
+            slot = e;
+        }
+    }
+    if (slot == nb_entries) {
+        slot = (uint32_t) (hash >> 32) % nb_entries;
+    }
+
+    dedup_entry_t entry = {
+            .hash = hash,
+            .block = i
+    };
+    int ret = 0;
+    if (write_image(p, &entry, sizeof(dedup_entry_t), pos + (off_t) slot * sizeof(dedup_entry_t)) == -1) {
+        logger->error("An error occurred when trying to update the deduplication index.");
+        ret = -1;
+    }
+    pthread_mutex_unlock(&p->dedup_lock);
+    free(bucket);
+
+    if (ret == 0) {
+        ret = mark_data_indexed(p, i);
+    }
+    return ret;
+}
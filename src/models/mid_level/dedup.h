@@ -0,0 +1,44 @@
+/**
+ * @file dedup.h
+ * @brief This file contains the operations available on the deduplication index.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Creates an empty deduplication index on disk.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int create_dedup_index(partition_t *p);
+
+/**
+ * @brief Looks for a data block with the same content in the deduplication index, and takes a reference on it.
+ * @param p The partition.
+ * @param block The content to look for (block_size bytes).
+ * @param hash The hash of the content.
+ * @return The index of the shared data block, 0 if there is none.
+ *
+ * The candidates are compared byte by byte, so a hash collision never shares a block.
+ */
+uint32_t find_dedup(partition_t *p, const uint8_t *block, uint64_t hash);
+
+/**
+ * @brief Records a data block in the deduplication index.
+ * @param p The partition.
+ * @param hash The hash of the content of the block.
+ * @param i The index of the data block.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * The index is a hash table with one bucket per block, a full bucket evicts one of its entries.
+ */
+int insert_dedup(partition_t *p, uint64_t hash, uint32_t i);
@@ -0,0 +1,131 @@
+/**
+ * @file dentry.c
+ * @brief This file contains the implementation of the operations available on the dentry cache.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging/logging.h"
+
+#include "dentry.h"
+
+extern logger_t *logger;
+
+int init_dentries(partition_t *p) {
+    dentry_cache_t *c = &p->dentries;
+    c->nb_buckets = 2 * DENTRY_CACHE_ENTRIES;
+    c->nb_entries = 0;
+    c->lru.lru_prev = &c->lru;
+    c->lru.lru_next = &c->lru;
+    if ((c->buckets = (dentry_t**) calloc(c->nb_buckets, sizeof(dentry_t*))) == NULL) {
+        logger->error("An error occurred when trying to allocate the dentry cache.");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Hashes a name of a directory (FNV-1a).
+ */
+static uint32_t hash_dentry(uint32_t dir, const char *name) {
+    uint32_t h = 2166136261u ^ dir;
+    for (const char *c = name; *c != '\0'; c++) {
+        h = (h ^ (uint8_t) *c) * 16777619u;
+    }
+    return h;
+}
+
+static void lru_remove(dentry_t *e) {
+    e->lru_prev->lru_next = e->lru_next;
+    e->lru_next->lru_prev = e->lru_prev;
+}
+
+static void lru_push(dentry_cache_t *c, dentry_t *e) {
+    e->lru_prev = &c->lru;
+    e->lru_next = c->lru.lru_next;
+    c->lru.lru_next->lru_prev = e;
+    c->lru.lru_next = e;
+}
+
+/**
+ * @brief Returns the link pointing to a name in its bucket, or the end of the bucket if the name is not in the cache.
+ */
+static dentry_t** find_link(dentry_cache_t *c, uint32_t dir, const char *name) {
+    dentry_t **link = &c->buckets[hash_dentry(dir, name) % c->nb_buckets];
+    while (*link != NULL && ((*link)->dir != dir || strncmp((*link)->name, name, MAX_FILENAME) != 0)) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void remove_dentry(dentry_cache_t *c, dentry_t *e) {
+    dentry_t **link = find_link(c, e->dir, e->name);
+    *link = e->next;
+    lru_remove(e);
+    free(e);
+    c->nb_entries--;
+}
+
+dentry_t* lookup_dentry(partition_t *p, uint32_t dir, const char *name) {
+    dentry_cache_t *c = &p->dentries;
+    dentry_t *e = *find_link(c, dir, name);
+    if (e != NULL) {
+        lru_remove(e);
+        lru_push(c, e);
+    }
+    return e;
+}
+
+void add_dentry(partition_t *p, uint32_t dir, const char *name, bool negative, uint32_t inode, uint32_t file_type) {
+    dentry_cache_t *c = &p->dentries;
+    dentry_t **link = find_link(c, dir, name);
+    dentry_t *e = *link;
+    if (e == NULL) {
+        if (c->nb_entries >= DENTRY_CACHE_ENTRIES) {
+            remove_dentry(c, c->lru.lru_prev);
+            link = find_link(c, dir, name);
+        }
+        // The cache is only an accelerator: a name that cannot be remembered is looked up again next time
+        if ((e = (dentry_t*) calloc(1, sizeof(dentry_t))) == NULL) {
+            return;
+        }
+        e->dir = dir;
+        strncpy(e->name, name, MAX_FILENAME - 1);
+        *link = e;
+        c->nb_entries++;
+    } else {
+        lru_remove(e);
+    }
+
+    e->negative = negative;
+    e->inode = inode;
+    e->file_type = file_type;
+    lru_push(c, e);
+}
+
+void invalidate_dentry(partition_t *p, uint32_t dir, const char *name) {
+    dentry_cache_t *c = &p->dentries;
+    dentry_t *e = *find_link(c, dir, name);
+    if (e != NULL) {
+        remove_dentry(c, e);
+    }
+}
+
+void free_dentries(partition_t *p) {
+    dentry_cache_t *c = &p->dentries;
+    if (c->buckets != NULL) {
+        dentry_t *e = c->lru.lru_next;
+        while (e != &c->lru) {
+            dentry_t *next = e->lru_next;
+            free(e);
+            e = next;
+        }
+    }
+    free(c->buckets);
+    c->buckets = NULL;
+    c->nb_entries = 0;
+}
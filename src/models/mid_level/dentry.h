@@ -0,0 +1,59 @@
+/**
+ * @file dentry.h
+ * @brief This file contains the operations available on the dentry cache.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Prepares an empty dentry cache.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ *
+ * Like the directories, the cache is not shared between threads.
+ */
+int init_dentries(partition_t *p);
+
+/**
+ * @brief Looks up a name of a directory in the cache.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param name The name.
+ * @return The entry (valid until the next change of the cache), NULL if the name is not in the cache.
+ */
+dentry_t* lookup_dentry(partition_t *p, uint32_t dir, const char *name);
+
+/**
+ * @brief Remembers the result of a lookup, evicting the least recently used name when the cache is full.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param name The name.
+ * @param negative If the directory has no entry with this name.
+ * @param inode The inode of the entry.
+ * @param file_type The FILE_TYPE_* of the entry.
+ */
+void add_dentry(partition_t *p, uint32_t dir, const char *name, bool negative, uint32_t inode, uint32_t file_type);
+
+/**
+ * @brief Forgets a name of a directory, because its entry changed.
+ * @param p The partition.
+ * @param dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @param name The name.
+ */
+void invalidate_dentry(partition_t *p, uint32_t dir, const char *name);
+
+/**
+ * @brief Frees the dentry cache.
+ * @param p The partition.
+ */
+void free_dentries(partition_t *p);
@@ -0,0 +1,119 @@
+/**
+ * @file discard.c
+ * @brief This file contains the implementation of the discard of the free data blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "bitmap.h"
+#include "block_queue.h"
+#include "discard.h"
+#include "group.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Punches the blocks of a range of a group that are still free.
+ * @param p The partition.
+ * @param first The index of the first data block of the range.
+ * @param count The number of data blocks of the range, all in the group of the first one.
+ * @param punched Incremented by the number of blocks punched.
+ * @return 0 if everything went well, -1 if the host does not support it.
+ */
+static int discard_range(partition_t *p, uint32_t first, uint32_t count, int64_t *punched) {
+    uint32_t dpg = p->super_bloc.data_per_group;
+    group_t *group = p->groups + data_group(p, first);
+    int ret = 0;
+
+    // The lock of the group keeps the free blocks from being allocated again while they are punched
+    pthread_mutex_lock(&group->lock);
+    uint32_t run = 0;
+    for (uint32_t k = 0; k <= count && ret == 0; k++) {
+        if (k < count && get_bitmap(p, &group->data_bitmap, (first + k) % dpg) == 0) {
+            run++;
+            continue;
+        }
+        if (run > 0) {
+            ret = punch_blocks(p, group->desc->data_start + (first + k - run) % dpg, run);
+            *punched += ret == 0 ? run : 0;
+            run = 0;
+        }
+    }
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+static int compare_blocks(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*) a;
+    uint32_t y = *(const uint32_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Punches a batch of freed blocks, merged into ranges.
+ * @param arg The partition.
+ * @param blocks The blocks.
+ * @param nb_blocks The number of blocks.
+ * @return 0 if everything went well, -1 if the host does not support it.
+ */
+static int discard_blocks(void *arg, uint32_t *blocks, uint32_t nb_blocks) {
+    partition_t *p = (partition_t*) arg;
+    qsort(blocks, nb_blocks, sizeof(uint32_t), compare_blocks);
+
+    int64_t punched = 0;
+    uint32_t first = 0;
+    while (first < nb_blocks) {
+        // A range stops at a gap or at the end of a group, a block queued twice does not break it
+        uint32_t last = first;
+        while (last + 1 < nb_blocks && blocks[last + 1] <= blocks[last] + 1
+               && data_group(p, blocks[last + 1]) == data_group(p, blocks[first])) {
+            last++;
+        }
+        uint32_t count = blocks[last] - blocks[first] + 1;
+        if (discard_range(p, blocks[first], count, &punched) == -1) {
+            logger->warn("The host does not support punching holes, the freed blocks are not discarded anymore.");
+            return -1;
+        }
+        first = last + 1;
+    }
+
+    char log_buf[128];
+    sprintf(log_buf, "%lld data blocks discarded.", (long long) punched);
+    logger->trace(log_buf);
+    return 0;
+}
+
+int start_discard(partition_t *p) {
+    if (start_block_queue(&p->discard, discard_blocks, p, DISCARD_BATCH, DISCARD_QUEUE_MAX) == -1) {
+        logger->error("An error occurred when trying to start the discard of the freed blocks.");
+        return -1;
+    }
+    return 0;
+}
+
+void queue_discard(partition_t *p, uint32_t i) {
+    // A block that cannot be queued is only given back by the next trim
+    push_block_queue(&p->discard, i);
+}
+
+int stop_discard(partition_t *p) {
+    return stop_block_queue(&p->discard);
+}
+
+int64_t trim_free_data(partition_t *p) {
+    int64_t punched = 0;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        if (discard_range(p, g * p->super_bloc.data_per_group, p->gdt[g].nb_data, &punched) == -1) {
+            logger->error("The host does not support punching holes in the partition.");
+            return -1;
+        }
+    }
+    return punched;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file discard.h
+ * @brief This file contains the operations giving the storage of the free data blocks back to the host.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def DISCARD_BATCH The number of freed blocks that wakes the background task up.
+ */
+#define DISCARD_BATCH 256
+
+/**
+ * @def DISCARD_QUEUE_MAX The number of freed blocks the queue can hold, the next ones are left to fs_trim.
+ */
+#define DISCARD_QUEUE_MAX 65536
+
+/**
+ * @brief Starts the background task punching the freed data blocks out of the image.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int start_discard(partition_t *p);
+
+/**
+ * @brief Queues a data block that has just been freed. It can be called with the lock of its group held.
+ * @param p The mounted partition.
+ * @param i The index of the data block.
+ */
+void queue_discard(partition_t *p, uint32_t i);
+
+/**
+ * @brief Stops the background task, after it has discarded the blocks still queued.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int stop_discard(partition_t *p);
+
+/**
+ * @brief Punches every free data block out of the image.
+ * @param p The mounted partition.
+ * @return The number of blocks punched, -1 if an error occurs or if the host does not support it.
+ */
+int64_t trim_free_data(partition_t *p);
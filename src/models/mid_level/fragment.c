@@ -0,0 +1,90 @@
+/**
+ * @file fragment.c
+ * @brief This file contains the implementation of the allocator of the fragment blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging/logging.h"
+
+#include "data.h"
+#include "data_bitmap.h"
+#include "fragment.h"
+#include "sync.h"
+
+extern logger_t *logger;
+
+uint32_t store_fragment(partition_t *p, uint32_t goal, const uint8_t *tail, uint32_t size, uint32_t *offset) {
+    super_bloc_t *sb = &p->super_bloc;
+    if (size == 0 || size > sb->block_size) {
+        logger->error("You are trying to store a fragment larger than a block.");
+        return 0;
+    }
+
+    uint8_t *block;
+    if ((block = (uint8_t*) malloc(sb->block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return 0;
+    }
+
+    pthread_mutex_lock(&p->frag_lock);
+    // The current fragment block holds a reference of its own while it is being filled
+    bool fresh = false;
+    if (sb->frag_block == 0 || sb->frag_used + size > sb->block_size || ref_data(p, sb->frag_block) == -1) {
+        uint32_t frag_block;
+        if ((frag_block = allocate_data(p, goal)) == 0) {
+            pthread_mutex_unlock(&p->frag_lock);
+            free(block);
+            return 0;
+        }
+        if (sb->frag_block != 0 && unref_data(p, sb->frag_block) == -1) {
+            logger->error("An error occurred when trying to release the previous fragment block.");
+        }
+        sb->frag_block = frag_block;
+        sb->frag_used = 0;
+        fresh = true;
+        if (ref_data(p, sb->frag_block) == -1) {
+            pthread_mutex_unlock(&p->frag_lock);
+            free(block);
+            return 0;
+        }
+    }
+
+    // The whole block is rewritten, so that its checksum covers all the tails it holds
+    uint32_t frag_block = sb->frag_block;
+    if (fresh) {
+        memset(block, 0, sb->block_size);
+    } else if (read_data(p, block, frag_block) == -1) {
+        unref_data(p, frag_block);
+        pthread_mutex_unlock(&p->frag_lock);
+        free(block);
+        return 0;
+    }
+    memcpy(block + sb->frag_used, tail, size);
+    if (update_data(p, block, frag_block) == -1) {
+        unref_data(p, frag_block);
+        pthread_mutex_unlock(&p->frag_lock);
+        free(block);
+        return 0;
+    }
+
+    // The cursor is written with the tail, so that a remount after a crash does not reuse the space it covers
+    *offset = sb->frag_used;
+    sb->frag_used += size;
+    if (write_super_bloc(p) == -1) {
+        sb->frag_used -= size;
+        unref_data(p, frag_block);
+        pthread_mutex_unlock(&p->frag_lock);
+        free(block);
+        return 0;
+    }
+    pthread_mutex_unlock(&p->frag_lock);
+    free(block);
+
+    logger->trace("Fragment stored.");
+    return frag_block;
+}
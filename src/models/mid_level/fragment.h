@@ -0,0 +1,29 @@
+/**
+ * @file fragment.h
+ * @brief This file contains the allocator of the fragment blocks, the data blocks shared by the tails of several files.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Stores a file tail in the current fragment block, starting a new fragment block when it is full.
+ * @param p The partition.
+ * @param goal The index of the preferred group for a new fragment block.
+ * @param tail The content of the tail.
+ * @param size The size of the tail.
+ * @param offset Where to store the position of the tail in the fragment block.
+ * @return The index of the fragment block (which holds a reference for the tail), 0 if there is no more free data.
+ *
+ * The fragment block is filled linearly, its space is given back when the last tail it holds is released.
+ * The superblock is written with the tail, so that the cursor on the disk never points before a stored tail.
+ */
+uint32_t store_fragment(partition_t *p, uint32_t goal, const uint8_t *tail, uint32_t size, uint32_t *offset);
@@ -0,0 +1,237 @@
+/**
+ * @file group.c
+ * @brief This file contains the implementation of the operations available on the block groups.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "../low_level/direct_io.h"
+#include "bitmap.h"
+#include "group.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Computes the regions of a block group.
+ * @param gd The descriptor to fill.
+ * @param first The index of the first block of the group.
+ * @param nb_blocks The number of blocks of the group.
+ * @param block_size The size of the blocks.
+ * @param nb_inodes The percentage of the blocks used by the inode table.
+ * @return The number of inode table blocks, 0 if the group is too small.
+ */
+static uint32_t group_geometry(group_desc_t *gd, uint32_t first, uint32_t nb_blocks, uint32_t block_size, uint8_t nb_inodes) {
+    uint32_t inode_blocks = (uint32_t) DIV_ROUND_UP((uint64_t) nb_blocks * nb_inodes, 100);
+    if (inode_blocks == 0) {
+        inode_blocks = 1;
+    }
+    uint32_t inodes = inode_blocks * (block_size / sizeof(inode_t));
+    uint32_t inode_bitmap_blocks = DIV_ROUND_UP(inodes, block_size);
+    if (nb_blocks <= inode_bitmap_blocks + inode_blocks + 1) {
+        return 0;
+    }
+
+    uint32_t nb_data_total = nb_blocks - inode_bitmap_blocks - inode_blocks;
+    uint32_t nb_data = nb_data_total - DIV_ROUND_UP(nb_data_total, block_size);
+    if (nb_data == 0) {
+        return 0;
+    }
+
+    memset(gd, 0, sizeof(group_desc_t));
+    gd->data_bitmap_start = first;
+    gd->inode_bitmap_start = gd->data_bitmap_start + DIV_ROUND_UP(nb_data, block_size);
+    gd->inode_table_start = gd->inode_bitmap_start + inode_bitmap_blocks;
+    gd->data_start = gd->inode_table_start + inode_blocks;
+    gd->nb_data = nb_data;
+    gd->nb_data_free = nb_data;
+    gd->nb_inodes = inodes;
+    gd->nb_inodes_free = inodes;
+    return inode_blocks;
+}
+
+int layout_groups(super_bloc_t *sb, mkfs_options_t options, group_desc_t **gdt) {
+    uint32_t bs = sb->block_size;
+    if (sb->nb_blocks < 4) {
+        return -1;
+    }
+
+    // The size of the descriptor table depends on the number of groups, which depends on its size
+    // The optional regions sit between the descriptor table and the first group
+    sb->flags = options.features;
+    uint32_t dedup_blocks = (options.features & FS_FEATURE_DEDUP) ? DIV_ROUND_UP(sb->nb_blocks, bs / sizeof(dedup_entry_t)) : 0;
+    uint32_t checksum_blocks = (options.features & FS_FEATURE_CHECKSUM) ? DIV_ROUND_UP(sb->nb_blocks, bs / sizeof(uint32_t)) : 0;
+    uint32_t index_blocks = dedup_blocks + checksum_blocks;
+    if (sb->nb_blocks < 4 + index_blocks) {
+        return -1;
+    }
+
+    uint32_t blocks_per_group = options.blocks_per_group;
+    uint32_t nb_groups = 1;
+    uint32_t gdt_blocks = 1;
+    if (blocks_per_group != 0) {
+        nb_groups = DIV_ROUND_UP(sb->nb_blocks - 1 - index_blocks, blocks_per_group);
+        gdt_blocks = DIV_ROUND_UP(nb_groups * sizeof(group_desc_t), bs);
+        nb_groups = DIV_ROUND_UP(sb->nb_blocks - 1 - gdt_blocks - index_blocks, blocks_per_group);
+    } else {
+        blocks_per_group = sb->nb_blocks - 1 - gdt_blocks - index_blocks;
+    }
+
+    if ((*gdt = (group_desc_t*) calloc(nb_groups, sizeof(group_desc_t))) == NULL) {
+        logger->error("An error occurred when trying to allocate the group descriptor table.");
+        return -1;
+    }
+
+    sb->gdt_start = 1;
+    sb->blocks_per_group = blocks_per_group;
+    sb->nb_data = 0;
+    sb->nb_inodes = 0;
+    sb->nb_inode_blocks = 0;
+    sb->dedup_start = sb->gdt_start + gdt_blocks;
+    sb->dedup_blocks = dedup_blocks;
+    sb->checksum_start = sb->dedup_start + sb->dedup_blocks;
+    sb->checksum_blocks = checksum_blocks;
+    uint32_t first = sb->checksum_start + sb->checksum_blocks;
+    uint32_t g;
+    for (g = 0; g < nb_groups; g++) {
+        uint32_t group_first = first + g * blocks_per_group;
+        uint32_t group_blocks = sb->nb_blocks - group_first < blocks_per_group ? sb->nb_blocks - group_first : blocks_per_group;
+        uint32_t inode_blocks = group_geometry(*gdt + g, group_first, group_blocks, bs, options.nb_inodes);
+        if (inode_blocks == 0) {
+            // Only the last group may be too small: its blocks are left unused
+            break;
+        }
+        sb->nb_data += (*gdt)[g].nb_data;
+        sb->nb_inodes += (*gdt)[g].nb_inodes;
+        sb->nb_inode_blocks += inode_blocks;
+    }
+    if (g == 0) {
+        free(*gdt);
+        return -1;
+    }
+
+    sb->nb_groups = g;
+    sb->data_per_group = (*gdt)[0].nb_data;
+    sb->inodes_per_group = (*gdt)[0].nb_inodes;
+    sb->nb_data_free = sb->nb_data;
+    sb->nb_inodes_free = sb->nb_inodes;
+    return 0;
+}
+
+int create_groups(partition_t *p) {
+    uint32_t bs = p->super_bloc.block_size;
+
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_desc_t *gd = p->gdt + g;
+        uint32_t inode_blocks = gd->data_start - gd->inode_table_start;
+
+        // The inode table is the largest region: it is only zeroed now if fallocate can do it without writing
+        // The blocks already written when the filesystem is populated are kept
+        uint32_t init = gd->inode_table_init;
+        if (zero_blocks_fast(p, gd->inode_table_start + init, inode_blocks - init) == 0) {
+            gd->inode_table_init = inode_blocks;
+        } else {
+            gd->flags |= BG_INODE_TABLE_UNINIT;
+        }
+    }
+
+    uint32_t gdt_blocks = DIV_ROUND_UP(p->super_bloc.nb_groups * sizeof(group_desc_t), bs);
+    void *buf;
+    if (posix_memalign(&buf, bs, (size_t) gdt_blocks * bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    memset(buf, 0, (size_t) gdt_blocks * bs);
+    memcpy(buf, p->gdt, p->super_bloc.nb_groups * sizeof(group_desc_t));
+    if (write_image(p, buf, (size_t) gdt_blocks * bs, (off_t) p->super_bloc.gdt_start * bs) == -1) {
+        logger->error("An error occurred when trying to write the group descriptor table.");
+        free(buf);
+        return -1;
+    }
+    free(buf);
+
+    logger->trace("Groups created.");
+    return 0;
+}
+
+int read_groups(partition_t *p) {
+    uint32_t bs = p->super_bloc.block_size;
+    uint32_t nb_groups = p->super_bloc.nb_groups;
+
+    p->gdt = (group_desc_t*) malloc(nb_groups * sizeof(group_desc_t));
+    p->groups = (group_t*) calloc(nb_groups, sizeof(group_t));
+    if (p->gdt == NULL || p->groups == NULL) {
+        logger->error("An error occurred when trying to allocate the groups.");
+        return -1;
+    }
+    if (read_image(p, p->gdt, nb_groups * sizeof(group_desc_t), (off_t) p->super_bloc.gdt_start * bs) == -1) {
+        logger->error("An error occurred when trying to read the group descriptor table.");
+        return -1;
+    }
+
+    // The group descriptors are written back with each operation, the free counters of the superblock only by umount
+    p->super_bloc.nb_data_free = 0;
+    p->super_bloc.nb_inodes_free = 0;
+    for (uint32_t g = 0; g < nb_groups; g++) {
+        group_t *group = p->groups + g;
+        group->desc = p->gdt + g;
+        p->super_bloc.nb_data_free += group->desc->nb_data_free;
+        p->super_bloc.nb_inodes_free += group->desc->nb_inodes_free;
+        if (pthread_mutex_init(&group->lock, NULL) != 0) {
+            logger->error("An error occurred when trying to create the lock of a group.");
+            return -1;
+        }
+    }
+
+    logger->trace("Groups read.");
+    return 0;
+}
+
+int update_groups(partition_t *p) {
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_t *group = p->groups + g;
+        pthread_mutex_lock(&group->lock);
+        if (group->dirty) {
+            off_t pos = (off_t) p->super_bloc.gdt_start * p->super_bloc.block_size + (off_t) g * sizeof(group_desc_t);
+            if (write_image(p, group->desc, sizeof(group_desc_t), pos) == -1) {
+                pthread_mutex_unlock(&group->lock);
+                logger->error("An error occurred when trying to update a group descriptor.");
+                return -1;
+            }
+            group->dirty = false;
+        }
+        pthread_mutex_unlock(&group->lock);
+    }
+
+    logger->trace("Groups updated.");
+    return 0;
+}
+
+void free_groups(partition_t *p) {
+    if (p->groups != NULL) {
+        for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+            free_bitmap(&p->groups[g].data_bitmap);
+            free_bitmap(&p->groups[g].inode_bitmap);
+            pthread_mutex_destroy(&p->groups[g].lock);
+        }
+    }
+    free(p->groups);
+    free(p->gdt);
+    p->groups = NULL;
+    p->gdt = NULL;
+}
+
+uint32_t data_group(partition_t *p, uint32_t i) {
+    return i / p->super_bloc.data_per_group;
+}
+
+uint32_t inode_group(partition_t *p, uint32_t i) {
+    return i / p->super_bloc.inodes_per_group;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file group.h
+ * @brief This file contains the operations available on the block groups and their descriptor table.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @brief Computes the layout of the block groups of a new filesystem.
+ * @param sb The superblock, with the block size and the number of blocks already set.
+ * @param options The options of the filesystem.
+ * @param gdt Where to store the group descriptor table (allocated by the function).
+ * @return 0 if everything went well, -1 if the partition is too small.
+ */
+int layout_groups(super_bloc_t *sb, mkfs_options_t options, group_desc_t **gdt);
+
+/**
+ * @brief Creates the block groups on the disk: zeroes their metadata and writes the group descriptor table.
+ * @param p The partition, with its superblock and group descriptor table.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int create_groups(partition_t *p);
+
+/**
+ * @brief Reads the group descriptor table and prepares the block groups in memory.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int read_groups(partition_t *p);
+
+/**
+ * @brief Writes the modified group descriptors on the disk.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int update_groups(partition_t *p);
+
+/**
+ * @brief Frees the memory used by the block groups.
+ * @param p The partition.
+ */
+void free_groups(partition_t *p);
+
+/**
+ * @brief Returns the block group of a data block.
+ * @param p The partition.
+ * @param i The index of the data block.
+ * @return The index of the group.
+ */
+uint32_t data_group(partition_t *p, uint32_t i);
+
+/**
+ * @brief Returns the block group of an inode.
+ * @param p The partition.
+ * @param i The index of the inode.
+ * @return The index of the group.
+ */
+uint32_t inode_group(partition_t *p, uint32_t i);
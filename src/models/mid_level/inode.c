@@ -9,141 +9,166 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <unistd.h>
 #include <string.h>
 
 #include "logging/logging.h"
+#include "bitmap.h"
+#include "checksum.h"
 #include "data_bitmap.h"
 #include "../low_level/block.h"
+#include "../low_level/direct_io.h"
+#include "group.h"
 #include "inode.h"
+#include "inode_bitmap.h"
+#include "lazy_init.h"
+
 extern logger_t* logger;
 
 off_t get_inode_offset(partition_t *p, uint32_t i){
-    double nb_data = (double) p->super_bloc.nb_data;
-    double block_size = (double) p->super_bloc.block_size;
-    double nb_inodes = (double) p->super_bloc.nb_inodes;
-    //TODO Look if you don't get a typo error
-    return (off_t) (ceil(nb_data/block_size)+ceil(nb_inodes/block_size)+1)*block_size + i * sizeof(inode_t);
+    uint32_t g = inode_group(p, i);
+    return (off_t) p->gdt[g].inode_table_start * p->super_bloc.block_size
+            + (off_t) (i % p->super_bloc.inodes_per_group) * sizeof(inode_t);
+}
+
+/**
+ * @brief Marks a free inode of a group as used. The lock of the group must be held.
+ * @param p The partition to use.
+ * @param g The index of the group.
+ * @param j The index of the inode in the group.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int take_inode(partition_t *p, uint32_t g, uint32_t j) {
+    group_t *group = p->groups + g;
+    if (set_bitmap(p, &group->inode_bitmap, j, 1) == -1) {
+        return -1;
+    }
+    group->desc->nb_inodes_free--;
+    group->dirty = true;
+    __atomic_sub_fetch(&p->super_bloc.nb_inodes_free, 1, __ATOMIC_RELAXED);
+    return 0;
 }
 
 int create_inode(partition_t *p, uint32_t i){
-    if (i > p->super_bloc.nb_inodes) {
+    if (i >= p->super_bloc.nb_inodes) {
         logger->error("You are trying to create an inode beyond the memory for all inode.");
         return -1;
     }
 
-    if (p->inode_bitmap[i] == 1){
+    uint32_t g = inode_group(p, i);
+    pthread_mutex_lock(&p->groups[g].lock);
+    if (get_bitmap(p, &p->groups[g].inode_bitmap, i % p->super_bloc.inodes_per_group) != 0){
+        pthread_mutex_unlock(&p->groups[g].lock);
         logger->error("You are trying to create an already create inode");
+        return -1;
     }
 
-    p->inode_bitmap[i] = 1;
-    p->super_bloc.nb_inodes_free--;
+    int ret = take_inode(p, g, i % p->super_bloc.inodes_per_group);
+    pthread_mutex_unlock(&p->groups[g].lock);
+    if (ret == -1) {
+        return -1;
+    }
     logger->trace("Inode created");
     return 0;
 }
 
+uint32_t allocate_inode(partition_t *p, uint32_t goal) {
+    for (uint32_t n = 0; n < p->super_bloc.nb_groups; n++) {
+        uint32_t g = (goal + n) % p->super_bloc.nb_groups;
+        group_t *group = p->groups + g;
+        if (__atomic_load_n(&group->desc->nb_inodes_free, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+
+        pthread_mutex_lock(&group->lock);
+        uint32_t j = group->desc->nb_inodes_free > 0 ? find_free_bitmap(p, &group->inode_bitmap) : group->desc->nb_inodes;
+        int ret = j < group->desc->nb_inodes ? take_inode(p, g, j) : -1;
+        pthread_mutex_unlock(&group->lock);
+        if (ret == 0) {
+            logger->trace("Inode allocated");
+            return g * p->super_bloc.inodes_per_group + j;
+        }
+    }
+
+    logger->warn("No more free inode.");
+    return p->super_bloc.nb_inodes + 1;
+}
+
 int read_inode(partition_t *p, inode_t* inode, uint32_t i){
-    if (i > p->super_bloc.nb_inodes) {
+    if (i >= p->super_bloc.nb_inodes) {
         logger->error("You are trying to read an inode beyond the accepted range.");
         return -1;
     }
 
-    if (p->inode_bitmap[i] == 0){
+    if (get_inodebitmap(p, i) <= 0){
         logger->warn("Your inode is not open !");
         return -1;
     }
 
-    off_t inode_pos = get_inode_offset(p, i);
-    if (lseek(p->fd, inode_pos, SEEK_SET) == -1){
-        logger->error("An error occurred when trying to move the head.");
+    if (read_image(p, inode, sizeof(inode_t), get_inode_offset(p, i)) == -1) {
+        logger->error("An error occurred when trying to read the inode.");
         return -1;
     }
-
-    if (read(p->fd, &inode->memory_size_data, 4) == -1){
-        logger->error("An error occurred when trying to read the inode size data.");
-        return -1;
-    }
-    if(read(p->fd, &inode->last_modification, 4) == -1){
-        logger->error("An error occurred when trying to read the inode last modification");
-        return -1;
-    }
-    if(read(p->fd, &inode->last_access, 4) == -1){
-        logger->error("An error occurred when trying to read the inode last access");
+    if ((p->super_bloc.flags & FS_FEATURE_CHECKSUM) && inode->checksum != inode_checksum(*inode)) {
+        logger->error("The inode is corrupted (checksum mismatch).");
         return -1;
     }
-    if(read(p->fd, &inode->file_type, 4) == -1){
-        logger->error("An error occurred when trying to read the inode file type.");
-        return -1;
-    }
-    for (int j = 0; j < NB_DATA_BLOCKS_INODE; j++) {
-        if(read(p->fd, (inode->data_blocks + j), sizeof(uint32_t)) == -1){
-            logger->error("An error occurred when trying to read one of your inode data block");
-            return -1;
-        }
-    }
 
     logger->trace("Inode read");
     return 0;
 }
 
 int update_inode(partition_t *p, inode_t inode, uint32_t i){
-    if (i > p->super_bloc.nb_inodes) {
+    if (i >= p->super_bloc.nb_inodes) {
         logger->error("You are trying to update an inode beyond the accepted range.");
         return -1;
     }
 
-    if (p->inode_bitmap[i] == 0){
+    if (get_inodebitmap(p, i) <= 0){
         logger->warn("Your inode is not open");
         return -1;
     }
 
-    off_t inode_pos = get_inode_offset(p, i);
-    if (lseek(p->fd, inode_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+    if (lazy_init_inode_table(p, i) == -1) {
+        logger->error("An error occurred when trying to initialize the inode table.");
         return -1;
     }
 
-    if(write(p->fd, &inode.memory_size_data, 4) == -1){
-        logger->error("An error occurred when trying to update the size of inode data");
-        return -1;
-    }
-    if(write(p->fd, &inode.last_modification, 4) == -1){
-        logger->error("An error occurred when trying to update the size of inode last modification");
-        return -1;
-    }
-    if(write(p->fd, &inode.last_access, 4) == -1){
-        logger->error("An error occurred when trying to update the size of inode last access");
-        return -1;
+    if (p->super_bloc.flags & FS_FEATURE_CHECKSUM) {
+        inode.checksum = inode_checksum(inode);
     }
-    if(write(p->fd, &inode.file_type, 4) == -1){
-        logger->error("An error occurred when trying to update the size of inode file type.");
+    if (write_image(p, &inode, sizeof(inode_t), get_inode_offset(p, i)) == -1) {
+        logger->error("An error occurred when trying to update the inode.");
         return -1;
     }
-    for (int j = 0; j < NB_DATA_BLOCKS_INODE; j++) {
-        if(write(p->fd, inode.data_blocks + j, 4) == -1){
-            logger->error("An error occurred when trying to read one of your inode data block");
-            return -1;
-        }
-    }
 
     logger->trace("Inode update");
     return 0;
 }
 
 int delete_inode(partition_t *p, uint32_t i){
-    if (i > p->super_bloc.nb_inodes){
+    if (i >= p->super_bloc.nb_inodes){
         logger->error("You are trying to create an inode beyond the memory for all inode.");
         return -1;
     }
 
-    if (p->inode_bitmap[i] == 0){
+    uint32_t g = inode_group(p, i);
+    group_t *group = p->groups + g;
+    pthread_mutex_lock(&group->lock);
+    if (get_bitmap(p, &group->inode_bitmap, i % p->super_bloc.inodes_per_group) <= 0){
+        pthread_mutex_unlock(&group->lock);
         logger->error("You are trying to delete a non-existent inode");
         return -1;
     }
 
-    p->inode_bitmap[i] = 0;
-    p->super_bloc.nb_inodes_free++;
+    if (set_bitmap(p, &group->inode_bitmap, i % p->super_bloc.inodes_per_group, 0) == -1) {
+        pthread_mutex_unlock(&group->lock);
+        return -1;
+    }
+    group->desc->nb_inodes_free++;
+    group->dirty = true;
+    pthread_mutex_unlock(&group->lock);
+    __atomic_add_fetch(&p->super_bloc.nb_inodes_free, 1, __ATOMIC_RELAXED);
     logger->trace("Inode deleted");
     return 0;
 }
@@ -20,6 +20,14 @@
  */
 int create_inode(partition_t *p, uint32_t i);
 
+/**
+ * @brief Finds a free inode and marks it as used, preferably in the given block group.
+ * @param p The partition to use.
+ * @param goal The index of the preferred group.
+ * @return The index of the allocated inode, nb_inodes + 1 if there is no more free inode.
+ */
+uint32_t allocate_inode(partition_t *p, uint32_t goal);
+
 /**
  * @brief Reads an inode located at the specified location.
  * @param p The partition to use.
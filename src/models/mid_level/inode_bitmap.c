@@ -6,30 +6,26 @@
  * @date 03-29-2024
  */
 
-#include <math.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
-#include <unistd.h>
-
 #include "logging/logging.h"
 
+#include "../low_level/block.h"
+#include "bitmap.h"
+#include "group.h"
 #include "inode_bitmap.h"
 
 extern logger_t *logger;
 
 int create_inodebitmap(partition_t *p) {
-    off_t bitmap_pos = (int) (ceil((double) p->super_bloc.nb_data / (double) p->super_bloc.block_size) + 1) * p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_desc_t *gd = p->gdt + g;
+        uint32_t bitmap_blocks = gd->inode_table_start - gd->inode_bitmap_start;
 
-    p->inode_bitmap = (uint8_t*) malloc(p->super_bloc.nb_inodes * sizeof(uint8_t));
-    memset(p->inode_bitmap, 0, p->super_bloc.nb_inodes);
-    if (write(p->fd, p->inode_bitmap, p->super_bloc.nb_inodes) == -1) {
-        logger->error("An error occurred when trying to create the inode bitmap.");
-        return -1;
+        if (zero_blocks_fast(p, gd->inode_bitmap_start, bitmap_blocks) == 0) {
+            gd->inode_bitmap_init = bitmap_blocks;
+        } else {
+            gd->flags |= BG_INODE_BITMAP_UNINIT;
+            gd->inode_bitmap_init = 0;
+        }
     }
 
     logger->info("Inode bitmap created.");
@@ -37,51 +33,58 @@ int create_inodebitmap(partition_t *p) {
 }
 
 int read_inodebitmap(partition_t *p) {
-    off_t bitmap_pos = (int) (ceil((double) p->super_bloc.nb_data / (double) p->super_bloc.block_size) + 1) * p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-
-    if (read(p->fd, p->inode_bitmap, p->super_bloc.nb_inodes) == -1) {
-        logger->error("An error occurred when trying to read the inode bitmap.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_t *group = p->groups + g;
+        if (init_bitmap(&group->inode_bitmap, group->desc->inode_bitmap_start, group->desc->nb_inodes, p->super_bloc.block_size,
+                        &group->desc->inode_bitmap_init, BG_INODE_BITMAP_UNINIT) == -1) {
+            logger->error("An error occurred when trying to read the inode bitmap.");
+            return -1;
+        }
+        group->inode_bitmap.group = g;
+        group->inode_bitmap.flags = &group->desc->flags;
     }
     logger->trace("Inode bitmap read.");
     return 0;
 }
 
 int update_inodebitmap(partition_t *p) {
-    off_t bitmap_pos = (int) (ceil((double) p->super_bloc.nb_data / (double) p->super_bloc.block_size) + 1) * p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
-    }
-
-    if (write(p->fd, p->inode_bitmap, p->super_bloc.nb_inodes) == -1) {
-        logger->error("An error occurred when trying to update the inode bitmap.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        pthread_mutex_lock(&p->groups[g].lock);
+        int ret = flush_bitmap(p, &p->groups[g].inode_bitmap);
+        pthread_mutex_unlock(&p->groups[g].lock);
+        if (ret == -1) {
+            logger->error("An error occurred when trying to update the inode bitmap.");
+            return -1;
+        }
     }
     logger->trace("Inode bitmap updated.");
     return 0;
 }
 
 int delete_inodebitmap(partition_t *p) {
-    off_t bitmap_pos = (int) (ceil((double) p->super_bloc.nb_data / (double) p->super_bloc.block_size) + 1) * p->super_bloc.block_size;
-    if (lseek(p->fd, bitmap_pos, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
-        return -1;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_desc_t *gd = p->gdt + g;
+        if (zero_blocks(p, gd->inode_bitmap_start, gd->inode_table_start - gd->inode_bitmap_start) == -1) {
+            logger->error("An error occurred when trying to delete the inode bitmap.");
+            return -1;
+        }
+        free_bitmap(&p->groups[g].inode_bitmap);
     }
+    logger->info("Inode bitmap deleted.");
+    return 0;
+}
 
-    uint8_t *bitmap = (uint8_t*) malloc(p->super_bloc.nb_inodes * sizeof(uint8_t));
-    if (write(p->fd, bitmap, p->super_bloc.nb_inodes) == -1) {
-        logger->error("An error occurred when trying to delete the inode bitmap.");
-        free(bitmap);
+int get_inodebitmap(partition_t *p, uint32_t i) {
+    if (i >= p->super_bloc.nb_inodes) {
+        logger->error("You are trying to read the state of an inode beyond the accepted range.");
         return -1;
     }
-    free(bitmap);
-    logger->info("Inode bitmap deleted.");
-    return 0;
+
+    group_t *group = p->groups + inode_group(p, i);
+    pthread_mutex_lock(&group->lock);
+    int value = get_bitmap(p, &group->inode_bitmap, i % p->super_bloc.inodes_per_group);
+    pthread_mutex_unlock(&group->lock);
+    return value;
 }
 
 uint32_t next_free_inode(partition_t *p) {
@@ -90,7 +93,14 @@ uint32_t next_free_inode(partition_t *p) {
         return p->super_bloc.nb_inodes + 1;
     }
 
-    uint32_t i = 0;
-    while (p->inode_bitmap[i]) i++;
-    return i;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        group_t *group = p->groups + g;
+        pthread_mutex_lock(&group->lock);
+        uint32_t j = group->desc->nb_inodes_free > 0 ? find_free_bitmap(p, &group->inode_bitmap) : group->desc->nb_inodes;
+        pthread_mutex_unlock(&group->lock);
+        if (j < group->desc->nb_inodes) {
+            return g * p->super_bloc.inodes_per_group + j;
+        }
+    }
+    return p->super_bloc.nb_inodes + 1;
 }
\ No newline at end of file
@@ -16,18 +16,20 @@
  * @brief Creates a new inode bitmap on disk.
  * @param p The partition where to create de bitmap.
  * @return 0 if everything went well, -1 otherwise.
+ *
+ * The bitmap is zeroed with fallocate when possible, otherwise it is marked as uninitialized in the superblock.
  */
 int create_inodebitmap(partition_t *p);
 
 /**
- * @brief Reads the inode bitmap and store it in memory.
+ * @brief Prepares the inode bitmap in memory, its chunks are read from the disk when first touched.
  * @param p The partition.
  * @return 0 if everything went well, -1 otherwise.
  */
 int read_inodebitmap(partition_t *p);
 
 /**
- * @brief Writes the inode bitmap on the disk.
+ * @brief Writes the modified chunks of the inode bitmap on the disk.
  * @param p The partition.
  * @return 0 if everything went well, -1 otherwise.
  */
@@ -40,6 +42,14 @@ int update_inodebitmap(partition_t *p);
  */
 int delete_inodebitmap(partition_t *p);
 
+/**
+ * @brief Returns the state of an inode in the inode bitmap of its group.
+ * @param p The partition.
+ * @param i The index of the inode.
+ * @return The value of the entry (0 if the inode is free), -1 if an error occurs.
+ */
+int get_inodebitmap(partition_t *p, uint32_t i);
+
 /**
  * @brief Finds the next free inode and returns its index.
  * @param p The partition.
@@ -0,0 +1,160 @@
+/**
+ * @file lazy_init.c
+ * @brief This file contains the implementation of the lazy initialization of the metadata regions.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <stddef.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "../low_level/direct_io.h"
+#include "group.h"
+#include "lazy_init.h"
+
+extern logger_t *logger;
+
+int persist_lazy_init(partition_t *p, uint32_t g) {
+    const uint8_t *state = (const uint8_t*) (p->gdt + g) + offsetof(group_desc_t, flags);
+    off_t pos = (off_t) p->super_bloc.gdt_start * p->super_bloc.block_size + (off_t) g * sizeof(group_desc_t)
+            + offsetof(group_desc_t, flags);
+    if (write_image(p, state, 4 * sizeof(uint32_t), pos) == -1) {
+        logger->error("An error occurred when trying to write the initialization state of a group.");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Zeroes the inode table of a group up to the given block. The lazy init lock must be held.
+ * @param p The partition.
+ * @param g The index of the group.
+ * @param upto The number of inode table blocks that must be zeroed.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int zero_inode_table_upto(partition_t *p, uint32_t g, uint32_t upto) {
+    group_desc_t *gd = p->gdt + g;
+    uint32_t inode_blocks = gd->data_start - gd->inode_table_start;
+    if (upto > inode_blocks) {
+        upto = inode_blocks;
+    }
+    if (upto <= gd->inode_table_init) {
+        return 0;
+    }
+
+    if (zero_blocks(p, gd->inode_table_start + gd->inode_table_init, upto - gd->inode_table_init) == -1) {
+        logger->error("An error occurred when trying to zero the inode table.");
+        return -1;
+    }
+    gd->inode_table_init = upto;
+    if (gd->inode_table_init == inode_blocks) {
+        gd->flags &= ~BG_INODE_TABLE_UNINIT;
+        logger->trace("Inode table of a group initialized.");
+    }
+    return persist_lazy_init(p, g);
+}
+
+int lazy_init_inode_table(partition_t *p, uint32_t i) {
+    uint32_t g = inode_group(p, i);
+    if (!(p->gdt[g].flags & BG_INODE_TABLE_UNINIT)) {
+        return 0;
+    }
+
+    uint32_t j = i - g * p->super_bloc.inodes_per_group;
+    uint32_t block = (uint32_t) (((uint64_t) j * sizeof(inode_t)) / p->super_bloc.block_size);
+    pthread_mutex_lock(&p->lazy_init_lock);
+    int ret = zero_inode_table_upto(p, g, block + 1);
+    pthread_mutex_unlock(&p->lazy_init_lock);
+    return ret;
+}
+
+int lazy_init_bitmap(partition_t *p, bitmap_t *b, uint32_t upto) {
+    if (!(*b->flags & b->uninit_flag) || upto <= *b->init) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&p->lazy_init_lock);
+    *b->init = upto;
+    if (*b->init >= b->nb_chunks) {
+        *b->flags &= ~b->uninit_flag;
+    }
+    int ret = persist_lazy_init(p, b->group);
+    pthread_mutex_unlock(&p->lazy_init_lock);
+    return ret;
+}
+
+/**
+ * @brief The background task zeroing the inode tables of the groups step by step.
+ * @param arg The mounted partition.
+ * @return NULL.
+ */
+static void* lazy_init_task(void *arg) {
+    partition_t *p = (partition_t*) arg;
+
+    uint32_t g = 0;
+    bool done = false;
+    while (!done) {
+        pthread_mutex_lock(&p->lazy_init_lock);
+        while (g < p->super_bloc.nb_groups && !(p->gdt[g].flags & BG_INODE_TABLE_UNINIT)) {
+            g++;
+        }
+        if (p->lazy_init_stop || g >= p->super_bloc.nb_groups) {
+            done = true;
+        } else if (zero_inode_table_upto(p, g, p->gdt[g].inode_table_init + LAZY_INIT_STEP) == -1) {
+            logger->error("The lazy initialization of the inode tables stopped.");
+            done = true;
+        }
+        pthread_mutex_unlock(&p->lazy_init_lock);
+
+        if (!done) {
+            usleep(LAZY_INIT_DELAY_US);
+        }
+    }
+    return NULL;
+}
+
+int start_lazy_init(partition_t *p) {
+    p->lazy_init_running = false;
+    p->lazy_init_stop = false;
+    if (pthread_mutex_init(&p->lazy_init_lock, NULL) != 0) {
+        logger->error("An error occurred when trying to create the lazy init lock.");
+        return -1;
+    }
+
+    bool uninit = false;
+    for (uint32_t g = 0; g < p->super_bloc.nb_groups; g++) {
+        uninit |= (p->gdt[g].flags & BG_INODE_TABLE_UNINIT) != 0;
+    }
+    if (!uninit) {
+        return 0;
+    }
+
+    if (pthread_create(&p->lazy_init_thread, NULL, lazy_init_task, p) != 0) {
+        logger->warn("Unable to start the lazy initialization, the inode tables will be zeroed on first use.");
+        return 0;
+    }
+    p->lazy_init_running = true;
+    logger->trace("Lazy initialization started.");
+    return 0;
+}
+
+int stop_lazy_init(partition_t *p) {
+    if (p->lazy_init_running) {
+        pthread_mutex_lock(&p->lazy_init_lock);
+        p->lazy_init_stop = true;
+        pthread_mutex_unlock(&p->lazy_init_lock);
+
+        if (pthread_join(p->lazy_init_thread, NULL) != 0) {
+            logger->error("An error occurred when trying to stop the lazy initialization.");
+            return -1;
+        }
+        p->lazy_init_running = false;
+    }
+
+    pthread_mutex_destroy(&p->lazy_init_lock);
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file lazy_init.h
+ * @brief This file contains the operations used to zero the metadata regions left uninitialized by mkfs.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def LAZY_INIT_STEP The number of inode table blocks zeroed by the background task at each step.
+ */
+#define LAZY_INIT_STEP 64
+
+/**
+ * @def LAZY_INIT_DELAY_US The pause (in microseconds) of the background task between two steps.
+ */
+#define LAZY_INIT_DELAY_US 1000
+
+/**
+ * @brief Writes the uninitialized flags and the initialization marks of a group descriptor on the disk.
+ * @param p The partition.
+ * @param g The index of the group.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int persist_lazy_init(partition_t *p, uint32_t g);
+
+/**
+ * @brief Makes sure the inode table block holding the specified inode has been zeroed.
+ * @param p The partition.
+ * @param i The index of the inode about to be written.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int lazy_init_inode_table(partition_t *p, uint32_t i);
+
+/**
+ * @brief Moves the initialization mark of a bitmap after its blocks have been written on the disk.
+ * @param p The partition.
+ * @param b The bitmap.
+ * @param upto The number of blocks of the bitmap now initialized.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int lazy_init_bitmap(partition_t *p, bitmap_t *b, uint32_t upto);
+
+/**
+ * @brief Starts the background task zeroing the rest of the inode tables, if needed.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int start_lazy_init(partition_t *p);
+
+/**
+ * @brief Stops the background task and waits for it to finish its current step.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int stop_lazy_init(partition_t *p);
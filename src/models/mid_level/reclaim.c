@@ -0,0 +1,53 @@
+/**
+ * @file reclaim.c
+ * @brief This file contains the implementation of the background reclamation of the data blocks.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include "logging/logging.h"
+
+#include "block_queue.h"
+#include "data.h"
+#include "reclaim.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Drops a batch of references.
+ * @param arg The partition.
+ * @param blocks The data blocks.
+ * @param nb_blocks The number of blocks.
+ * @return 0, the reclaimer keeps going after an error.
+ */
+static int reclaim_blocks(void *arg, uint32_t *blocks, uint32_t nb_blocks) {
+    if (unref_data_batch((partition_t*) arg, blocks, nb_blocks) == -1) {
+        logger->error("An error occurred when trying to reclaim data blocks.");
+    }
+    return 0;
+}
+
+int start_reclaim(partition_t *p) {
+    if (start_block_queue(&p->reclaim, reclaim_blocks, p, RECLAIM_BATCH, RECLAIM_QUEUE_MAX) == -1) {
+        logger->error("An error occurred when trying to start the reclaimer.");
+        return -1;
+    }
+    return 0;
+}
+
+int reclaim_data(partition_t *p, uint32_t i) {
+    // Without room in the queue, the reference is dropped right away
+    if (push_block_queue(&p->reclaim, i) == -1) {
+        return unref_data(p, i);
+    }
+    return 0;
+}
+
+int flush_reclaim(partition_t *p) {
+    return flush_block_queue(&p->reclaim);
+}
+
+int stop_reclaim(partition_t *p) {
+    return stop_block_queue(&p->reclaim);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file reclaim.h
+ * @brief This file contains the background reclamation of the data blocks of the deleted and truncated files.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def RECLAIM_BATCH The number of references that wakes the reclaimer up.
+ */
+#define RECLAIM_BATCH 1024
+
+/**
+ * @def RECLAIM_QUEUE_MAX The number of references the reclaimer can hold, the next ones are dropped right away.
+ */
+#define RECLAIM_QUEUE_MAX (1 << 20)
+
+/**
+ * @brief Starts the background task dropping the references handed to it.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int start_reclaim(partition_t *p);
+
+/**
+ * @brief Hands a reference to a data block to the reclaimer. The block stays used until the reclaimer drops it.
+ * @param p The mounted partition.
+ * @param i The index of the data block.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int reclaim_data(partition_t *p, uint32_t i);
+
+/**
+ * @brief Drops the references handed to the reclaimer in the calling thread, so that their blocks can be allocated.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int flush_reclaim(partition_t *p);
+
+/**
+ * @brief Stops the reclaimer, after it has dropped the references it still holds.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int stop_reclaim(partition_t *p);
@@ -0,0 +1,201 @@
+/**
+ * @file sync.c
+ * @brief This file contains the implementation of the syncs of the mounted partitions.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logging/logging.h"
+
+#include "../low_level/block.h"
+#include "checksum.h"
+#include "data_bitmap.h"
+#include "group.h"
+#include "inode_bitmap.h"
+#include "sync.h"
+
+extern logger_t *logger;
+
+/**
+ * @brief Syncs the image of the partition.
+ * @param p The partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int sync_image(partition_t *p) {
+    if (fdatasync(p->fd) == -1) {
+        logger->error("An error occurred when trying to sync the partition.");
+        return -1;
+    }
+    __atomic_add_fetch(&p->sync.nb_syncs, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief The background task syncing the partition at regular intervals.
+ * @param arg The partition.
+ * @return NULL.
+ */
+static void* sync_task(void *arg) {
+    partition_t *p = (partition_t*) arg;
+    sync_t *s = &p->sync;
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += s->interval_ms / 1000;
+        deadline.tv_nsec += (long) (s->interval_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        // The condition is also signaled by the syncs of the other threads, which do not move the deadline
+        int waited = 0;
+        while (!s->stop && waited != ETIMEDOUT) {
+            waited = pthread_cond_timedwait(&s->cond, &s->lock, &deadline);
+        }
+        if (s->stop) {
+            break;
+        }
+        pthread_mutex_unlock(&s->lock);
+        // The metadata is written first, under the locks the operations take, so that the sync persists it too
+        flush_partition(p);
+        sync_partition(p);
+        pthread_mutex_lock(&s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+int write_super_bloc(partition_t *p) {
+    if (update_bloc(p, &p->super_bloc, sizeof(super_bloc_t), 0, 0) == -1) {
+        logger->error("An error occurred when trying to write the superblock to the partition.");
+        return -1;
+    }
+    return 0;
+}
+
+int flush_partition(partition_t *p) {
+    // Each region is written even if another one fails
+    int ret = 0;
+    if (update_databitmap(p) == -1) {
+        ret = -1;
+    }
+    if (update_inodebitmap(p) == -1) {
+        ret = -1;
+    }
+    if (update_groups(p) == -1) {
+        ret = -1;
+    }
+    if (update_checksums(p) == -1) {
+        ret = -1;
+    }
+
+    // The lock of the fragment blocks keeps their block and its cursor consistent in the copy written
+    pthread_mutex_lock(&p->frag_lock);
+    if (write_super_bloc(p) == -1) {
+        ret = -1;
+    }
+    pthread_mutex_unlock(&p->frag_lock);
+
+    if (ret == -1) {
+        logger->error("An error occurred when trying to write the metadata of the partition.");
+    }
+    return ret;
+}
+
+int start_sync(partition_t *p, durability_t durability, uint32_t interval_ms) {
+    sync_t *s = &p->sync;
+    s->durability = durability;
+    s->interval_ms = interval_ms == 0 ? SYNC_INTERVAL_MS : interval_ms;
+    s->requested = 0;
+    s->completed = 0;
+    s->nb_syncs = 0;
+    s->syncing = false;
+    s->running = false;
+    s->stop = false;
+    if (pthread_mutex_init(&s->lock, NULL) != 0 || pthread_cond_init(&s->cond, NULL) != 0) {
+        logger->error("An error occurred when trying to create the lock of the syncs.");
+        return -1;
+    }
+
+    if (durability == DURABILITY_PERIODIC) {
+        if (pthread_create(&s->thread, NULL, sync_task, p) != 0) {
+            logger->error("An error occurred when trying to start the periodic sync.");
+            return -1;
+        }
+        s->running = true;
+    }
+    return 0;
+}
+
+int sync_partition(partition_t *p) {
+    sync_t *s = &p->sync;
+    int ret = 0;
+
+    pthread_mutex_lock(&s->lock);
+    // A sync that started before the request may have missed its writes: the request needs one that starts after it
+    uint64_t ticket = ++s->requested;
+    while (s->completed < ticket) {
+        if (s->syncing) {
+            pthread_cond_wait(&s->cond, &s->lock);
+            continue;
+        }
+
+        // This thread syncs for all the requests made so far
+        uint64_t served = s->requested;
+        s->syncing = true;
+        pthread_mutex_unlock(&s->lock);
+        ret = sync_image(p);
+        pthread_mutex_lock(&s->lock);
+        s->syncing = false;
+        if (ret == 0) {
+            s->completed = served;
+        }
+        pthread_cond_broadcast(&s->cond);
+        if (ret == -1) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ret;
+}
+
+int commit_sync(partition_t *p) {
+    if (p->sync.durability == DURABILITY_GROUP) {
+        return sync_partition(p);
+    }
+    if (p->sync.durability == DURABILITY_SYNC) {
+        return sync_image(p);
+    }
+    return 0;
+}
+
+int stop_sync(partition_t *p) {
+    sync_t *s = &p->sync;
+    int ret = 0;
+    if (s->running) {
+        pthread_mutex_lock(&s->lock);
+        s->stop = true;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->lock);
+
+        if (pthread_join(s->thread, NULL) != 0) {
+            logger->error("An error occurred when trying to stop the periodic sync.");
+            ret = -1;
+        }
+        s->running = false;
+    }
+
+    if (s->durability != DURABILITY_NONE && sync_image(p) == -1) {
+        ret = -1;
+    }
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    return ret;
+}
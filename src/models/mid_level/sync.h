@@ -0,0 +1,68 @@
+/**
+ * @file sync.h
+ * @brief This file contains the operations used to put the changes of a mounted partition on the disk.
+ * @author Thomas REMY
+ * @version 1.0.0
+ * @date 10-19-2026
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "unix_fs_sim/ufs.h"
+
+#include "../../ufs.priv.h"
+
+/**
+ * @def SYNC_INTERVAL_MS The default time (in milliseconds) between two syncs with DURABILITY_PERIODIC.
+ */
+#define SYNC_INTERVAL_MS 5000
+
+/**
+ * @brief Prepares the syncs of a partition, and starts the background task syncing it with DURABILITY_PERIODIC.
+ * @param p The mounted partition.
+ * @param durability When the changes reach the disk.
+ * @param interval_ms The time between two syncs of the background task, 0 for SYNC_INTERVAL_MS.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int start_sync(partition_t *p, durability_t durability, uint32_t interval_ms);
+
+/**
+ * @brief Writes the superblock, which holds the number of entries of the root directory and the cursor of the
+ * fragment blocks.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int write_super_bloc(partition_t *p);
+
+/**
+ * @brief Writes back the metadata changed by the operations: the bitmaps, the group descriptors, the checksums and the
+ * superblock.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int flush_partition(partition_t *p);
+
+/**
+ * @brief Waits for everything written on the partition so far to be on the disk. A request made while a sync is
+ * running waits for the next one, which serves all the requests made in the meantime.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int sync_partition(partition_t *p);
+
+/**
+ * @brief Ends an operation as the durability of the partition asks: a shared sync with DURABILITY_GROUP, a sync of
+ * its own with DURABILITY_SYNC, nothing otherwise.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int commit_sync(partition_t *p);
+
+/**
+ * @brief Stops the background task, after a last sync if the partition is not DURABILITY_NONE.
+ * @param p The mounted partition.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+int stop_sync(partition_t *p);
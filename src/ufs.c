@@ -12,19 +12,37 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "logging/logging.h"
 #include "unix_fs_sim/ufs.h"
 
 #include "ufs.priv.h"
+#include "models/high_level/analysis.h"
+#include "models/high_level/clone.h"
+#include "models/high_level/defrag.h"
 #include "models/high_level/directory.h"
 #include "models/high_level/file.h"
+#include "models/high_level/fsck.h"
+#include "models/high_level/namespace.h"
+#include "models/high_level/populate.h"
 #include "models/low_level/block.h"
+#include "models/low_level/direct_io.h"
+#include "models/mid_level/bitmap.h"
+#include "models/mid_level/cache.h"
+#include "models/mid_level/checksum.h"
 #include "models/mid_level/data.h"
 #include "models/mid_level/data_bitmap.h"
+#include "models/mid_level/dedup.h"
+#include "models/mid_level/dentry.h"
+#include "models/mid_level/discard.h"
+#include "models/mid_level/group.h"
 #include "models/mid_level/inode.h"
 #include "models/mid_level/inode_bitmap.h"
+#include "models/mid_level/lazy_init.h"
+#include "models/mid_level/reclaim.h"
+#include "models/mid_level/sync.h"
 
 extern logger_t *logger;
 
@@ -35,7 +53,9 @@ partition_t init_partition(int fd, super_bloc_t super_bloc) {
 
     p.fd = fd;
     p.super_bloc = super_bloc;
+    p.opened_files = NULL;
     p.nb_opened_files = 0;
+    p.opened_files_capacity = 0;
 
     return p;
 }
@@ -80,6 +100,16 @@ int mkpart(char *path, size_t size, size_unit_t unit) {
 }
 
 int mkfs(char *path, block_size_t block_size, uint8_t nb_inodes) {
+    mkfs_options_t options = {
+            .block_size = block_size,
+            .nb_inodes = nb_inodes,
+            .blocks_per_group = 0,
+            .features = FS_FEATURE_CHECKSUM
+    };
+    return mkfs_with_options(path, options);
+}
+
+int mkfs_with_options(char *path, mkfs_options_t options) {
     if (access(path, F_OK) != 0) {
         char log_buf[1024];
         sprintf(log_buf, "This partition does not exists: %s", path);
@@ -93,27 +123,28 @@ int mkfs(char *path, block_size_t block_size, uint8_t nb_inodes) {
         return -1;
     }
 
+    off_t partition_size;
+    if ((partition_size = lseek(fd, 0, SEEK_END)) == -1) {
+        logger->error("An error occurred when trying to move the head.");
+        close(fd);
+        return -1;
+    }
+
     super_bloc_t super_bloc = {
             .magic_number = MAGIC_NUMBER,
-            .block_size = block_size,
-            .nb_blocks = (uint32_t) floor((double)lseek(fd, 0, SEEK_END) / (double) block_size)
+            .block_size = options.block_size,
+            .nb_blocks = (uint32_t) (partition_size / options.block_size)
     };
-    super_bloc.nb_inode_blocks = (uint32_t) ceil((double) super_bloc.nb_blocks * 0.10); // TODO : Implémenter le formatage avec un nombre d'inodes dynamique
-    super_bloc.nb_inodes = super_bloc.nb_inode_blocks * sizeof(inode_t);
-    super_bloc.nb_inodes_free = super_bloc.nb_inodes;
-    uint32_t nb_data_total = super_bloc.nb_blocks - 1 - (uint32_t) ceil((double) super_bloc.nb_inodes / (double) super_bloc.block_size) - super_bloc.nb_inode_blocks;
-    super_bloc.nb_data = nb_data_total - (uint32_t) ceil((double) nb_data_total / (double) super_bloc.block_size);
-    super_bloc.nb_data_free = super_bloc.nb_data;
-
-    partition_t *p = (partition_t*) malloc(sizeof(partition_t));
 
+    partition_t *p = (partition_t*) calloc(1, sizeof(partition_t));
     p->fd = fd;
-    p->super_bloc = super_bloc;
-
-    if (lseek(fd, 0, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+    if (layout_groups(&super_bloc, options, &p->gdt) == -1) {
+        logger->error("The partition is too small to hold a filesystem.");
+        close(fd);
+        free(p);
         return -1;
     }
+    p->super_bloc = super_bloc;
 
     if (create_databitmap(p) == -1) {
         logger->error("An error occurred when trying to create the data bitmap.");
@@ -125,27 +156,51 @@ int mkfs(char *path, block_size_t block_size, uint8_t nb_inodes) {
         return -1;
     }
 
-    for (int i = 0; i < (int) ceil((double) (p->super_bloc.nb_inodes * sizeof(dir_entry_t)) / (double) p->super_bloc.block_size); ++i) {
-        if (create_data(p, i) == -1) {
-            logger->error("An error occurred when trying to create root dir data.");
-            return -1;
-        }
+    if (create_directory(p) == -1) {
+        logger->error("An error occurred when trying to create root dir data.");
+        return -1;
+    }
+
+    if ((p->super_bloc.flags & FS_FEATURE_DEDUP) && create_dedup_index(p) == -1) {
+        logger->error("An error occurred when trying to create the deduplication index.");
+        return -1;
+    }
+
+    if ((p->super_bloc.flags & FS_FEATURE_CHECKSUM) && create_checksums(p) == -1) {
+        logger->error("An error occurred when trying to create the checksums.");
+        return -1;
+    }
+
+    if (options.root_dir != NULL && populate_from_directory(p, options.root_dir) == -1) {
+        logger->error("An error occurred when trying to copy the files of the directory.");
+        return -1;
     }
 
-    if (update_databitmap(p) == -1) {
-        logger->error("An error occurred when trying to update the data bitmap.");
+    if (create_groups(p) == -1) {
+        logger->error("An error occurred when trying to create the block groups.");
         return -1;
     }
 
-    if (update_bloc(p, &p->super_bloc, sizeof(super_bloc_t), 0, 0) == -1) {
+    void *super_bloc_buf;
+    if (posix_memalign(&super_bloc_buf, options.block_size, options.block_size) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    memset(super_bloc_buf, 0, options.block_size);
+    memcpy(super_bloc_buf, &p->super_bloc, sizeof(super_bloc_t));
+    if (write_bloc(p, super_bloc_buf, 0) == -1) {
         logger->error("An error occurred when trying to write the superblock to the partition.");
+        free(super_bloc_buf);
         return -1;
     }
+    free(super_bloc_buf);
 
     if (close(fd) == -1) {
         logger->error("An error occurred when trying to close the partition.");
         return -1;
     }
+    free(p->gdt);
+    free(p);
     logger->info("Filesystem created.");
     return 0;
 }
@@ -155,6 +210,14 @@ int my_format(char *partition_name) {
 }
 
 int mount(char *path) {
+    mount_options_t options = {
+            .durability = DURABILITY_NONE,
+            .sync_interval_ms = 0
+    };
+    return mount_with_options(path, options);
+}
+
+int mount_with_options(char *path, mount_options_t options) {
     if (access(path, F_OK) != 0) {
         char log_buf[1024];
         sprintf(log_buf, "This partition does not exists: %s", path);
@@ -169,262 +232,1451 @@ int mount(char *path) {
     }
 
     super_bloc_t super_bloc;
-    if (lseek(fd, 0, SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+    if (pread(fd, &super_bloc, sizeof(super_bloc_t), 0) != sizeof(super_bloc_t)) {
+        logger->error("An error occurred when trying to read the superblock.");
         return -1;
     }
-    if (read(fd, &super_bloc.magic_number, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the magic number.");
+    if (super_bloc.magic_number != MAGIC_NUMBER) {
+        logger->error("This partition does not contain a filesystem.");
         return -1;
     }
-    if (read(fd, &super_bloc.block_size, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the bloc size.");
+
+    partition_t *p = (partition_t*) calloc(1, sizeof(partition_t));
+    p->fd = fd;
+    p->super_bloc = super_bloc;
+    p->nb_opened_files = 0;
+    if (options.direct_io && start_direct_io(p) == -1) {
+        logger->error("An error occurred when trying to mount the partition with direct I/O.");
         return -1;
     }
-    if (read(fd, &super_bloc.nb_blocks, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the number of blocks.");
+    // Only the superblock and the group descriptors are read here, the bitmaps and the directory are loaded when first touched
+    if (read_groups(p) == -1 || read_databitmap(p) == -1 || read_inodebitmap(p) == -1 || read_directory(p) == -1
+        || read_checksums(p) == -1 || init_cache(p) == -1 || init_dentries(p) == -1) {
+        logger->error("An error occurred when trying to load the partition metadata.");
         return -1;
     }
-    if (read(fd, &super_bloc.nb_data, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the number of data blocks.");
+    if (pthread_mutex_init(&p->frag_lock, NULL) != 0 || pthread_mutex_init(&p->dedup_lock, NULL) != 0
+        || pthread_mutex_init(&p->open_lock, NULL) != 0) {
+        logger->error("An error occurred when trying to initialize the allocator locks.");
         return -1;
     }
-    if (read(fd, &super_bloc.nb_data_free, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the number of free data blocks.");
+    if (start_lazy_init(p) == -1) {
+        logger->error("An error occurred when trying to start the lazy initialization.");
         return -1;
     }
-    if (read(fd, &super_bloc.nb_inodes, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the number of inodes.");
+    if (start_discard(p) == -1) {
+        logger->error("An error occurred when trying to start the discard of the freed blocks.");
         return -1;
     }
-    if (read(fd, &super_bloc.nb_inodes_free, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the number of free inodes.");
+    if (start_reclaim(p) == -1) {
+        logger->error("An error occurred when trying to start the reclaimer.");
         return -1;
     }
-    if (read(fd, &super_bloc.nb_inode_blocks, sizeof(uint32_t)) == -1) {
-        logger->error("An error occurred when trying to read the number of inode blocks.");
+    if (start_sync(p, options.durability, options.sync_interval_ms) == -1) {
+        logger->error("An error occurred when trying to start the syncs of the partition.");
         return -1;
     }
 
-    partition_t *p = (partition_t*) malloc(sizeof(partition_t));
-    p->fd = fd;
-    p->super_bloc = super_bloc;
-    p->nb_opened_files = 0;
-    p->data_bitmap = (uint8_t*) malloc(super_bloc.nb_data * sizeof(uint8_t));
-    p->inode_bitmap = (uint8_t*) malloc(super_bloc.nb_inodes * sizeof(uint8_t));
-    p->directory = (dir_entry_t*) malloc(super_bloc.nb_inodes * sizeof(dir_entry_t));
-    read_databitmap(p);
-    read_inodebitmap(p);
-    read_directory(p);
-
     p_mounted = p;
     logger->info("Partition mounted.");
     return 0;
 }
 
+/**
+ * @brief Makes room in the table of the opened files, doubling it as long as it is too small. The lock of the opened
+ * files must be held until the files are added to the table.
+ * @param p The partition.
+ * @param n The number of files about to be opened.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int reserve_opened_files(partition_t *p, uint32_t n) {
+    if (p->nb_opened_files + n > MAX_OPENED_FILES) {
+        logger->error("Too many files are opened.");
+        return -1;
+    }
+    if (p->nb_opened_files + n <= p->opened_files_capacity) {
+        return 0;
+    }
+
+    uint32_t capacity = p->opened_files_capacity == 0 ? OPENED_FILES_INITIAL : p->opened_files_capacity;
+    while (capacity < p->nb_opened_files + n) {
+        capacity *= 2;
+    }
+    file_t **table;
+    if ((table = (file_t**) realloc(p->opened_files, capacity * sizeof(file_t*))) == NULL) {
+        logger->error("An error occurred when trying to allocate the table of the opened files.");
+        return -1;
+    }
+    p->opened_files = table;
+    p->opened_files_capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Ends an operation: writes back the metadata it changed and, if the durability asks for it, waits for the
+ * operation to be on the disk.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int commit_operation(void) {
+    if (flush_partition(p_mounted) == -1 || commit_sync(p_mounted) == -1) {
+        logger->error("An error occurred when trying to put the operation on the disk.");
+        return -1;
+    }
+    return 0;
+}
+
 file_t* my_open(char *file_name) {
-    dir_entry_t *main_dir = p_mounted->directory;
+    // The lock is held until the file is in the table, so that it is not deleted or created twice in the meantime
+    pthread_mutex_lock(&p_mounted->open_lock);
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    if (resolve_parent(p_mounted, file_name, ROOT_DIRECTORY, &dir, name) == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to find the directory of the file.");
+        return NULL;
+    }
+    if (name[0] == '\0') {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("You are trying to open a directory.");
+        return NULL;
+    }
 
-    int i = 0;
-    while (!strcmp(file_name, main_dir[i].name) && i < (p_mounted->super_bloc.nb_inodes - p_mounted->super_bloc.nb_inodes_free)) {
-        i++;
+    uint32_t inode;
+    uint32_t file_type;
+    int found;
+    if ((found = lookup_name(p_mounted, dir, name, &inode, &file_type)) == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        return NULL;
+    }
+    if (found && file_type == FILE_TYPE_DIRECTORY) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("You are trying to open a directory.");
+        return NULL;
     }
 
-    file_t *f = (file_t*) malloc(sizeof(file_t));
-    if (i < (p_mounted->super_bloc.nb_inodes - p_mounted->super_bloc.nb_inodes_free)) {
-        f->inode = main_dir[i].inode;
+    file_t *f;
+    if (reserve_opened_files(p_mounted, 1) == -1 || (f = (file_t*) calloc(1, sizeof(file_t))) == NULL) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to open the file.");
+        return NULL;
+    }
+    if (found) {
+        f->inode = inode;
     } else {
-        if ((f->inode = create_file(file_name, p_mounted)) == -1) {
+        if ((f->inode = create_file(name, p_mounted, dir, FILE_TYPE_REGULAR)) == (uint32_t) -1) {
+            pthread_mutex_unlock(&p_mounted->open_lock);
             logger->error("An error occurred when trying to create the file.");
+            free(f);
             return NULL;
         }
     }
 
-    strcpy(f->name, file_name);
+    strcpy(f->name, name);
     f->offset = 0;
-    update_databitmap(p_mounted);
-    update_inodebitmap(p_mounted);
+    // Only the creation of the file has to wait for the disk
+    if (flush_partition(p_mounted) == -1 || (!found && commit_sync(p_mounted) == -1)) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to put the operation on the disk.");
+        free(f);
+        return NULL;
+    }
     p_mounted->opened_files[p_mounted->nb_opened_files++] = f;
+    pthread_mutex_unlock(&p_mounted->open_lock);
     logger->info("File opened.");
     return f;
 }
 
-int my_write(file_t *f, void *buffer, int nb_bytes) {
-    inode_t i;
-    read_inode(p_mounted, &i, f->inode);
-    uint32_t start_size = i.memory_size_data;
-    int write_pos = floor((double) f->offset / (double) p_mounted->super_bloc.block_size);
-    if (write_pos >= NB_DATA_BLOCKS_INODE) {
-        logger->error("Max size reached. Impossible to write here.");
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+/**
+ * @struct missing_name_t
+ * @brief A name to create in a directory.
+ * @var dir The inode of the directory.
+ * @var name The name.
+ * @var position The index of the path in the list being resolved.
+ */
+typedef struct {
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    uint32_t position;
+} missing_name_t;
+
+static int compare_missing(const void *a, const void *b) {
+    const missing_name_t *x = (const missing_name_t*) a;
+    const missing_name_t *y = (const missing_name_t*) b;
+    if (x->dir != y->dir) {
+        return x->dir < y->dir ? -1 : 1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+/**
+ * @brief Creates the missing files of a batch, together for each directory.
+ * @param missing The files to create, sorted by directory and name.
+ * @param nb_missing The number of files.
+ * @param inodes Where to store the inode of each file, at its position.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int create_missing(missing_name_t *missing, uint32_t nb_missing, uint32_t *inodes) {
+    char **names = (char**) malloc(nb_missing * sizeof(char*));
+    uint32_t *created = (uint32_t*) malloc(nb_missing * sizeof(uint32_t));
+    if (names == NULL || created == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(names);
+        free(created);
         return -1;
     }
 
-    off_t write_offset = i.memory_size_data - (write_pos * p_mounted->super_bloc.block_size);
-    off_t block_offset = get_data_offset(p_mounted, i.data_blocks[write_pos]);
+    int ret = 0;
+    for (uint32_t first = 0; first < nb_missing && ret == 0;) {
+        // The names of a directory are created and merged into it at once, a name given twice is created once
+        uint32_t nb_names = 0;
+        uint32_t last = first;
+        for (; last < nb_missing && missing[last].dir == missing[first].dir; last++) {
+            if (last == first || strcmp(missing[last - 1].name, missing[last].name) != 0) {
+                names[nb_names++] = missing[last].name;
+            }
+        }
+        if ((ret = create_files(p_mounted, missing[first].dir, names, nb_names, created, FILE_TYPE_REGULAR)) == 0) {
+            for (uint32_t m = first, n = 0; m < last; m++) {
+                if (m > first && strcmp(missing[m - 1].name, missing[m].name) != 0) {
+                    n++;
+                }
+                inodes[missing[m].position] = created[n];
+            }
+        }
+        first = last;
+    }
+    free(names);
+    free(created);
+    return ret;
+}
 
-    if (update_bloc(p_mounted, buffer, nb_bytes, block_offset / p_mounted->super_bloc.block_size, f->offset) == -1) {
-        logger->error("An error occurred when trying to write to the file.");
+/**
+ * @brief Looks up the inodes of a sorted list of unique paths, creating the missing files together.
+ * @param paths The paths, sorted and unique.
+ * @param nb_paths The number of paths.
+ * @param inodes Where to store the inode of each path.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int resolve_names(char **paths, uint32_t nb_paths, uint32_t *inodes) {
+    missing_name_t *missing;
+    if ((missing = (missing_name_t*) malloc(nb_paths * sizeof(missing_name_t))) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
         return -1;
     }
 
-    if (nb_bytes <= 0) {
-        i.memory_size_data += nb_bytes;
-        update_inode(p_mounted, i, f->inode);
-        return nb_bytes;
+    uint32_t nb_missing = 0;
+    for (uint32_t u = 0; u < nb_paths; u++) {
+        missing_name_t *m = missing + nb_missing;
+        uint32_t file_type;
+        int found;
+        if (resolve_parent(p_mounted, paths[u], ROOT_DIRECTORY, &m->dir, m->name) == -1 || m->name[0] == '\0'
+            || (found = lookup_name(p_mounted, m->dir, m->name, inodes + u, &file_type)) == -1
+            || (found && file_type == FILE_TYPE_DIRECTORY)) {
+            logger->error("This path cannot be opened as a file.");
+            free(missing);
+            return -1;
+        }
+        if (!found) {
+            m->position = u;
+            nb_missing++;
+        }
     }
 
-    size_t nb_blocks_to_write = floor((double) nb_bytes / (double) p_mounted->super_bloc.block_size);
-    for (int j = 0; j < nb_blocks_to_write; ++j) {
-        uint32_t new_data_block;
-        if ((new_data_block = next_free_data(p_mounted)) == -1) {
-            logger->error("An error occurred when trying to find a new free data block.");
+    qsort(missing, nb_missing, sizeof(missing_name_t), compare_missing);
+    int ret = create_missing(missing, nb_missing, inodes);
+    free(missing);
+    return ret;
+}
+
+int my_open_many(char **file_names, int nb_files, file_t **files) {
+    if (file_names == NULL || files == NULL || nb_files < 0) {
+        logger->error("You are trying to open an invalid list of files.");
+        return -1;
+    }
+    for (int k = 0; k < nb_files; k++) {
+        if (file_names[k] == NULL || strlen(file_names[k]) >= MAX_PATHNAME) {
+            logger->error("The path of a file is too long.");
             return -1;
         }
-        if (create_data(p_mounted, new_data_block) == -1) {
-            logger->error("An error occurred when trying to create data.");
+    }
+    if (nb_files == 0) {
+        return 0;
+    }
+
+    char **names = (char**) malloc(nb_files * sizeof(char*));
+    uint32_t *inodes = (uint32_t*) malloc(nb_files * sizeof(uint32_t));
+    if (names == NULL || inodes == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(names);
+        free(inodes);
+        return -1;
+    }
+    // The lock is held until the files are in the table, like my_open does
+    pthread_mutex_lock(&p_mounted->open_lock);
+    if (reserve_opened_files(p_mounted, nb_files) == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        free(names);
+        free(inodes);
+        return -1;
+    }
+    memcpy(names, file_names, nb_files * sizeof(char*));
+    qsort(names, nb_files, sizeof(char*), compare_names);
+    uint32_t nb_names = 0;
+    for (int k = 0; k < nb_files; k++) {
+        if (nb_names == 0 || strcmp(names[nb_names - 1], names[k]) != 0) {
+            names[nb_names++] = names[k];
         }
-        i.data_blocks[write_pos + j] = new_data_block;
-        update_inode(p_mounted, i, f->inode);
+    }
 
-        if (j < nb_blocks_to_write - 1) {
-            if (update_data(p_mounted, (uint8_t*) buffer, new_data_block) == -1) {
-                logger->error("An error occurred when trying to write data in a new block.");
-                return -1;
-            }
-        } else {
-            if (update_bloc(p_mounted, buffer, nb_bytes, new_data_block, 0) == -1) {
-                logger->error("An error occurred when trying to write data in a new block.");
-                return i.memory_size_data - start_size;
+    int ret = resolve_names(names, nb_names, inodes);
+    for (int k = 0; k < nb_files && ret == 0; k++) {
+        char **name = (char**) bsearch(file_names + k, names, nb_names, sizeof(char*), compare_names);
+        if ((files[k] = (file_t*) calloc(1, sizeof(file_t))) == NULL) {
+            logger->error("An error occurred when trying to allocate memory.");
+            for (int j = 0; j < k; j++) {
+                free(files[j]);
             }
+            ret = -1;
+            break;
         }
+        const char *last = strrchr(file_names[k], '/');
+        strncpy(files[k]->name, last != NULL ? last + 1 : file_names[k], MAX_FILENAME - 1);
+        files[k]->inode = inodes[name - names];
+    }
+    free(names);
+    free(inodes);
+    if (ret == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to open the files.");
+        return -1;
     }
-    i.memory_size_data += nb_bytes;
-    update_inode(p_mounted, i, f->inode);
-    logger->info("Data written.");
-    f->offset += nb_bytes;
-    return nb_bytes;;
-}
 
-int my_read(file_t *f, void *buffer, int nb_bytes) {
-    inode_t i;
-    read_inode(p_mounted, &i, f->inode);
+    for (int k = 0; k < nb_files; k++) {
+        p_mounted->opened_files[p_mounted->nb_opened_files++] = files[k];
+    }
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    if (commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("Files opened.");
+    return nb_files;
+}
 
-    int first_bloc = (int) floor((double) f->offset / (double) p_mounted->super_bloc.block_size);
-    int real_nbytes_to_read = nb_bytes > (i.memory_size_data - first_bloc * p_mounted->super_bloc.block_size)
-            ? i.memory_size_data - first_bloc * p_mounted->super_bloc.block_size
-            : nb_bytes;
-    int last_bloc = (int) floor((double) first_bloc + (double) (real_nbytes_to_read / p_mounted->super_bloc.block_size));
-    int nb_read = 0;
-    if (lseek(p_mounted->fd, get_data_offset(p_mounted, i.data_blocks[first_bloc]) + (f->offset - (first_bloc * p_mounted->super_bloc.block_size)), SEEK_SET) == -1) {
-        logger->error("An error occurred when trying to move the head.");
+int my_mkdir(char *path) {
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    if (resolve_parent(p_mounted, path, ROOT_DIRECTORY, &dir, name) == -1 || name[0] == '\0') {
+        logger->error("An error occurred when trying to find the parent of the directory.");
         return -1;
     }
-    for (int j = first_bloc; j <= last_bloc; j++) {
-        if (lseek(p_mounted->fd, nb_read, SEEK_CUR) == -1) {
-            logger->error("An error occurred when trying to move the head.");
-            return -1;
-        }
-        int b_to_read = ((real_nbytes_to_read - nb_read) / p_mounted->super_bloc.block_size) >= 1
-                ? p_mounted->super_bloc.block_size
-                : real_nbytes_to_read - nb_read;
-        if (read(p_mounted->fd, buffer + nb_read, b_to_read) == -1) {
-            logger->error("An error occurred when trying to read the file.");
-            return -1;
+
+    uint32_t inode;
+    uint32_t file_type;
+    int found;
+    if ((found = lookup_name(p_mounted, dir, name, &inode, &file_type)) != 0) {
+        if (found == 1) {
+            logger->error("This path already exists.");
         }
-        nb_read += b_to_read;
+        return -1;
+    }
+    if (create_file(name, p_mounted, dir, FILE_TYPE_DIRECTORY) == (uint32_t) -1) {
+        logger->error("An error occurred when trying to create the directory.");
+        return -1;
     }
-}
 
-void my_seek(file_t *f, int offset, int base) {
-    inode_t i;
-    switch (base) {
-        case SEEK_SET:
-            f->offset = offset;
-            break;
-        case SEEK_CUR:
-            f->offset += offset;
-            break;
-        case SEEK_END:
-            read_inode(p_mounted, &i, f->inode);
-            f->offset = i.memory_size_data - offset;
-        default:
-            logger->error("Base unrecognized.");
+    if (commit_operation() == -1) {
+        return -1;
     }
+    logger->info("Directory created.");
+    return 0;
 }
 
-size_t size(file_t *f) {
-    inode_t i;
-    read_inode(p_mounted, &i, f->inode);
+int my_rename(char *old_path, char *new_path) {
+    uint32_t old_dir;
+    char old_name[MAX_FILENAME];
+    uint32_t inode;
+    uint32_t file_type;
+    if (resolve_parent(p_mounted, old_path, ROOT_DIRECTORY, &old_dir, old_name) == -1 || old_name[0] == '\0'
+        || lookup_name(p_mounted, old_dir, old_name, &inode, &file_type) != 1) {
+        logger->error("There is no file with this path.");
+        return -1;
+    }
 
-    return i.memory_size_data;
-}
+    // A directory cannot become one of its own descendants, a file has no descendant to avoid (no inode has this index)
+    uint32_t new_dir;
+    char new_name[MAX_FILENAME];
+    uint32_t avoid = file_type == FILE_TYPE_DIRECTORY ? inode : p_mounted->super_bloc.nb_inodes + 1;
+    if (resolve_parent(p_mounted, new_path, avoid, &new_dir, new_name) == -1 || new_name[0] == '\0'
+        || (file_type == FILE_TYPE_DIRECTORY && new_dir == avoid)) {
+        logger->error("An error occurred when trying to find the new directory of the file.");
+        return -1;
+    }
+    if (new_dir == old_dir && strcmp(new_name, old_name) == 0) {
+        return 0;
+    }
 
-int umount() {
-    if (p_mounted == NULL) {
-        logger->error("There is no partition mounted.");
+    uint32_t existing;
+    uint32_t existing_type;
+    int found;
+    if ((found = lookup_name(p_mounted, new_dir, new_name, &existing, &existing_type)) != 0) {
+        if (found == 1) {
+            logger->error("The new path already exists.");
+        }
         return -1;
     }
 
-    if (close(p_mounted->fd) == -1) {
-        logger->error("An error occurred when trying to close the partition.");
+    // The new entry is added first, so that the file is never unreachable
+    dir_entry_t entry = {.inode = inode};
+    strcpy(entry.name, new_name);
+    if (add_entries(p_mounted, new_dir, &entry, 1, file_type) == -1 || remove_entry(p_mounted, old_dir, old_name) == -1) {
+        logger->error("An error occurred when trying to move the file.");
         return -1;
     }
 
-    free(p_mounted->data_bitmap);
-    free(p_mounted->inode_bitmap);
-    free(p_mounted->directory);
-    free(p_mounted);
-    p_mounted = NULL;
+    if (commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("File renamed.");
+    return 0;
+}
 
-    logger->info("Partition unmounted.");
+int my_unlink(char *path) {
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    uint32_t inode;
+    uint32_t file_type;
+    // The lock keeps the file from being opened, and the defragmentation from moving it, while it is deleted
+    pthread_mutex_lock(&p_mounted->open_lock);
+    if (resolve_parent(p_mounted, path, ROOT_DIRECTORY, &dir, name) == -1 || name[0] == '\0'
+        || lookup_name(p_mounted, dir, name, &inode, &file_type) != 1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("There is no file with this path.");
+        return -1;
+    }
+    if (file_type == FILE_TYPE_DIRECTORY) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("You are trying to unlink a directory.");
+        return -1;
+    }
+    for (uint32_t k = 0; k < p_mounted->nb_opened_files; k++) {
+        if (p_mounted->opened_files[k]->inode == inode) {
+            pthread_mutex_unlock(&p_mounted->open_lock);
+            logger->error("You are trying to unlink an opened file.");
+            return -1;
+        }
+    }
+
+    inode_t i;
+    if (read_inode(p_mounted, &i, inode) == -1 || remove_entry(p_mounted, dir, name) == -1
+        || delete_inode(p_mounted, inode) == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to delete the file.");
+        return -1;
+    }
+    // Only the references are queued here, the reclaimer frees the blocks by batches
+    int ret = reclaim_file_data(p_mounted, &i, 0);
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    if (ret == -1) {
+        logger->error("An error occurred when trying to give back the data of the file.");
+        return -1;
+    }
+
+    if (commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("File deleted.");
     return 0;
 }
 
-int my_close(file_t *f) {
-    if (f == NULL) {
-        logger->error("You are trying to close a file that does not exists.");
+int my_write(file_t *f, void *buffer, int nb_bytes) {
+    if (f == NULL || nb_bytes < 0) {
+        logger->error("You are trying to write to a file that does not exists.");
         return -1;
     }
 
-    if (p_mounted->nb_opened_files <= 0) {
-        logger->error("There is no file opened.");
+    inode_t i;
+    if (read_inode(p_mounted, &i, f->inode) == -1) {
+        logger->error("An error occurred when trying to read the inode of the file.");
         return -1;
     }
 
-    int i = 0;
-    while (i < p_mounted->nb_opened_files && p_mounted->opened_files[i] != f) {
-        i++;
+    uint32_t bs = p_mounted->super_bloc.block_size;
+    uint32_t max_size = NB_DATA_BLOCKS_INODE * bs;
+    if (f->offset >= max_size && nb_bytes > 0) {
+        logger->error("Max size reached. Impossible to write here.");
+        return -1;
     }
+    if ((uint32_t) nb_bytes > max_size - f->offset) {
+        nb_bytes = (int) (max_size - f->offset);
+    }
+    f->written = 1;
 
-    if (i >= p_mounted->nb_opened_files) {
-        logger->error("This file is not opened.");
+    if (i.flags & INODE_INLINE_DATA) {
+        if (f->offset + nb_bytes <= INLINE_DATA_SIZE) {
+            memcpy(i.inline_data + f->offset, buffer, nb_bytes);
+            f->offset += nb_bytes;
+            if (f->offset > i.memory_size_data) {
+                i.memory_size_data = f->offset;
+            }
+            i.last_modification = time(NULL);
+            if (update_inode(p_mounted, i, f->inode) == -1) {
+                logger->error("An error occurred when trying to update the inode of the file.");
+                return -1;
+            }
+            if (commit_sync(p_mounted) == -1) {
+                logger->error("An error occurred when trying to put the operation on the disk.");
+                return -1;
+            }
+            logger->info("Data written.");
+            return nb_bytes;
+        }
+
+        // The file outgrows its inode: its content moves to a data block before the write
+        if (uninline_file(p_mounted, f, &i) == -1) {
+            logger->error("An error occurred when trying to move the content of the file out of its inode.");
+            return -1;
+        }
+    }
+
+    // The tail is written in place, so it gets a block of its own again (it is packed back on close)
+    if ((i.flags & INODE_TAIL_PACKED) && nb_bytes > 0 && unpack_tail(p_mounted, f, &i) == -1) {
+        logger->error("An error occurred when trying to unpack the tail of the file.");
         return -1;
     }
 
-    p_mounted->opened_files[i] = NULL;
-    free(f);
-    f = NULL;
+    int written = 0;
+    if (has_clusters(&i)) {
+        // A compressed file is rewritten cluster by cluster
+        if ((written = write_clusters(p_mounted, f, &i, (const uint8_t*) buffer, nb_bytes)) == -1) {
+            return -1;
+        }
+    } else {
+        // The buffer is aligned on the blocks, so that it goes straight to the image with direct I/O
+        uint8_t *block;
+        if (posix_memalign((void**) &block, bs, bs) != 0) {
+            logger->error("An error occurred when trying to allocate memory.");
+            return -1;
+        }
 
-    update_databitmap(p_mounted);
-    update_inodebitmap(p_mounted);
+        // Each touched block is read, modified and written back, the missing ones are allocated on the way
+        while (written < nb_bytes) {
+            uint32_t pos = f->offset + written;
+            uint32_t k = pos / bs;
+            uint32_t in_block = pos % bs;
+            uint32_t left = (uint32_t) (nb_bytes - written);
+            uint32_t n = (bs - in_block < left) ? bs - in_block : left;
 
-    logger->info("File closed.");
+            if (i.data_blocks[k] == 0) {
+                memset(block, 0, bs);
+            } else if (n < bs && read_data(p_mounted, block, i.data_blocks[k]) == -1) {
+                logger->error("An error occurred when trying to read the file.");
+                break;
+            }
+
+            memcpy(block + in_block, (uint8_t*) buffer + written, n);
+            if (write_file_block(p_mounted, f, &i, k, block) == -1) {
+                logger->error("An error occurred when trying to write to the file.");
+                break;
+            }
+            written += n;
+        }
+        free(block);
+    }
+
+    f->offset += written;
+    if (f->offset > i.memory_size_data) {
+        i.memory_size_data = f->offset;
+    }
+    i.last_modification = time(NULL);
+    if (update_inode(p_mounted, i, f->inode) == -1) {
+        logger->error("An error occurred when trying to update the inode of the file.");
+        return -1;
+    }
+    // Without a sync to wait for, the bitmaps are written back when the file is closed
+    if (p_mounted->sync.durability >= DURABILITY_GROUP && commit_operation() == -1) {
+        return -1;
+    }
+
+    logger->info("Data written.");
+    return written;
+}
+
+int my_truncate(file_t *f, int size) {
+    uint32_t max_size = NB_DATA_BLOCKS_INODE * p_mounted->super_bloc.block_size;
+    if (f == NULL || size < 0 || (uint32_t) size > max_size) {
+        logger->error("You are trying to truncate a file that does not exists or to an invalid size.");
+        return -1;
+    }
+
+    inode_t i;
+    if (read_inode(p_mounted, &i, f->inode) == -1) {
+        logger->error("An error occurred when trying to read the inode of the file.");
+        return -1;
+    }
+    f->written = 1;
+    if (truncate_file(p_mounted, f, &i, (uint32_t) size) == -1) {
+        logger->error("An error occurred when trying to truncate the file.");
+        return -1;
+    }
+    i.last_modification = time(NULL);
+    if (update_inode(p_mounted, i, f->inode) == -1) {
+        logger->error("An error occurred when trying to update the inode of the file.");
+        return -1;
+    }
+    if (p_mounted->sync.durability >= DURABILITY_GROUP && commit_operation() == -1) {
+        return -1;
+    }
+
+    logger->info("File truncated.");
     return 0;
 }
 
-int fs_usage() {
-    if (p_mounted == NULL) {
-        logger->error("No partition mounted.");
+/**
+ * @brief Clones a file or a tree of directories and links the clone in a directory.
+ * @param src The inode to clone, ROOT_DIRECTORY for the root directory.
+ * @param file_type The FILE_TYPE_* of the source.
+ * @param dir The directory of the clone.
+ * @param name The name of the clone, which is not in the directory yet.
+ * @return 0 if everything went well, -1 otherwise.
+ */
+static int link_clone(uint32_t src, uint32_t file_type, uint32_t dir, const char *name) {
+    // Each snapshot would otherwise hold a clone of all the previous ones
+    uint32_t skip = ROOT_DIRECTORY;
+    uint32_t snapshots;
+    uint32_t snapshots_type;
+    if (src == ROOT_DIRECTORY && lookup_name(p_mounted, ROOT_DIRECTORY, SNAPSHOT_DIRECTORY, &snapshots, &snapshots_type) == 1) {
+        skip = snapshots;
+    }
+
+    // The lock keeps the files from being opened, and the defragmentation from moving them, while they are cloned
+    pthread_mutex_lock(&p_mounted->open_lock);
+    uint32_t clone = clone_tree(p_mounted, src, skip);
+    int ret = clone == p_mounted->super_bloc.nb_inodes + 1 ? -1 : 0;
+    if (ret == 0) {
+        dir_entry_t entry = {.inode = clone};
+        strncpy(entry.name, name, MAX_FILENAME - 1);
+        if (add_entries(p_mounted, dir, &entry, 1, file_type) == -1) {
+            delete_tree(p_mounted, clone);
+            ret = -1;
+        }
+    }
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    if (ret == -1) {
+        logger->error("An error occurred when trying to clone the file.");
         return -1;
     }
 
-    printf("%.2f%% of inodes are free (%d / %d).\n",
-           ((double) p_mounted->super_bloc.nb_inodes_free / (double) p_mounted->super_bloc.nb_inodes) * 100,
-           p_mounted->super_bloc.nb_inodes_free,
-           p_mounted->super_bloc.nb_inodes);
-    printf("%.2f%% of data blocks are free (%d / %d).\n",
-           ((double) p_mounted->super_bloc.nb_data_free / (double) p_mounted->super_bloc.nb_data) * 100,
-           p_mounted->super_bloc.nb_data_free,
-           p_mounted->super_bloc.nb_data);
+    return commit_operation();
+}
+
+int my_clone(char *src_path, char *dst_path) {
+    uint32_t src;
+    uint32_t file_type;
+    if (src_path == NULL || resolve_path(p_mounted, src_path, &src, &file_type) != 1) {
+        logger->error("There is no file with this path.");
+        return -1;
+    }
+
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    if (dst_path == NULL || resolve_parent(p_mounted, dst_path, ROOT_DIRECTORY, &dir, name) == -1 || name[0] == '\0') {
+        logger->error("An error occurred when trying to find the directory of the clone.");
+        return -1;
+    }
+    uint32_t inode;
+    uint32_t dst_type;
+    int found;
+    if ((found = lookup_name(p_mounted, dir, name, &inode, &dst_type)) != 0) {
+        if (found == 1) {
+            logger->error("This path already exists.");
+        }
+        return -1;
+    }
+
+    if (link_clone(src, file_type, dir, name) == -1) {
+        return -1;
+    }
+    logger->info("File cloned.");
+    return 0;
+}
+
+/**
+ * @brief Computes the length of a vector of buffers, bounded by the size of the largest file.
+ * @param iov The buffers.
+ * @param iovcnt The number of buffers.
+ * @return The length, -1 if the vector is invalid.
+ */
+static int iov_length(const struct iovec *iov, int iovcnt) {
+    if (iov == NULL || iovcnt < 0) {
+        logger->error("You are trying to use an invalid vector of buffers.");
+        return -1;
+    }
+
+    size_t max_size = (size_t) NB_DATA_BLOCKS_INODE * p_mounted->super_bloc.block_size;
+    size_t length = 0;
+    for (int k = 0; k < iovcnt && length < max_size; k++) {
+        length += iov[k].iov_len;
+    }
+    return (int) (length < max_size ? length : max_size);
+}
+
+int my_writev(file_t *f, const struct iovec *iov, int iovcnt) {
+    int length;
+    if ((length = iov_length(iov, iovcnt)) == -1) {
+        return -1;
+    }
+    if (iovcnt == 1) {
+        return my_write(f, iov[0].iov_base, length);
+    }
+
+    // A file is at most a few blocks long: the buffers are gathered so that the range is written by a single my_write
+    uint8_t *buffer;
+    if ((buffer = (uint8_t*) malloc(length > 0 ? length : 1)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    size_t gathered = 0;
+    for (int k = 0; k < iovcnt && gathered < (size_t) length; k++) {
+        size_t n = iov[k].iov_len < length - gathered ? iov[k].iov_len : length - gathered;
+        memcpy(buffer + gathered, iov[k].iov_base, n);
+        gathered += n;
+    }
+
+    int written = my_write(f, buffer, length);
+    free(buffer);
+    return written;
+}
+
+int my_read(file_t *f, void *buffer, int nb_bytes) {
+    if (f == NULL || nb_bytes < 0) {
+        logger->error("You are trying to read a file that does not exists.");
+        return -1;
+    }
+
+    inode_t i;
+    if (read_inode(p_mounted, &i, f->inode) == -1) {
+        logger->error("An error occurred when trying to read the inode of the file.");
+        return -1;
+    }
+
+    if (f->offset >= i.memory_size_data) {
+        return 0;
+    }
+    if ((uint32_t) nb_bytes > i.memory_size_data - f->offset) {
+        nb_bytes = (int) (i.memory_size_data - f->offset);
+    }
+
+    if (i.flags & INODE_INLINE_DATA) {
+        memcpy(buffer, i.inline_data + f->offset, nb_bytes);
+        f->offset += nb_bytes;
+        return nb_bytes;
+    }
+
+    uint32_t bs = p_mounted->super_bloc.block_size;
+    uint8_t *block;
+    if (posix_memalign((void**) &block, bs, bs) != 0) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+
+    // The compressed clusters are decompressed once, then served block by block
+    uint8_t *cluster = NULL;
+    uint32_t cluster_index = NB_DATA_BLOCKS_INODE;
+    if (has_clusters(&i) && (cluster = (uint8_t*) malloc((size_t) COMPRESS_CLUSTER_BLOCKS * bs)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(block);
+        return -1;
+    }
+
+    int nb_read = 0;
+    while (nb_read < nb_bytes) {
+        uint32_t pos = f->offset + nb_read;
+        uint32_t k = pos / bs;
+        uint32_t in_block = pos % bs;
+        uint32_t left = (uint32_t) (nb_bytes - nb_read);
+        uint32_t n = (bs - in_block < left) ? bs - in_block : left;
+
+        uint32_t c = k / COMPRESS_CLUSTER_BLOCKS;
+        if (cluster != NULL && i.cluster_size[c] != 0) {
+            if (cluster_index != c && read_cluster(p_mounted, &i, c, cluster) == -1) {
+                break;
+            }
+            cluster_index = c;
+            memcpy((uint8_t*) buffer + nb_read, cluster + (k % COMPRESS_CLUSTER_BLOCKS) * bs + in_block, n);
+            nb_read += n;
+            continue;
+        }
+
+        // A hole reads as zeros, without accessing the disk
+        if (i.data_blocks[k] == 0) {
+            memset((uint8_t*) buffer + nb_read, 0, n);
+            nb_read += n;
+            continue;
+        }
+        if ((i.flags & INODE_TAIL_PACKED) && k == (i.memory_size_data - 1) / bs) {
+            if (read_tail(p_mounted, &i, block) == -1) {
+                break;
+            }
+        } else if (n == bs) {
+            // A whole block is read (and verified) directly in the buffer of the caller
+            if (read_data(p_mounted, (uint8_t*) buffer + nb_read, i.data_blocks[k]) == -1) {
+                logger->error("An error occurred when trying to read the file.");
+                break;
+            }
+            nb_read += n;
+            continue;
+        } else if (read_data(p_mounted, block, i.data_blocks[k]) == -1) {
+            logger->error("An error occurred when trying to read the file.");
+            break;
+        }
+
+        memcpy((uint8_t*) buffer + nb_read, block + in_block, n);
+        nb_read += n;
+    }
+    free(block);
+    free(cluster);
+
+    f->offset += nb_read;
+    return nb_read;
+}
+
+int my_readv(file_t *f, const struct iovec *iov, int iovcnt) {
+    int length;
+    if ((length = iov_length(iov, iovcnt)) == -1) {
+        return -1;
+    }
+    if (iovcnt == 1) {
+        return my_read(f, iov[0].iov_base, length);
+    }
+
+    // The range is read by a single my_read, then scattered into the buffers
+    uint8_t *buffer;
+    if ((buffer = (uint8_t*) malloc(length > 0 ? length : 1)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        return -1;
+    }
+    int nb_read;
+    if ((nb_read = my_read(f, buffer, length)) > 0) {
+        size_t scattered = 0;
+        for (int k = 0; k < iovcnt && scattered < (size_t) nb_read; k++) {
+            size_t n = iov[k].iov_len < nb_read - scattered ? iov[k].iov_len : nb_read - scattered;
+            memcpy(iov[k].iov_base, buffer + scattered, n);
+            scattered += n;
+        }
+    }
+    free(buffer);
+    return nb_read;
+}
+
+int my_read_view(file_t *f, int nb_bytes, read_view_t *view) {
+    if (f == NULL || view == NULL || nb_bytes < 0) {
+        logger->error("You are trying to read a file that does not exists.");
+        return -1;
+    }
+    view->data = NULL;
+    view->length = 0;
+    view->entry = NULL;
+
+    inode_t i;
+    if (read_inode(p_mounted, &i, f->inode) == -1) {
+        logger->error("An error occurred when trying to read the inode of the file.");
+        return -1;
+    }
+    if (f->offset >= i.memory_size_data) {
+        return 0;
+    }
+    if ((uint32_t) nb_bytes > i.memory_size_data - f->offset) {
+        nb_bytes = (int) (i.memory_size_data - f->offset);
+    }
+
+    uint32_t bs = p_mounted->super_bloc.block_size;
+    uint32_t k = f->offset / bs;
+    uint32_t in_block = f->offset % bs;
+    uint32_t n = (bs - in_block < (uint32_t) nb_bytes) ? bs - in_block : (uint32_t) nb_bytes;
+
+    // Only the regular blocks are lent from the cache, the other ranges are copied once in a buffer owned by the view
+    if ((i.flags & INODE_INLINE_DATA) || i.data_blocks[k] == 0
+        || ((i.flags & INODE_TAIL_PACKED) && k == (i.memory_size_data - 1) / bs)
+        || (has_clusters(&i) && i.cluster_size[k / COMPRESS_CLUSTER_BLOCKS] != 0)) {
+        uint8_t *copy;
+        if ((copy = (uint8_t*) malloc(n)) == NULL) {
+            logger->error("An error occurred when trying to allocate memory.");
+            return -1;
+        }
+        int nb_read;
+        if ((nb_read = my_read(f, copy, (int) n)) == -1) {
+            free(copy);
+            return -1;
+        }
+        view->data = copy;
+        view->length = nb_read;
+        return nb_read;
+    }
+
+    cache_entry_t *entry;
+    if ((entry = get_cached_block(p_mounted, i.data_blocks[k])) == NULL) {
+        logger->error("An error occurred when trying to read the file.");
+        return -1;
+    }
+    view->data = entry->data + in_block;
+    view->length = n;
+    view->entry = entry;
+    f->offset += n;
+    return (int) n;
+}
+
+int my_release_view(read_view_t *view) {
+    if (view == NULL || view->data == NULL) {
+        logger->error("You are trying to release a view that does not exists.");
+        return -1;
+    }
+
+    if (view->entry != NULL) {
+        put_cached_block(p_mounted, (cache_entry_t*) view->entry);
+    } else {
+        free((void*) view->data);
+    }
+    view->data = NULL;
+    view->length = 0;
+    view->entry = NULL;
+    return 0;
+}
+
+int my_set_compression(file_t *f, int enabled) {
+    if (f == NULL) {
+        logger->error("You are trying to change a file that does not exists.");
+        return -1;
+    }
+
+    inode_t i;
+    if (read_inode(p_mounted, &i, f->inode) == -1) {
+        logger->error("An error occurred when trying to read the inode of the file.");
+        return -1;
+    }
+    if (enabled) {
+        i.flags |= INODE_COMPRESSED;
+    } else {
+        i.flags &= ~INODE_COMPRESSED;
+    }
+    if (update_inode(p_mounted, i, f->inode) == -1) {
+        logger->error("An error occurred when trying to update the inode of the file.");
+        return -1;
+    }
+    return 0;
+}
+
+void my_seek(file_t *f, int offset, int base) {
+    inode_t i;
+    switch (base) {
+        case SEEK_SET:
+            f->offset = offset;
+            break;
+        case SEEK_CUR:
+            f->offset += offset;
+            break;
+        case SEEK_END:
+            read_inode(p_mounted, &i, f->inode);
+            f->offset = i.memory_size_data - offset;
+            break;
+        default:
+            logger->error("Base unrecognized.");
+    }
+}
+
+size_t size(file_t *f) {
+    inode_t i;
+    read_inode(p_mounted, &i, f->inode);
+
+    return i.memory_size_data;
+}
+
+int my_stat(char *file_name, file_stat_t *st) {
+    if (file_name == NULL || st == NULL) {
+        logger->error("You are trying to get the metadata of an invalid file.");
+        return -1;
+    }
+
+    uint32_t inode;
+    uint32_t file_type;
+    if (resolve_path(p_mounted, file_name, &inode, &file_type) != 1) {
+        logger->trace("There is no file with this path.");
+        return -1;
+    }
+
+    memset(st, 0, sizeof(file_stat_t));
+    st->inode = inode;
+    st->file_type = file_type;
+    if (inode == ROOT_DIRECTORY) {
+        // The root directory has no inode
+        st->size = p_mounted->super_bloc.nb_dir_entries * sizeof(dir_entry_t);
+        st->nb_blocks = p_mounted->directory.nb_blocks;
+        return 0;
+    }
+
+    inode_t i;
+    if (read_inode(p_mounted, &i, inode) == -1) {
+        logger->error("An error occurred when trying to read the inode of the file.");
+        return -1;
+    }
+
+    st->size = i.memory_size_data;
+    if (!(i.flags & INODE_INLINE_DATA)) {
+        for (uint32_t k = 0; k < NB_DATA_BLOCKS_INODE; k++) {
+            st->nb_blocks += i.data_blocks[k] != 0;
+        }
+    }
+    st->nb_extents = count_extents(p_mounted, &i);
+    st->last_modification = i.last_modification;
+    st->last_access = i.last_access;
+    st->flags = i.flags;
+    return 0;
+}
+
+dir_stream_t* my_opendir(char *path) {
+    uint32_t inode;
+    uint32_t file_type;
+    if (path == NULL || resolve_path(p_mounted, path, &inode, &file_type) != 1 || file_type != FILE_TYPE_DIRECTORY) {
+        logger->error("There is no directory with this path.");
+        return NULL;
+    }
+
+    dir_stream_t *d;
+    if ((d = (dir_stream_t*) malloc(sizeof(dir_stream_t))) == NULL
+        || (d->entries = (dir_entry_t*) malloc(p_mounted->super_bloc.block_size)) == NULL) {
+        logger->error("An error occurred when trying to allocate memory.");
+        free(d);
+        return NULL;
+    }
+    d->dir = inode;
+    d->next = 0;
+    d->block = UINT32_MAX;
+    d->nb_entries = inode == ROOT_DIRECTORY ? p_mounted->super_bloc.nb_dir_entries : UINT32_MAX;
+    return d;
+}
+
+dir_entry_t* my_readdir(dir_stream_t *d) {
+    if (d == NULL || d->next >= d->nb_entries) {
+        return NULL;
+    }
+
+    // The blocks are copied one at a time, the ones not loaded yet stay on the disk
+    uint32_t per_block = p_mounted->super_bloc.block_size / sizeof(dir_entry_t);
+    uint32_t k = d->next / per_block;
+    if (k != d->block) {
+        if (read_dir_block(p_mounted, d->dir, k, d->entries, &d->nb_entries) == -1) {
+            logger->error("An error occurred when trying to read the directory.");
+            return NULL;
+        }
+        d->block = k;
+        if (d->next >= d->nb_entries) {
+            return NULL;
+        }
+    }
+    return d->entries + d->next++ % per_block;
+}
+
+int my_closedir(dir_stream_t *d) {
+    if (d == NULL) {
+        logger->error("You are trying to close a directory that is not opened.");
+        return -1;
+    }
+    free(d->entries);
+    free(d);
+    return 0;
+}
+
+int umount() {
+    if (p_mounted == NULL) {
+        logger->error("There is no partition mounted.");
+        return -1;
+    }
+
+    for (uint32_t k = 0; k < p_mounted->nb_opened_files; k++) {
+        if (release_file_data(p_mounted, p_mounted->opened_files[k]) == -1) {
+            logger->error("An error occurred when trying to release the data reserved by an opened file.");
+            return -1;
+        }
+    }
+    // The reclaimer frees its last blocks before the bitmaps are written back
+    if (stop_reclaim(p_mounted) == -1) {
+        logger->error("An error occurred when trying to stop the reclaimer.");
+        return -1;
+    }
+
+    if (update_databitmap(p_mounted) == -1 || update_inodebitmap(p_mounted) == -1 || update_groups(p_mounted) == -1
+        || update_directory(p_mounted) == -1 || update_checksums(p_mounted) == -1) {
+        logger->error("An error occurred when trying to write the partition metadata.");
+        return -1;
+    }
+
+    if (stop_lazy_init(p_mounted) == -1) {
+        logger->error("An error occurred when trying to stop the lazy initialization.");
+        return -1;
+    }
+    if (stop_discard(p_mounted) == -1) {
+        logger->error("An error occurred when trying to stop the discard of the freed blocks.");
+        return -1;
+    }
+
+    if (update_bloc(p_mounted, &p_mounted->super_bloc, sizeof(super_bloc_t), 0, 0) == -1) {
+        logger->error("An error occurred when trying to write the superblock to the partition.");
+        return -1;
+    }
+    if (stop_sync(p_mounted) == -1) {
+        logger->error("An error occurred when trying to sync the partition.");
+        return -1;
+    }
+
+    if (close(p_mounted->fd) == -1) {
+        logger->error("An error occurred when trying to close the partition.");
+        return -1;
+    }
+
+    free_groups(p_mounted);
+    free_checksums(p_mounted);
+    free_cache(p_mounted);
+    stop_direct_io(p_mounted);
+    free_dentries(p_mounted);
+    delete_directory(p_mounted);
+    free(p_mounted->opened_files);
+    pthread_mutex_destroy(&p_mounted->frag_lock);
+    pthread_mutex_destroy(&p_mounted->dedup_lock);
+    pthread_mutex_destroy(&p_mounted->open_lock);
+    free(p_mounted);
+    p_mounted = NULL;
+
+    logger->info("Partition unmounted.");
+    return 0;
+}
+
+int my_close(file_t *f) {
+    if (f == NULL) {
+        logger->error("You are trying to close a file that does not exists.");
+        return -1;
+    }
+
+    // The lock is held until the file is out of the table, so that it is not moved by the defragmentation meanwhile
+    pthread_mutex_lock(&p_mounted->open_lock);
+    if (p_mounted->nb_opened_files <= 0) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("There is no file opened.");
+        return -1;
+    }
+
+    uint32_t i = 0;
+    while (i < p_mounted->nb_opened_files && p_mounted->opened_files[i] != f) {
+        i++;
+    }
+
+    if (i >= p_mounted->nb_opened_files) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("This file is not opened.");
+        return -1;
+    }
+
+    // Only a file changed since it was opened can have a new tail: the others keep their layout
+    if (f->written && pack_tail(p_mounted, f) == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to pack the tail of the file.");
+        return -1;
+    }
+
+    // The blocks reserved for the next writes are given back
+    if (release_file_data(p_mounted, f) == -1) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("An error occurred when trying to release the data reserved by the file.");
+        return -1;
+    }
+
+    p_mounted->opened_files[i] = p_mounted->opened_files[--p_mounted->nb_opened_files];
+    p_mounted->opened_files[p_mounted->nb_opened_files] = NULL;
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    free(f);
+    f = NULL;
+
+    if (commit_operation() == -1) {
+        return -1;
+    }
+
+    logger->info("File closed.");
+    return 0;
+}
+
+int my_fsync(file_t *f) {
+    if (f == NULL) {
+        logger->error("You are trying to sync a file that does not exists.");
+        return -1;
+    }
+
+    // The whole image is synced: the other files written so far reach the disk with this one
+    if (flush_partition(p_mounted) == -1 || sync_partition(p_mounted) == -1) {
+        logger->error("An error occurred when trying to sync the file.");
+        return -1;
+    }
+    logger->info("File synced.");
+    return 0;
+}
+
+int fs_usage() {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    printf("%.2f%% of inodes are free (%d / %d).\n",
+           ((double) p_mounted->super_bloc.nb_inodes_free / (double) p_mounted->super_bloc.nb_inodes) * 100,
+           p_mounted->super_bloc.nb_inodes_free,
+           p_mounted->super_bloc.nb_inodes);
+    printf("%.2f%% of data blocks are free (%d / %d).\n",
+           ((double) p_mounted->super_bloc.nb_data_free / (double) p_mounted->super_bloc.nb_data) * 100,
+           p_mounted->super_bloc.nb_data_free,
+           p_mounted->super_bloc.nb_data);
+    return 0;
+}
+
+int64_t fs_trim() {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    int64_t punched;
+    if ((punched = trim_free_data(p_mounted)) == -1) {
+        logger->error("An error occurred when trying to discard the free data blocks.");
+        return -1;
+    }
+    logger->info("Free data blocks discarded.");
+    return punched;
+}
+
+int64_t fs_defrag(uint32_t max_blocks_per_s) {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    int64_t moved;
+    if ((moved = defrag_files(p_mounted, max_blocks_per_s)) == -1) {
+        logger->error("An error occurred when trying to defragment the files.");
+        return -1;
+    }
+    // The old blocks are freed before the bitmaps are written back
+    flush_reclaim(p_mounted);
+    if (commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("Files defragmented.");
+    return moved;
+}
+
+int fs_analyze(fs_report_t *report) {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+    if (report == NULL) {
+        logger->error("You are trying to store a report in an invalid place.");
+        return -1;
+    }
+
+    if (analyze_partition(p_mounted, report) == -1) {
+        logger->error("An error occurred when trying to analyze the partition.");
+        return -1;
+    }
+    logger->info("Partition analyzed.");
+    return 0;
+}
+
+void fs_free_report(fs_report_t *report) {
+    if (report == NULL) {
+        return;
+    }
+    free(report->regions);
+    report->regions = NULL;
+    report->nb_regions = 0;
+}
+
+int fs_check(int repair, uint32_t nb_threads, fsck_report_t *report) {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+    if (report == NULL) {
+        logger->error("You are trying to store a report in an invalid place.");
+        return -1;
+    }
+
+    // The reservations of the opened files are not referenced by any inode yet
+    pthread_mutex_lock(&p_mounted->open_lock);
+    uint32_t nb_opened_files = p_mounted->nb_opened_files;
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    if (nb_opened_files > 0) {
+        logger->error("The partition cannot be checked while files are opened.");
+        return -1;
+    }
+    if (nb_threads == 0) {
+        long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nb_threads = nb_cpus > 0 ? (uint32_t) nb_cpus : 1;
+    }
+
+    // The references handed to the reclaimer are dropped first, so that the bitmaps match the inodes
+    flush_reclaim(p_mounted);
+    int nb_conflicts;
+    if ((nb_conflicts = check_partition(p_mounted, repair != 0, nb_threads, report)) == -1) {
+        logger->error("An error occurred when trying to check the partition.");
+        return -1;
+    }
+    if (repair && report->nb_repaired > 0 && commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("Partition checked.");
+    return nb_conflicts;
+}
+
+/**
+ * @brief Finds a snapshot.
+ * @param name The name of the snapshot.
+ * @param snapshots Where to store the inode of SNAPSHOT_DIRECTORY.
+ * @param snapshot Where to store the inode of the snapshot.
+ * @return 1 if the snapshot exists, 0 if it does not, -1 if an error occurs.
+ */
+static int find_snapshot(const char *name, uint32_t *snapshots, uint32_t *snapshot) {
+    if (name == NULL || name[0] == '\0' || strchr(name, '/') != NULL || strlen(name) >= MAX_FILENAME) {
+        logger->error("This is not a valid name for a snapshot.");
+        return -1;
+    }
+
+    uint32_t file_type;
+    int found;
+    if ((found = lookup_name(p_mounted, ROOT_DIRECTORY, SNAPSHOT_DIRECTORY, snapshots, &file_type)) != 1) {
+        *snapshots = ROOT_DIRECTORY;
+        return found;
+    }
+    if (file_type != FILE_TYPE_DIRECTORY) {
+        logger->error("The directory of the snapshots is not a directory.");
+        return -1;
+    }
+    return lookup_name(p_mounted, *snapshots, name, snapshot, &file_type);
+}
+
+int fs_snapshot(char *name) {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    uint32_t snapshots;
+    uint32_t snapshot;
+    int found;
+    if ((found = find_snapshot(name, &snapshots, &snapshot)) != 0) {
+        if (found == 1) {
+            logger->error("This snapshot already exists.");
+        }
+        return -1;
+    }
+    if (snapshots == ROOT_DIRECTORY
+        && (snapshots = create_file((char*) SNAPSHOT_DIRECTORY, p_mounted, ROOT_DIRECTORY, FILE_TYPE_DIRECTORY))
+           == (uint32_t) -1) {
+        logger->error("An error occurred when trying to create the directory of the snapshots.");
+        return -1;
+    }
+
+    if (link_clone(ROOT_DIRECTORY, FILE_TYPE_DIRECTORY, snapshots, name) == -1) {
+        logger->error("An error occurred when trying to take the snapshot.");
+        return -1;
+    }
+    logger->info("Snapshot taken.");
+    return 0;
+}
+
+int fs_rollback(char *name) {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    uint32_t snapshots;
+    uint32_t snapshot;
+    if (find_snapshot(name, &snapshots, &snapshot) != 1) {
+        logger->error("There is no snapshot with this name.");
+        return -1;
+    }
+
+    pthread_mutex_lock(&p_mounted->open_lock);
+    if (p_mounted->nb_opened_files > 0) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("The filesystem cannot be rolled back while files are opened.");
+        return -1;
+    }
+    // The current files are only deleted once the snapshot is cloned, and the clone takes their place
+    uint32_t clone = clone_tree(p_mounted, snapshot, ROOT_DIRECTORY);
+    int ret = clone == p_mounted->super_bloc.nb_inodes + 1 ? -1 : 0;
+    if (ret == 0 && (empty_directory(p_mounted, ROOT_DIRECTORY, snapshots) == -1
+                     || move_entries(p_mounted, clone, ROOT_DIRECTORY) == -1)) {
+        ret = -1;
+    }
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    if (ret == -1) {
+        logger->error("An error occurred when trying to roll back to the snapshot.");
+        return -1;
+    }
+
+    if (commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("Filesystem rolled back.");
+    return 0;
+}
+
+int fs_delete_snapshot(char *name) {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    uint32_t snapshots;
+    uint32_t snapshot;
+    if (find_snapshot(name, &snapshots, &snapshot) != 1) {
+        logger->error("There is no snapshot with this name.");
+        return -1;
+    }
+
+    pthread_mutex_lock(&p_mounted->open_lock);
+    if (p_mounted->nb_opened_files > 0) {
+        pthread_mutex_unlock(&p_mounted->open_lock);
+        logger->error("A snapshot cannot be deleted while files are opened.");
+        return -1;
+    }
+    int ret = remove_entry(p_mounted, snapshots, name) == -1 || delete_tree(p_mounted, snapshot) == -1 ? -1 : 0;
+    pthread_mutex_unlock(&p_mounted->open_lock);
+    if (ret == -1) {
+        logger->error("An error occurred when trying to delete the snapshot.");
+        return -1;
+    }
+
+    if (commit_operation() == -1) {
+        return -1;
+    }
+    logger->info("Snapshot deleted.");
+    return 0;
+}
+
+int fs_sync() {
+    if (p_mounted == NULL) {
+        logger->error("No partition mounted.");
+        return -1;
+    }
+
+    // The blocks waiting for the reclaimer are freed first, so that their bitmaps are written back too
+    flush_reclaim(p_mounted);
+    if (flush_partition(p_mounted) == -1 || sync_partition(p_mounted) == -1) {
+        logger->error("An error occurred when trying to sync the partition.");
+        return -1;
+    }
+    logger->info("Partition synced.");
     return 0;
 }
\ No newline at end of file
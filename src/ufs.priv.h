@@ -8,20 +8,344 @@
 
 #pragma once
 
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "unix_fs_sim/ufs.h"
 
-#define MAX_OPENED_FILES 64
+/**
+ * @def MAX_OPENED_FILES The maximum number of files opened at once.
+ */
+#define MAX_OPENED_FILES 65536
+
+/**
+ * @def OPENED_FILES_INITIAL The initial capacity of the table of the opened files, doubled when it is full.
+ */
+#define OPENED_FILES_INITIAL 64
+
+/**
+ * @def DATA_RESERVATION_WINDOW The maximum number of contiguous data blocks reserved at once by a writer.
+ */
+#define DATA_RESERVATION_WINDOW 8
+
+/**
+ * @def DATA_REFCOUNT_MASK The bits of a data bitmap entry holding the reference count of the block.
+ */
+#define DATA_REFCOUNT_MASK 0x7F
+
+/**
+ * @def DATA_INDEXED The bit of a data bitmap entry set while the block is in the deduplication index and may be shared.
+ */
+#define DATA_INDEXED 0x80
+
+/**
+ * @def BLOCK_CACHE_BLOCKS The number of unused data blocks kept in the block cache.
+ */
+#define BLOCK_CACHE_BLOCKS 256
+
+/**
+ * @def MAX_PACKED_TAIL The size of the largest file tail stored in a fragment block.
+ */
+#define MAX_PACKED_TAIL(block_size) ((block_size) / 2)
+
+/**
+ * @def DENTRY_CACHE_ENTRIES The number of names kept in the dentry cache.
+ */
+#define DENTRY_CACHE_ENTRIES 4096
+
+/**
+ * @def ROOT_DIRECTORY The identifier of the root directory, which has no inode (its entries have a region of their own).
+ */
+#define ROOT_DIRECTORY UINT32_MAX
+
+/**
+ * @def DIV_ROUND_UP Integer division rounded to the upper integer.
+ */
+#define DIV_ROUND_UP(n, d) (((n) + (d) - 1) / (d))
+
+/**
+ * @struct bitmap_t ufs.priv.h
+ * @brief An on-disk bitmap whose blocks (chunks) are loaded in memory when first touched.
+ * @var start The index of the first block of the bitmap.
+ * @var nb_entries The number of entries of the bitmap.
+ * @var nb_chunks The number of blocks of the bitmap.
+ * @var group The index of the block group owning the bitmap.
+ * @var init The number of blocks already initialized on disk (points into the group descriptor).
+ * @var flags The flags of the group descriptor.
+ * @var uninit_flag The flag set while the bitmap is not entirely initialized.
+ * @var chunks The loaded chunks, NULL if the chunk has not been touched yet.
+ * @var dirty If the chunk has to be written back on the disk.
+ * @var hint Where to start looking for a free entry.
+ */
+typedef struct {
+    uint32_t start;
+    uint32_t nb_entries;
+    uint32_t nb_chunks;
+    uint32_t group;
+    uint32_t *init;
+    uint32_t *flags;
+    uint32_t uninit_flag;
+    uint8_t **chunks;
+    uint8_t *dirty;
+    uint32_t hint;
+} bitmap_t;
+
+/**
+ * @struct directory_t ufs.priv.h
+ * @brief The root directory, whose blocks are loaded in memory when first touched.
+ * @var nb_blocks The number of blocks of the directory.
+ * @var blocks The loaded blocks, NULL if the block has not been touched yet.
+ * @var dirty If the block has to be written back on the disk.
+ */
+typedef struct {
+    uint32_t nb_blocks;
+    dir_entry_t **blocks;
+    uint8_t *dirty;
+} directory_t;
+
+/**
+ * @struct dir_stream ufs.priv.h
+ * @brief An iterator over the entries of a directory, which holds a copy of a single block of entries.
+ * @var dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @var next The index of the next entry.
+ * @var nb_entries The number of entries of the directory when the last block was read.
+ * @var block The index of the block held, UINT32_MAX if there is none yet.
+ * @var entries The entries of the block held.
+ */
+struct dir_stream {
+    uint32_t dir;
+    uint32_t next;
+    uint32_t nb_entries;
+    uint32_t block;
+    dir_entry_t *entries;
+};
+
+/**
+ * @struct dentry_t ufs.priv.h
+ * @brief A name of a directory in the dentry cache.
+ * @var dir The inode of the directory, ROOT_DIRECTORY for the root directory.
+ * @var name The name.
+ * @var negative If the directory has no entry with this name.
+ * @var inode The inode of the entry.
+ * @var file_type The FILE_TYPE_* of the entry.
+ * @var next The next entry of the same bucket.
+ * @var lru_prev The previous entry (more recently used).
+ * @var lru_next The next entry (less recently used).
+ */
+typedef struct dentry {
+    uint32_t dir;
+    char name[MAX_FILENAME];
+    bool negative;
+    uint32_t inode;
+    uint32_t file_type;
+    struct dentry *next;
+    struct dentry *lru_prev;
+    struct dentry *lru_next;
+} dentry_t;
+
+/**
+ * @struct dentry_cache_t ufs.priv.h
+ * @brief The cache of the names looked up in the directories, which also remembers the names that do not exist.
+ * @var nb_buckets The number of buckets of the hash table.
+ * @var nb_entries The number of names in the cache.
+ * @var buckets The hash table of the names, by directory and name.
+ * @var lru The names, from the most to the least recently used (the entry is a sentinel).
+ */
+typedef struct {
+    uint32_t nb_buckets;
+    uint32_t nb_entries;
+    dentry_t **buckets;
+    dentry_t lru;
+} dentry_cache_t;
+
+/**
+ * @struct checksums_t ufs.priv.h
+ * @brief The checksums of the data blocks, whose blocks are loaded in memory when first touched.
+ * @var nb_blocks The number of blocks of the checksum region.
+ * @var blocks The loaded blocks, NULL if the block has not been touched yet.
+ * @var dirty If the block has to be written back on the disk.
+ */
+typedef struct {
+    uint32_t nb_blocks;
+    uint32_t **blocks;
+    uint8_t *dirty;
+} checksums_t;
+
+/**
+ * @struct cache_entry_t ufs.priv.h
+ * @brief A data block of the block cache.
+ * @var block The index of the data block.
+ * @var refcount The number of views using the block.
+ * @var detached If the block has been rewritten while it was used: it is freed by its last user.
+ * @var data The content of the block.
+ * @var next The next entry of the same bucket.
+ * @var lru_prev The previous unused entry (more recently used).
+ * @var lru_next The next unused entry (less recently used).
+ */
+typedef struct cache_entry {
+    uint32_t block;
+    uint32_t refcount;
+    bool detached;
+    uint8_t *data;
+    struct cache_entry *next;
+    struct cache_entry *lru_prev;
+    struct cache_entry *lru_next;
+} cache_entry_t;
+
+/**
+ * @struct block_cache_t ufs.priv.h
+ * @brief The cache of the data blocks served by the read views.
+ * @var nb_buckets The number of buckets of the hash table.
+ * @var nb_entries The number of blocks in the cache.
+ * @var buckets The hash table of the blocks, by index.
+ * @var lru The unused blocks, from the most to the least recently used (the entry is a sentinel).
+ * @var generation Incremented each time a block is invalidated.
+ * @var lock Protects the cache.
+ */
+typedef struct {
+    uint32_t nb_buckets;
+    uint32_t nb_entries;
+    cache_entry_t **buckets;
+    cache_entry_t lru;
+    uint64_t generation;
+    pthread_mutex_t lock;
+} block_cache_t;
+
+/**
+ * @struct group_t ufs.priv.h
+ * @brief A block group of a mounted partition.
+ * @var desc The descriptor of the group (points into the group descriptor table).
+ * @var data_bitmap The data bitmap of the group.
+ * @var inode_bitmap The inode bitmap of the group.
+ * @var lock Protects the bitmaps and the free counters of the group.
+ * @var dirty If the descriptor has to be written back on the disk.
+ */
+typedef struct {
+    group_desc_t *desc;
+    bitmap_t data_bitmap;
+    bitmap_t inode_bitmap;
+    pthread_mutex_t lock;
+    bool dirty;
+} group_t;
+
+/**
+ * @struct block_queue_t ufs.priv.h
+ * @brief Data blocks handed to a background task, which processes them by batches.
+ * @var blocks The blocks queued, in the order they were queued.
+ * @var nb_blocks The number of blocks queued.
+ * @var capacity The number of blocks the array can hold.
+ * @var batch The number of blocks that wakes the task up.
+ * @var max_blocks The number of blocks the queue can hold.
+ * @var handler Processes a batch of blocks, returns -1 to stop the queue.
+ * @var arg The first argument of the handler.
+ * @var thread The background task.
+ * @var lock Protects the queue.
+ * @var cond Signaled when a batch is ready, when the task has to stop and when a batch has been processed.
+ * @var busy If the task is processing a batch.
+ * @var running If the background task is running.
+ * @var stop If the background task has to stop.
+ */
+typedef struct {
+    uint32_t *blocks;
+    uint32_t nb_blocks;
+    uint32_t capacity;
+    uint32_t batch;
+    uint32_t max_blocks;
+    int (*handler)(void *arg, uint32_t *blocks, uint32_t nb_blocks);
+    void *arg;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool busy;
+    bool running;
+    bool stop;
+} block_queue_t;
+
+/**
+ * @struct sync_t ufs.priv.h
+ * @brief The syncs of a mounted partition: the requests made while a sync is running are served by the next one.
+ * @var durability When the changes reach the disk.
+ * @var interval_ms The time between two syncs of the background task (DURABILITY_PERIODIC).
+ * @var requested The number of syncs requested.
+ * @var completed The number of requests served by a finished sync.
+ * @var nb_syncs The number of fdatasync done.
+ * @var syncing If a sync is running.
+ * @var thread The background task (DURABILITY_PERIODIC).
+ * @var lock Protects the requests.
+ * @var cond Signaled when a sync finishes and when the background task has to stop.
+ * @var running If the background task is running.
+ * @var stop If the background task has to stop.
+ */
+typedef struct {
+    durability_t durability;
+    uint32_t interval_ms;
+    uint64_t requested;
+    uint64_t completed;
+    uint64_t nb_syncs;
+    bool syncing;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool running;
+    bool stop;
+} sync_t;
+
+/**
+ * @def DIRECT_IO_LOCKS The number of locks serializing the partial writes of the blocks, with direct I/O.
+ */
+#define DIRECT_IO_LOCKS 64
+
+/**
+ * @struct buffer_pool_t ufs.priv.h
+ * @brief The aligned buffers of a partition mounted with direct I/O, through which go the transfers that are not
+ * aligned on the blocks.
+ * @var nb_buffers The number of buffers.
+ * @var buffer_size The size of a buffer, a multiple of the block size.
+ * @var memory The buffers, in a single allocation aligned on the blocks.
+ * @var free_buffers The indexes of the free buffers.
+ * @var nb_free The number of free buffers.
+ * @var lock Protects the free buffers.
+ * @var cond Signaled when a buffer is given back.
+ * @var block_locks Serialize the read-modify-write of the blocks written partially, a block uses the lock of its
+ * index modulo DIRECT_IO_LOCKS.
+ */
+typedef struct {
+    uint32_t nb_buffers;
+    uint32_t buffer_size;
+    uint8_t *memory;
+    uint32_t *free_buffers;
+    uint32_t nb_free;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_mutex_t block_locks[DIRECT_IO_LOCKS];
+} buffer_pool_t;
 
 typedef struct {
     int fd;
     super_bloc_t super_bloc;
-    uint8_t *data_bitmap;
-    uint8_t *inode_bitmap;
-    file_t *opened_files[MAX_OPENED_FILES];
-    uint16_t nb_opened_files;
-    dir_entry_t* directory;
+    group_desc_t *gdt;
+    group_t *groups;
+    uint32_t next_inode_group;
+    file_t **opened_files;
+    uint32_t nb_opened_files;
+    uint32_t opened_files_capacity;
+    pthread_mutex_t open_lock;
+    directory_t directory;
+    dentry_cache_t dentries;
+    checksums_t checksums;
+    block_cache_t cache;
+    pthread_mutex_t frag_lock;
+    pthread_mutex_t dedup_lock;
+    pthread_t lazy_init_thread;
+    pthread_mutex_t lazy_init_lock;
+    bool lazy_init_running;
+    bool lazy_init_stop;
+    block_queue_t discard;
+    block_queue_t reclaim;
+    sync_t sync;
+    bool direct_io;
+    buffer_pool_t pool;
 } partition_t;
 
 /**